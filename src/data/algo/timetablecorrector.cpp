@@ -2,6 +2,10 @@
 #include <vector>
 #include <data/train/train.h>
 #include <util/utilfunc.h>
+#include <util/qeparallel.hpp>
+#include <algorithm>
+#include <map>
+#include <tuple>
 #include <stdexcept>
 
 bool TimetableCorrector::autoCorrect(std::shared_ptr<Train> train)
@@ -34,6 +38,72 @@ bool TimetableCorrector::autoCorrectSafe(std::shared_ptr<Train> train)
     return i > 0;
 }
 
+int TimetableCorrector::autoCorrectCount(std::shared_ptr<Train> train, bool& failed)
+{
+    failed = false;
+    int i;
+    for (i = 0; i < 120; i++) {
+        bool flag = false;
+        try {
+            flag = correctCycle(train);
+        }
+        catch (const std::exception& e) {
+            qDebug() << "TimetableCorrector::autoCorrectCount: exception: " << 
+                train->trainName().full() << " " << e.what() << Qt::endl;
+            failed = true;
+            break;
+        }
+        if (!flag)
+            break;
+    }
+    return i;
+}
+
+std::vector<TimetableCorrector::BatchItem>
+    TimetableCorrector::batchCorrect(const QList<std::shared_ptr<Train>>& trains, bool dryRun)
+{
+    // 每个车次一个槽位，各线程只写自己负责的槽位
+    std::vector<BatchItem> items(trains.size());
+    qeutil::parallelFor(trains.size(), [&](int i) {
+        auto& item = items[i];
+        item.train = trains.at(i);
+        auto t = std::make_shared<Train>(*item.train);
+        item.cycles = autoCorrectCount(t, item.failed);
+        if (item.cycles > 0) {
+            item.fixCount = changedStationCount(*item.train, *t);
+            if (!dryRun)
+                item.corrected = std::move(t);
+        }
+        }, 8);
+
+    items.erase(std::remove_if(items.begin(), items.end(), [](const BatchItem& item) {
+        return item.cycles == 0 && !item.failed;
+        }), items.end());
+    return items;
+}
+
+int TimetableCorrector::changedStationCount(const Train& origin, const Train& corrected)
+{
+    using key_t = std::tuple<QString, int, int>;
+    auto key = [](const TrainStation& st) {
+        return key_t(st.name.toSingleLiteral(), st.arrive.msecsSinceStartOfDay(),
+            st.depart.msecsSinceStartOfDay());
+    };
+    std::map<key_t, int> remain;
+    for (const auto& st : origin.timetable()) {
+        remain[key(st)]++;
+    }
+    int cnt = 0;
+    for (const auto& st : corrected.timetable()) {
+        auto p = remain.find(key(st));
+        if (p != remain.end() && p->second > 0)
+            p->second--;
+        else
+            cnt++;
+    }
+    return cnt;
+}
+
 bool TimetableCorrector::correctCycle(std::shared_ptr<Train> train)
 {
     if (train->empty()){
@@ -1,6 +1,8 @@
 ﻿#pragma once
 
 #include <memory>
+#include <vector>
+#include <QList>
 
 class Train;
 /**
@@ -26,6 +28,39 @@ public:
      */
     static bool autoCorrectSafe(std::shared_ptr<Train> train);
 
+    /**
+     * 2026.10.19  加上catch的版本，返回有修改的查错循环次数（作为修正数量的度量）。
+     * 若出现异常，failed置为true，返回异常之前的循环次数。
+     */
+    static int autoCorrectCount(std::shared_ptr<Train> train, bool& failed);
+
+    /**
+     * 2026.10.19  批量更正中单个车次的结果
+     */
+    struct BatchItem {
+        std::shared_ptr<Train> train;       // 原始列车
+        std::shared_ptr<Train> corrected;   // 更正后的副本（仅时刻表有意义）；dryRun时为空
+        int cycles = 0;         // 有修改的查错循环次数
+        int fixCount = 0;       // 更正后时刻（或站名）有变化的车站数，见changedStationCount()
+        bool failed = false;    // 更正过程中出现异常
+    };
+
+    /**
+     * 2026.10.19  批量自动更正。
+     * 在工作线程上对每个车次的副本执行autoCorrectCount()，不修改原始列车，
+     * 由调用方通过撤销命令交换时刻表。
+     * 只返回有修改或者出现异常的车次，按输入顺序排列。
+     * dryRun: 只统计修正数量，不保留副本。
+     */
+    static std::vector<BatchItem> batchCorrect(const QList<std::shared_ptr<Train>>& trains,
+        bool dryRun);
+
+    /**
+     * 2026.10.19  更正后的时刻表中，在原时刻表里找不到站名、到达、出发时刻完全相同的车站的个数，
+     * 即实际被修改的车站数。仅调整顺序的车站不计。
+     */
+    static int changedStationCount(const Train& origin, const Train& corrected);
+
 private:
 
     /**
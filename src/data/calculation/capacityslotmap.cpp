@@ -0,0 +1,104 @@
+#include "capacityslotmap.h"
+#include "greedypainter.h"
+
+#include <algorithm>
+#include <set>
+#include <QObject>
+
+#include <data/train/train.h>
+#include <data/train/trainname.h>
+#include <util/utilfunc.h>
+#include <util/qeparallel.hpp>
+#include <util/qetrace.h>
+
+CapacitySlotMap::CapacitySlotMap(const GreedyPainter& config):
+    _config(config.cloneSettings())
+{
+    _config->setLogEnabled(false);
+}
+
+CapacitySlotMap::~CapacitySlotMap() noexcept = default;
+
+void CapacitySlotMap::setStepSecs(int secs)
+{
+    _stepSecs = std::clamp(secs, 1, 24 * 3600);
+}
+
+void CapacitySlotMap::evaluate()
+{
+    QE_TRACE_SCOPE("CapacitySlotMap::evaluate");
+    _results.clear();
+    if (!_config->railway() || !_config->ruler() || !_config->anchor())
+        return;
+
+    // 事件表只生成一次，此后只读，所有线程共享
+    const auto axis = _config->makeRailAxis();
+    const TrainName trainName(QObject::tr("线位扫描"));
+    const int n = (24 * 3600 + _stepSecs - 1) / _stepSecs;
+
+    std::vector<std::unique_ptr<GreedyPainter>> configs;
+    configs.emplace_back(_config->cloneSettings());
+    if (_bothDirections) {
+        auto rev = _config->cloneSettings();
+        rev->setDir(DirFunc::reverse(_config->dir()));
+        rev->setStart(_config->end());
+        rev->setEnd(_config->start());
+        rev->setLocalStarting(_config->localTerminal());
+        rev->setLocalTerminal(_config->localStarting());
+        configs.emplace_back(std::move(rev));
+    }
+
+    for (const auto& config : configs) {
+        Result res;
+        res.dir = config->dir();
+        res.slots.resize(n);
+
+        // 每段一个独立的GreedyPainter；各锚点只写自己的slot，无需同步
+        qeutil::parallelForChunks(n, [&](int, int begin, int end) {
+            auto painter = config->cloneSettings();
+            for (int i = begin; i < end; i++) {
+                auto& slot = res.slots[i];
+                slot.anchorTime = QTime(0, 0).addSecs(i * _stepSecs);
+                painter->setAnchorTime(slot.anchorTime);
+                if (!painter->paint(trainName, axis))
+                    continue;
+                const auto& table = painter->train()->timetable();
+                slot.feasible = true;
+                slot.startTime = table.front().depart;
+                slot.endTime = table.back().arrive;
+                slot.runSecs = qeutil::secsTo(slot.startTime, slot.endTime);
+            }
+            }, 4);
+
+        res.summary = summarize(res.dir, res.slots);
+        _results.emplace_back(std::move(res));
+    }
+}
+
+CapacitySlotMap::Summary CapacitySlotMap::summarize(Direction dir, const std::vector<Slot>& slots)
+{
+    Summary res;
+    res.dir = dir;
+    res.slotCount = static_cast<int>(slots.size());
+
+    std::set<QTime> starts;
+    long long tot_run = 0;
+    for (const auto& slot : slots) {
+        if (!slot.feasible)
+            continue;
+        if (res.feasibleCount == 0) {
+            res.minRunSecs = res.maxRunSecs = slot.runSecs;
+        }
+        else {
+            res.minRunSecs = std::min(res.minRunSecs, slot.runSecs);
+            res.maxRunSecs = std::max(res.maxRunSecs, slot.runSecs);
+        }
+        res.feasibleCount++;
+        tot_run += slot.runSecs;
+        starts.insert(slot.startTime);
+    }
+    res.distinctCount = static_cast<int>(starts.size());
+    if (res.feasibleCount)
+        res.avgRunSecs = static_cast<int>(tot_run / res.feasibleCount);
+    return res;
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <QTime>
+
+#include "data/common/direction.h"
+
+class GreedyPainter;
+
+/**
+ * 2026.10.19
+ * @brief The CapacitySlotMap class
+ * 线位扫描（剩余通行能力分析）。
+ * 以GreedyPainter当前的铺画条件为模板，在一天内按固定步长逐个设定锚点时刻试排，
+ * 得到每个锚点时刻能否再加开一列车、以及相应的运行时分，即线位分布图。
+ * 各锚点的试排相互独立，并行执行，共享同一个只读的事件表。
+ * 本类不修改运行图；试排所得列车都是临时对象，不予保留。
+ */
+class CapacitySlotMap
+{
+public:
+
+    struct Slot {
+        QTime anchorTime;
+        bool feasible = false;
+
+        /**
+         * 试排结果在铺画范围内首站的出发时刻、末站的到达时刻，
+         * 以及二者之间的总时分（秒）。仅当feasible时有效。
+         */
+        QTime startTime, endTime;
+        int runSecs = 0;
+    };
+
+    struct Summary {
+        Direction dir = Direction::Undefined;
+        int slotCount = 0;       // 扫描的锚点数
+        int feasibleCount = 0;   // 可排的锚点数
+
+        /**
+         * 按首站出发时刻去重后的不同线位数。
+         * 相邻锚点往往被推到同一线位，去重后才近似于可供选择的剩余线位数。
+         */
+        int distinctCount = 0;
+        int minRunSecs = 0, maxRunSecs = 0, avgRunSecs = 0;
+
+        double feasibleRatio()const {
+            return slotCount ? static_cast<double>(feasibleCount) / slotCount : 0;
+        }
+    };
+
+    struct Result {
+        Direction dir = Direction::Undefined;
+        std::vector<Slot> slots;   // 按锚点时刻升序
+        Summary summary;
+    };
+
+    /**
+     * 注意：仅复制config的铺画条件，此后config的变化不影响本对象。
+     */
+    explicit CapacitySlotMap(const GreedyPainter& config);
+    ~CapacitySlotMap() noexcept;
+
+    int stepSecs()const { return _stepSecs; }
+
+    /**
+     * 扫描步长，秒；限制在[1, 24*3600]之间
+     */
+    void setStepSecs(int secs);
+
+    bool bothDirections()const { return _bothDirections; }
+
+    /**
+     * 是否同时扫描反方向。反方向的条件由模板将起止站、本线始发终到对调而得，锚点站与停站不变。
+     */
+    void setBothDirections(bool on) { _bothDirections = on; }
+
+    /**
+     * 执行扫描，结果见results()。阻塞直到完成。
+     * 事件表在这里按调用时的运行图生成一次，所有试排共享。
+     */
+    void evaluate();
+
+    const auto& results()const { return _results; }
+
+    static Summary summarize(Direction dir, const std::vector<Slot>& slots);
+
+private:
+    std::unique_ptr<GreedyPainter> _config;
+    int _stepSecs = 60;
+    bool _bothDirections = false;
+    std::vector<Result> _results;
+};
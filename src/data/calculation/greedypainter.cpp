@@ -6,6 +6,7 @@
 #include <util/utilfunc.h>
 #include <data/rail/forbid.h>
 #include <data/train/trainfilterselectorcore.h>
+#include <util/qetrace.h>
 #include <exception>
 
 
@@ -21,9 +22,43 @@ GreedyPainter::GreedyPainter(Diagram& diagram, const TrainFilterSelectorCore& co
 
 }
 
+std::unique_ptr<GreedyPainter> GreedyPainter::cloneSettings() const
+{
+	auto res = std::make_unique<GreedyPainter>(diagram, filter);
+	res->_railway = _railway;
+	res->_ruler = _ruler;
+	res->_anchor = _anchor;
+	res->_start = _start;
+	res->_end = _end;
+	res->_localStarting = _localStarting;
+	res->_localTerminal = _localTerminal;
+	res->_anchorAsArrive = _anchorAsArrive;
+	res->_dir = _dir;
+	res->_anchorTime = _anchorTime;
+	res->_settledStops = _settledStops;
+	res->_fixedStations = _fixedStations;
+	res->_constraints = _constraints;
+	res->_usedForbids = _usedForbids;
+	res->_maxBackoffTimes = _maxBackoffTimes;
+	res->_logEnabled = _logEnabled;
+	return res;
+}
+
+RailwayStationEventAxis GreedyPainter::makeRailAxis() const
+{
+	return diagram.stationEventAxisForRail(_railway, *filter.filter());
+}
+
 bool GreedyPainter::paint(const TrainName& trainName)
 {
-	_railAxis = diagram.stationEventAxisForRail(_railway, *filter.filter());
+	_railAxis = makeRailAxis();
+	return paint(trainName, _railAxis);
+}
+
+bool GreedyPainter::paint(const TrainName& trainName, const RailwayStationEventAxis& axis)
+{
+	QE_TRACE_SCOPE("GreedyPainter::paint");
+	_axis = &axis;
 	_train = std::make_shared<Train>(trainName);
 	_train->setOnPainting(true);
 	_logs.clear();
@@ -114,6 +149,8 @@ bool GreedyPainter::paint(const TrainName& trainName)
 
 void GreedyPainter::addLog(std::unique_ptr<CalculationLogAbstract> log)
 {
+	if (!_logEnabled)
+		return;
 	qDebug() << log->toString() << Qt::endl;
 	//if (log->toString() == "[史家乡->内江区间运行冲突 右冲突] 将[史家乡]站[出发]时刻设置为[20:39:20] (对象: K9406)") {
 	//	qDebug() << "史家乡!";
@@ -174,8 +211,8 @@ typename GreedyPainter::RecurseReport
 
 	auto st_from = node->railInterval().fromStation();
 	auto st_to = node->railInterval().toStation();
-	const auto& ax_from = _railAxis.at(st_from);
-	const auto& ax_to = _railAxis.at(st_to);
+	const auto& ax_from = _axis->at(st_from);
+	const auto& ax_to = _axis->at(st_to);
 
 	auto itr = _settledStops.find(st_to);
 	bool next_stop = ((itr != _settledStops.end()) || (st_to == _end && _localTerminal));
@@ -208,7 +245,8 @@ typename GreedyPainter::RecurseReport
 	bool to_try_stop = false;
 
 	while (true) {
-		qDebug() << railint->toString() << "  delay: " << tot_delay << ", " << tot_delay / 3600. << Qt::endl;
+		if (_logEnabled)
+			qDebug() << railint->toString() << "  delay: " << tot_delay << ", " << tot_delay / 3600. << Qt::endl;
 		if (tot_delay >= 24 * 3600) {
 			// 没有可排的线位
 			if (st_from != _anchor)
@@ -230,48 +268,28 @@ typename GreedyPainter::RecurseReport
 			// 2023.10.17: 对于起始站停车时间被固定的，也只能回溯; 2024.02.09: 改到下面的分支里面。
 			if (!stop && st_from != _anchor) {
 				_train->timetable().pop_back();
-				qDebug() << "回溯 " << st_from->name.toSingleLiteral() << Qt::endl;
+				if (_logEnabled)
+					qDebug() << "回溯 " << st_from->name.toSingleLiteral() << Qt::endl;
 				return { RecurseStatus::RequireStop };
 			}
 			else {
 				// 调整出发时刻为使得满足条件
-				if (qeutil::timeCompare(ev_start.time, ev_conf->time)) {
-					// 右冲突事件
-					if (fixed_from) {
-						int delay_secs = qeutil::secsTo(ev_start.time, ev_conf->time);
-						FWD_FIXED_POP_AND_RETURN
-					}
-					else {
-						tot_delay += qeutil::secsTo(ev_start.time, ev_conf->time);
-						ev_start.time = ev_conf->time;
-						addLog(std::make_unique<CalculationLogGap>(CalculationLogAbstract::GapConflict,
-							st_from, ev_start.time, CalculationLogAbstract::Depart,
-							*TrainGap::gapTypeBetween(ev_start, *ev_conf, railint->isSingleRail()),
-							st_from, ev_conf
-							));
-					}
-				}
-				else {
-					// 左冲突事件，将时刻弄到与当前不冲突的地方
-					auto type = TrainGap::gapTypeBetween(*ev_conf, ev_start, railint->isSingleRail());
-					qDebug() << "左冲突：" << ev_conf->toString() << Qt::endl;
-					int gap_min = _constraints.maxConstraint(*type);
-					auto trial_tm = ev_conf->time.addSecs(gap_min);
-
-					if (fixed_from) {
-						int delay_secs = qeutil::secsTo(ev_start.time, trial_tm);
-						FWD_FIXED_POP_AND_RETURN
-					}
-					else {
-						tot_delay += qeutil::secsTo(ev_start.time, trial_tm);
-						ev_start.time = trial_tm;
-						addLog(std::make_unique<CalculationLogGap>(
-							CalculationLogAbstract::GapConflict, st_from, ev_start.time,
-							CalculationLogAbstract::Depart, *type, st_from, ev_conf
-							));
-					}
-
+				// 2026.10.19: 直接求出本站最早的可行出发时刻，不再逐个冲突事件试探。
+				// 无可行位置时，按一天计，下一轮即判定为无线位。
+				int delay_secs = ax_from.feasibleDelay(ev_start, _constraints,
+					railint->isSingleRail()).value_or(24 * 3600);
+				if (fixed_from) {
+					FWD_FIXED_POP_AND_RETURN
 				}
+				auto type = qeutil::timeCompare(ev_start.time, ev_conf->time) ?
+					TrainGap::gapTypeBetween(ev_start, *ev_conf, railint->isSingleRail()) :
+					TrainGap::gapTypeBetween(*ev_conf, ev_start, railint->isSingleRail());
+				tot_delay += delay_secs;
+				ev_start.time = ev_start.time.addSecs(delay_secs);
+				addLog(std::make_unique<CalculationLogGap>(
+					CalculationLogAbstract::GapConflict, st_from, ev_start.time,
+					CalculationLogAbstract::Depart, *type, st_from, ev_conf
+					));
 				// 到这里只能说解决了当前冲突，并不一定符合出发条件，还要进一步循环！
 				to_try_stop = false;   // 出发时刻改变后优先尝试通过
 				continue;
@@ -302,13 +320,15 @@ typename GreedyPainter::RecurseReport
 						_train->timetable().pop_back();
 						return {RecurseStatus::RequireStop};
 					}
-					else if (fixed_from) {
-						int delay_secs = qeutil::secsTo(ev_start.time, fbdnode->endTime);
+					// 2026.10.19: 一次跳过所有相互衔接的天窗
+					int delay_secs = forbidFreeDelay(*railint, ev_start.time, int_secs, false)
+						.value_or(24 * 3600);
+					if (fixed_from) {
 						FWD_FIXED_POP_AND_RETURN
 					}
 					else {
-						tot_delay += qeutil::secsTo(ev_start.time, fbdnode->endTime);
-						ev_start.time = fbdnode->endTime;
+						tot_delay += delay_secs;
+						ev_start.time = ev_start.time.addSecs(delay_secs);
 						addLog(std::make_unique<CalculationLogForbid>(st_from, ev_start.time,
 							CalculationLogAbstract::Depart, railint, forbid));
 						to_try_stop = false;
@@ -325,7 +345,7 @@ typename GreedyPainter::RecurseReport
 
 		// 区间运行冲突
 
-		auto rep = _railAxis.intervalConflicted(st_from, st_to, _dir, ev_start.time, 
+		auto rep = _axis->intervalConflicted(st_from, st_to, _dir, ev_start.time, 
 			int_secs, railint->isSingleRail(), false);
 		if (rep.type != IntervalConflictReport::NoConflict) {
 			// 存在冲突
@@ -457,42 +477,17 @@ typename GreedyPainter::RecurseReport
 				return { RecurseStatus::RequireStop };
 			}
 
-			int_secs -= node->stop;
-			TrainGap::GapTypesV2 type;
-			if (qeutil::timeCompare(tm_to, to_conf->time)) {
-				// 右冲突事件，设置出发时间使得到达时间为冲突时刻的时间
-				auto trial_tm = to_conf->time.addSecs(-int_secs);
-				if (fixed_from) {
-					int delay_secs = qeutil::secsTo(ev_start.time, trial_tm);
-					if (st_from != _anchor)
-						_train->timetable().pop_back();
-					return { RecurseStatus::FixedStation, delay_secs };
-				}
-				else {
-					tot_delay += qeutil::secsTo(ev_start.time, trial_tm);
-					ev_start.time = trial_tm;
-					type = *TrainGap::gapTypeBetween(ev_stop, *to_conf, railint->isSingleRail());
-				}
-			}
-			else {
-				// 左冲突事件，将时刻弄到与当前不冲突的地方
-				type = *TrainGap::gapTypeBetween(*to_conf, ev_stop, railint->isSingleRail());
-				int gap_min = _constraints.maxConstraint(type);   
-
-				QTime trial_arr = to_conf->time.addSecs(gap_min);
-				QTime trial_dep = trial_arr.addSecs(-int_secs);
-
-				if (fixed_from) {
-					if (st_from != _anchor)
-						_train->timetable().pop_back();
-					int delay_secs = qeutil::secsTo(ev_start.time, trial_dep);
-					return {RecurseStatus::FixedStation, delay_secs}; 
-				}
-				else {
-				tot_delay += qeutil::secsTo(ev_start.time, trial_dep);
-				ev_start.time = trial_dep;
-				}
+			// 2026.10.19: 按后站最早可行的到达时刻整体平移出发时刻
+			int delay_secs = ax_to.feasibleDelay(ev_stop, _constraints,
+				railint->isSingleRail()).value_or(24 * 3600);
+			if (fixed_from) {
+				FWD_FIXED_POP_AND_RETURN
 			}
+			TrainGap::GapTypesV2 type = qeutil::timeCompare(tm_to, to_conf->time) ?
+				*TrainGap::gapTypeBetween(ev_stop, *to_conf, railint->isSingleRail()) :
+				*TrainGap::gapTypeBetween(*to_conf, ev_stop, railint->isSingleRail());
+			tot_delay += delay_secs;
+			ev_start.time = ev_start.time.addSecs(delay_secs);
 			addLog(std::make_unique<CalculationLogGap>(
 				CalculationLogAbstract::GapConflict, st_from, ev_start.time,
 				CalculationLogAbstract::Depart, type, st_to, to_conf
@@ -530,8 +525,8 @@ typename GreedyPainter::RecurseReport
 
 	auto st_from = node->railInterval().toStation();
 	auto st_to = node->railInterval().fromStation();
-	const auto& ax_from = _railAxis.at(st_from);
-	const auto& ax_to = _railAxis.at(st_to);
+	const auto& ax_from = _axis->at(st_from);
+	const auto& ax_to = _axis->at(st_to);
 	auto fixed_from = (_fixedStations.find(st_from.get()) != _fixedStations.end());
 	auto fixed_to = (_fixedStations.find(st_from.get()) != _fixedStations.end());
 
@@ -565,7 +560,8 @@ typename GreedyPainter::RecurseReport
 	bool to_try_stop = false;
 
 	while (true) {
-		qDebug() << railint->toString() << "  delay: " << tot_delay << ", " << tot_delay / 3600. << Qt::endl;
+		if (_logEnabled)
+			qDebug() << railint->toString() << "  delay: " << tot_delay << ", " << tot_delay / 3600. << Qt::endl;
 		if (tot_delay >= 24 * 3600) {
 			// 没有可排的线位
 			if (st_from != _anchor)
@@ -588,47 +584,27 @@ typename GreedyPainter::RecurseReport
 			if (!stop) {
 				if (st_from!=_anchor)
 					_train->timetable().pop_front();
-				qDebug() << "回溯 " << st_from->name.toSingleLiteral() << Qt::endl;
+				if (_logEnabled)
+					qDebug() << "回溯 " << st_from->name.toSingleLiteral() << Qt::endl;
 				return { RecurseStatus::RequireStop };
 			}
 			else {
 				// 调整出发时刻为使得满足条件
-				if (qeutil::timeCompare(ev_conf->time, ev_arrive.time)) {
-					// 反向左冲突，原来右冲突
-					int delay_secs = qeutil::secsTo(ev_conf->time, ev_arrive.time);
-					if (fixed_from) {
-						BACK_FIXED_POP_AND_RETURN
-					}
-					else {
-						tot_delay += delay_secs;
-						ev_arrive.time = ev_conf->time;
-						addLog(std::make_unique<CalculationLogGap>(CalculationLogAbstract::GapConflict,
-							st_from, ev_arrive.time, CalculationLogAbstract::Arrive,
-							*TrainGap::gapTypeBetween(*ev_conf, ev_arrive, railint->isSingleRail()),
-							st_from, ev_conf
-							));
-					}
-				}
-				else {
-					// 反向右冲突事件，将时刻弄到与当前不冲突的地方
-					auto type = TrainGap::gapTypeBetween(ev_arrive, *ev_conf, railint->isSingleRail());
-					int gap_min = _constraints.maxConstraint(*type);   
-					auto trial_tm = ev_conf->time.addSecs(-gap_min);
-					int delay_secs = qeutil::secsTo(trial_tm, ev_arrive.time);
-					if (fixed_from) {
-						if (st_from != _anchor) _train->timetable().pop_front();
-						return { RecurseStatus::FixedStation, delay_secs };
-					}
-					else {
-						tot_delay += delay_secs;
-						ev_arrive.time = trial_tm;
-						addLog(std::make_unique<CalculationLogGap>(
-							CalculationLogAbstract::GapConflict, st_from, ev_arrive.time,
-							CalculationLogAbstract::Arrive, *type, st_from, ev_conf
-							));
-					}
-
+				// 2026.10.19: 直接求出本站最晚的可行时刻，同正向
+				int delay_secs = ax_from.feasibleDelay(ev_arrive, _constraints,
+					railint->isSingleRail(), true).value_or(24 * 3600);
+				if (fixed_from) {
+					BACK_FIXED_POP_AND_RETURN
 				}
+				auto type = qeutil::timeCompare(ev_conf->time, ev_arrive.time) ?
+					TrainGap::gapTypeBetween(*ev_conf, ev_arrive, railint->isSingleRail()) :
+					TrainGap::gapTypeBetween(ev_arrive, *ev_conf, railint->isSingleRail());
+				tot_delay += delay_secs;
+				ev_arrive.time = ev_arrive.time.addSecs(-delay_secs);
+				addLog(std::make_unique<CalculationLogGap>(
+					CalculationLogAbstract::GapConflict, st_from, ev_arrive.time,
+					CalculationLogAbstract::Arrive, *type, st_from, ev_conf
+					));
 				// 到这里只能说解决了当前冲突，并不一定符合出发条件，还要进一步循环！
 				to_try_stop = false;   // 出发时刻改变后优先尝试通过
 				continue;
@@ -660,15 +636,15 @@ typename GreedyPainter::RecurseReport
 							_train->timetable().pop_front();
 						return {RecurseStatus::RequireStop};
 					}
-					else if (fixed_from) {
-						if (st_from != _anchor)
-							_train->timetable().pop_front();
-						int delay_secs = qeutil::secsTo(fbdnode->beginTime, ev_arrive.time);
-						return { RecurseStatus::FixedStation, delay_secs };
+					// 2026.10.19: 一次跳过所有相互衔接的天窗
+					int delay_secs = forbidFreeDelay(*railint, ev_arrive.time, int_secs, true)
+						.value_or(24 * 3600);
+					if (fixed_from) {
+						BACK_FIXED_POP_AND_RETURN
 					}
 					else {
-						tot_delay += qeutil::secsTo(fbdnode->beginTime, ev_arrive.time);
-						ev_arrive.time = fbdnode->beginTime;
+						tot_delay += delay_secs;
+						ev_arrive.time = ev_arrive.time.addSecs(-delay_secs);
 						addLog(std::make_unique<CalculationLogForbid>(st_from, ev_arrive.time,
 							CalculationLogAbstract::Arrive,  railint, forbid));
 						to_try_stop = false;
@@ -684,7 +660,7 @@ typename GreedyPainter::RecurseReport
 
 		// 区间运行冲突  注意区间的判定按照正向运行的逻辑传参
 
-		auto rep = _railAxis.intervalConflicted(st_to, st_from, _dir, tm_dep, int_secs, 
+		auto rep = _axis->intervalConflicted(st_to, st_from, _dir, tm_dep, int_secs, 
 			railint->isSingleRail(), true);
 		if (rep.type != IntervalConflictReport::NoConflict) {
 			// 存在冲突
@@ -811,36 +787,17 @@ typename GreedyPainter::RecurseReport
 				return {RecurseStatus::RequireStop};
 			}
 
-			int_secs -= node->start;
-			TrainGap::GapTypesV2 type;
-			if (qeutil::timeCompare(to_conf->time, tm_dep)) {
-				// 反向左冲突事件，设置出发时间使得到达时间为冲突时刻的时间
-				auto tm_trial = to_conf->time.addSecs(int_secs);
-				int delay_secs = qeutil::secsTo(tm_trial, ev_arrive.time);
-				if (fixed_from) {
-					BACK_FIXED_POP_AND_RETURN
-				}
-				else {
-					tot_delay += delay_secs;
-					ev_arrive.time = tm_trial;
-					type = *TrainGap::gapTypeBetween(*to_conf, ev_depart, railint->isSingleRail());
-				}
-			}
-			else {
-				// 反向右冲突事件，将时刻弄到与当前不冲突的地方
-				type = *TrainGap::gapTypeBetween(ev_depart, *to_conf, railint->isSingleRail());
-				int gap_min = _constraints.maxConstraint(type);  
-				QTime trial_dep = to_conf->time.addSecs(-gap_min);
-				QTime trial_arr = trial_dep.addSecs(int_secs);
-				int delay_secs = qeutil::secsTo(trial_arr, ev_arrive.time);
-				if (fixed_from) {
-					BACK_FIXED_POP_AND_RETURN
-				}
-				else {
-					tot_delay += delay_secs;
-					ev_arrive.time = trial_arr;
-				}
+			// 2026.10.19: 按后站最晚可行的出发时刻整体平移
+			int delay_secs = ax_to.feasibleDelay(ev_depart, _constraints,
+				railint->isSingleRail(), true).value_or(24 * 3600);
+			if (fixed_from) {
+				BACK_FIXED_POP_AND_RETURN
 			}
+			TrainGap::GapTypesV2 type = qeutil::timeCompare(to_conf->time, tm_dep) ?
+				*TrainGap::gapTypeBetween(*to_conf, ev_depart, railint->isSingleRail()) :
+				*TrainGap::gapTypeBetween(ev_depart, *to_conf, railint->isSingleRail());
+			tot_delay += delay_secs;
+			ev_arrive.time = ev_arrive.time.addSecs(-delay_secs);
 			addLog(std::make_unique<CalculationLogGap>(
 				CalculationLogAbstract::GapConflict, st_from, ev_arrive.time,
 				CalculationLogAbstract::Arrive, type, st_to, to_conf
@@ -850,3 +807,23 @@ typename GreedyPainter::RecurseReport
 	}
 }
 #undef BACK_FIXED_POP_AND_RETURN
+
+std::optional<int> GreedyPainter::forbidFreeDelay(const RailInterval& railint, const QTime& tm,
+	int int_secs, bool backward) const
+{
+	// 在平移量d的坐标下，天窗[b, b+D]与区间运行相交（不含端点）当且仅当 d∈(r-int_secs, r+D)，
+	// 其中r为正向时tm到天窗开始的秒数，反向时天窗结束到tm的秒数。
+	std::vector<std::pair<int, int>> windows;
+	for (const auto& forbid : _usedForbids) {
+		auto fbdnode = railint.getForbidNode(forbid);
+		if (fbdnode->isNull())
+			continue;
+		int dur = fbdnode->durationSec();
+		if (dur == 0)
+			continue;
+		int r = backward ? qeutil::secsTo(fbdnode->endTime, tm) : qeutil::secsTo(tm, fbdnode->beginTime);
+		windows.emplace_back(r - int_secs + 1, r + dur - 1);
+		windows.emplace_back(r - int_secs + 1 - 24 * 3600, r + dur - 1 - 24 * 3600);
+	}
+	return StationEventAxis::firstFreeOffset(windows);
+}
@@ -1,5 +1,6 @@
 ﻿#pragma once
 #include <memory>
+#include <optional>
 #include "gapconstraints.h"
 #include "railwaystationeventaxis.h"
 #include "calculationlog.h"
@@ -45,6 +46,14 @@ class GreedyPainter
 	GapConstraints _constraints;
 	RailwayStationEventAxis _railAxis;
 
+	/**
+	 * 2026.10.19
+	 * 推线实际使用的事件表：一般指向_railAxis；
+	 * 若由外部提供（见paint()的重载），则指向外部只读的事件表，以便多个实例共享。
+	 */
+	const RailwayStationEventAxis* _axis = nullptr;
+	bool _logEnabled = true;
+
 	std::vector<std::unique_ptr<CalculationLogAbstract>> _logs;
 	std::vector<std::shared_ptr<Forbid>> _usedForbids;
 
@@ -82,6 +91,26 @@ public:
 	auto train() { return _train; }
 	auto& logs() { return _logs; }
 	auto& usedForbids() { return _usedForbids; }
+	const auto& usedForbids()const { return _usedForbids; }
+
+	/**
+	 * 2026.10.19  是否记录推线日志（包括调试输出）。批量试排时关闭以节约开销。
+	 */
+	bool logEnabled()const { return _logEnabled; }
+	void setLogEnabled(bool on) { _logEnabled = on; }
+
+	/**
+	 * 2026.10.19
+	 * 以同一运行图和筛选器创建新实例，并复制全部铺画条件（线路、标尺、站点、方向、时刻、停站、约束、天窗等）；
+	 * 不复制推线结果、日志与事件表。用于并行试排时为每个线程创建独立的实例。
+	 */
+	std::unique_ptr<GreedyPainter> cloneSettings()const;
+
+	/**
+	 * 2026.10.19
+	 * 按当前线路与筛选器生成事件表，供paint(trainName, axis)共享使用。
+	 */
+	RailwayStationEventAxis makeRailAxis()const;
 
 	/**
 	 * @brief paint  核心接口函数，铺画运行线。
@@ -92,6 +121,13 @@ public:
 	 */
 	bool paint(const TrainName& trainName);
 
+	/**
+	 * 2026.10.19
+	 * 在外部提供的事件表上推线。事件表只读，可由多个实例（多个线程）共享；
+	 * 调用者须保证推线期间axis有效且不被修改。
+	 */
+	bool paint(const TrainName& trainName, const RailwayStationEventAxis& axis);
+
 private:
 	void addLog(std::unique_ptr<CalculationLogAbstract> log);
 
@@ -123,5 +159,14 @@ private:
 	RecurseReport calForward(std::shared_ptr<const RailInterval> railint, const QTime& tm, bool stop);
 
 	RecurseReport calBackward(std::shared_ptr<const RailInterval> railint, const QTime& tm, bool stop);
+
+	/**
+	 * 2026.10.19
+	 * 求使区间运行 [tm, tm+int_secs] （反向时为 [tm-int_secs, tm]）不与任何所用天窗相交的最小平移秒数。
+	 * 各天窗给出的禁止区间取并集后二分查找，与StationEventAxis::feasibleDelay()同理。
+	 * 一天之内无可行位置时返回空。
+	 */
+	std::optional<int> forbidFreeDelay(const RailInterval& railint, const QTime& tm,
+		int int_secs, bool backward)const;
 };
 
@@ -38,17 +38,83 @@ StationEventAxis::positionEvents(RailStationEventBase::Position pos) const
 	}
 }
 
+void StationEventAxis::constructKeyedTimes()
+{
+	_keyed.clear();
+	_keyed.secs.reserve(size());
+	_keyed.keys.reserve(size());
+	for (const auto& ev : *this) {
+		auto key = eventKey(*ev);
+		_keyed.secs.push_back(ev->time.msecsSinceStartOfDay() / 1000);
+		_keyed.keys.push_back(key);
+		_keyed.mask |= (1u << key);
+	}
+}
+
+const StationEventAxis::KeyedTimes& StationEventAxis::keyedTimes(KeyedTimes& buffer) const
+{
+	if (_keyed.secs.size() == static_cast<size_t>(size()))
+		return _keyed;
+	// 事件表被直接修改过，临时重建
+	buffer.clear();
+	for (const auto& ev : *this) {
+		auto key = eventKey(*ev);
+		buffer.secs.push_back(ev->time.msecsSinceStartOfDay() / 1000);
+		buffer.keys.push_back(key);
+		buffer.mask |= (1u << key);
+	}
+	return buffer;
+}
+
+std::uint8_t StationEventAxis::eventKey(const RailStationEventBase& ev)
+{
+	return static_cast<std::uint8_t>((ev.pos.testFlag(RailStationEventBase::Pre) ? 0b01 : 0)
+		| (ev.pos.testFlag(RailStationEventBase::Post) ? 0b10 : 0)
+		| ((static_cast<int>(ev.dir) & 0b11) << 2)
+		| (ev.hasAppend() ? 0b10000 : 0));
+}
+
+typename StationEventAxis::GapThresholds StationEventAxis::gapThresholds(
+	const RailStationEventBase& ev, const GapConstraints& constraint, bool singleLine,
+	std::uint32_t mask)
+{
+	GapThresholds res;
+	for (int key = 0; key < 32; key++) {
+		if (!(mask & (1u << key)))
+			continue;
+		// 以同类别的代表事件求间隔类型；时刻不影响间隔类型
+		RailStationEventBase rep((key & 0b10000) ? TrainEventType::Arrive : TrainEventType::CalculatedPass,
+			ev.time, static_cast<RailStationEventBase::Position>(key & 0b11),
+			static_cast<Direction>((key >> 2) & 0b11));
+		// 约定正好相等的情况是符合要求（不冲突）的，故阈值即为约束值
+		if (auto t = TrainGap::gapTypeBetween(rep, ev, singleLine))
+			res.left[key] = constraint.maxConstraint(*t);
+		if (auto t = TrainGap::gapTypeBetween(ev, rep, singleLine))
+			res.right[key] = constraint.maxConstraint(*t);
+	}
+	return res;
+}
+
 void StationEventAxis::buildAxis()
 {
 	sortEvents();
 	constructLineMap();
+	constructKeyedTimes();
 }
 
 void StationEventAxis::insertEvent(std::shared_ptr<RailStationEvent> ev)
 {
+	bool keyed = (_keyed.secs.size() == static_cast<size_t>(size()));
 	//如果有时刻一样的，新的在后面
 	auto itr = std::upper_bound(begin(), end(), ev, RailStationEvent::PtrTimeComparator());
+	auto idx = std::distance(begin(), itr);
 	insert(itr, ev);
+	if (keyed) {
+		auto key = eventKey(*ev);
+		_keyed.secs.insert(_keyed.secs.begin() + idx, ev->time.msecsSinceStartOfDay() / 1000);
+		_keyed.keys.insert(_keyed.keys.begin() + idx, key);
+		_keyed.mask |= (1u << key);
+	}
 	if (ev->pos & RailStationEventBase::Pre) {
 		_preEvents.emplace(ev->line, ev);
 	}
@@ -61,74 +127,116 @@ std::shared_ptr<RailStationEvent> StationEventAxis::conflictEvent(
 	const RailStationEventBase& ev,
 	const GapConstraints& constraint, bool singleLine) const
 {
-	int bound = constraint.correlationRange();
-	QTime leftBound = ev.time.addSecs(-bound), rightBound = ev.time.addSecs(bound);
-	// upper_bound 正好与reverse_iterator配合使用
-	auto citr = std::upper_bound(begin(), end(), ev.time,
-		RailStationEvent::PtrTimeComparator());
-
-	// 左侧
-	if (leftBound > ev.time) {
-		// 发生左跨日情况
-		for (auto ritr = std::make_reverse_iterator(citr); ritr != rend(); ++ritr) {
-			if (isConflict(**ritr, ev, constraint, singleLine))
-				return *ritr;
-		}
-		for (auto ritr = rbegin(); ritr != rend(); ++ritr) {
-			if ((*ritr)->time < leftBound)
-				break;
-			if (isConflict(**ritr, ev, constraint, singleLine))
-				return *ritr;
-		}
+	constexpr int secsOfADay = 24 * 3600;
+	KeyedTimes buffer;
+	const auto& kt = keyedTimes(buffer);
+	const auto th = gapThresholds(ev, constraint, singleLine, kt.mask);
+	const int* secs = kt.secs.data();
+	const std::uint8_t* keys = kt.keys.data();
+	const int n = static_cast<int>(kt.secs.size());
+
+	const int bound = constraint.correlationRange();
+	const int t = ev.time.msecsSinceStartOfDay() / 1000;
+	// 时刻相等的归入左侧
+	const int mid = static_cast<int>(std::upper_bound(secs, secs + n, t) - secs);
+
+	// 左侧，由近及远
+	const int left_bound = t - bound;
+	for (int i = mid - 1; i >= 0 && secs[i] >= left_bound; i--) {
+		if (t - secs[i] < th.left[keys[i]])
+			return at(i);
 	}
-	else {
-		// 不发生左跨日
-		for (auto ritr = std::make_reverse_iterator(citr);
-			ritr != rend() && (*ritr)->time >= leftBound; ++ritr) {
-			if (isConflict(**ritr, ev, constraint, singleLine))
-				return *ritr;
+	if (left_bound < 0) {
+		// 发生左跨日
+		for (int i = n - 1; i >= mid && secs[i] >= left_bound + secsOfADay; i--) {
+			if (t + secsOfADay - secs[i] < th.left[keys[i]])
+				return at(i);
 		}
 	}
 
 	// 右侧
-	if (rightBound < ev.time) {
+	const int right_bound = t + bound;
+	for (int i = mid; i < n && secs[i] <= right_bound; i++) {
+		if (secs[i] - t < th.right[keys[i]])
+			return at(i);
+	}
+	if (right_bound >= secsOfADay) {
 		// 右跨日
-		for (auto itr = citr; itr != end(); ++itr) {
-			if (isConflict(ev, **itr, constraint, singleLine))
-				return *itr;
-		}
-		for (auto itr = begin(); itr != end() && (*itr)->time <= rightBound; ++itr) {
-			if (isConflict(ev, **itr, constraint, singleLine))
-				return *itr;
+		for (int i = 0; i < mid && secs[i] <= right_bound - secsOfADay; i++) {
+			if (secs[i] + secsOfADay - t < th.right[keys[i]])
+				return at(i);
 		}
 	}
-	else {
-		for (auto itr = citr; itr != end() && (*itr)->time <= rightBound; ++itr) {
-			if (isConflict(ev, **itr, constraint, singleLine)) {
-				return *itr;
-			}
+	return nullptr;
+}
+
+std::optional<int> StationEventAxis::feasibleDelay(const RailStationEventBase& ev,
+	const GapConstraints& constraint, bool singleLine, bool backward) const
+{
+	constexpr int secsOfADay = 24 * 3600;
+	KeyedTimes buffer;
+	const auto& kt = keyedTimes(buffer);
+	const auto th = gapThresholds(ev, constraint, singleLine, kt.mask);
+	const int n = static_cast<int>(kt.secs.size());
+	const int t = ev.time.msecsSinceStartOfDay() / 1000;
+
+	std::vector<std::pair<int, int>> windows;
+	windows.reserve(n * 4);
+
+	// 在平移量d的坐标下，设事件e距ev的距离为r：
+	// e作为左事件时，需 0 <= 间隔 < cl 才冲突；作为右事件时，需 0 < 间隔 < cr 才冲突。
+	// 正向：左冲突 d∈[r, r+cl)，右冲突 d∈(r-cr, r)
+	// 反向：左冲突 d∈(r-cl, r]，右冲突 d∈(r, r+cr)
+	auto push = [&windows](int first, int last) {
+		if (first <= last) {
+			windows.emplace_back(first, last);
+			// 跨日的镜像，处理时刻在ev另一侧的事件
+			windows.emplace_back(first - secsOfADay, last - secsOfADay);
+		}
+	};
+
+	for (int i = 0; i < n; i++) {
+		const int cl = th.left[kt.keys[i]], cr = th.right[kt.keys[i]];
+		if (!backward) {
+			int r = kt.secs[i] - t;
+			if (r < 0) r += secsOfADay;
+			push(r, r + cl - 1);
+			push(r - cr + 1, r - 1);
+		}
+		else {
+			int r = t - kt.secs[i];
+			if (r < 0) r += secsOfADay;
+			push(r - cl + 1, r);
+			push(r + 1, r + cr - 1);
 		}
 	}
-	return nullptr;
+	return firstFreeOffset(windows);
 }
 
-bool StationEventAxis::isConflict(const RailStationEventBase& left,
-	const RailStationEventBase& right,
-	const GapConstraints& constraint,
-	bool singleLine) const
+std::optional<int> StationEventAxis::firstFreeOffset(std::vector<std::pair<int, int>>& windows)
 {
-	auto gap_type = TrainGap::gapTypeBetween(left, right, singleLine);
-	if (gap_type.has_value()) {
-		// 构成相干事件，检查间隔是否符合要求。
-		// 注意约定正好相等的情况是符合要求（不冲突）的
-		int secs = qeutil::secsTo(left.time, right.time);
-		//if (secs < constraint.at(*gap_type)) {
-		//	return true;
-		//}
-		// API V2
-		if (constraint.checkConflict(*gap_type, secs)) {
-			return true;
+	constexpr int secsOfADay = 24 * 3600;
+	std::sort(windows.begin(), windows.end());
+
+	// 合并相交或相邻的区间
+	std::vector<std::pair<int, int>> merged;
+	for (const auto& w : windows) {
+		if (!merged.empty() && w.first <= merged.back().second + 1) {
+			merged.back().second = std::max(merged.back().second, w.second);
+		}
+		else {
+			merged.push_back(w);
 		}
 	}
-	return false;
+
+	// 第一个右端不小于0的区间；若其包含0，则紧随其后的位置就是可行的
+	auto itr = std::lower_bound(merged.begin(), merged.end(), 0,
+		[](const std::pair<int, int>& w, int x) { return w.second < x; });
+	int res = 0;
+	if (itr != merged.end() && itr->first <= 0) {
+		res = itr->second + 1;
+	}
+	if (res >= secsOfADay)
+		return std::nullopt;
+	return res;
 }
@@ -1,6 +1,10 @@
 ﻿#pragma once
+#include <array>
+#include <cstdint>
 #include <map>
+#include <optional>
 #include <unordered_map>
+#include <vector>
 #include "data/diagram/trainevents.h"
 
 class GapConstraints;
@@ -11,6 +15,9 @@ class GapConstraints;
  * 各个事件按照时间排序，支持二分查找。
  * 主要用于排图时，检测所给的时刻（或者：新插入的事件）是否符合约束条件。
  * 注意顺序应当由调用者来保证。本类直接开放vector的接口，并不做保证。
+ * 2026.10.19: 另维护一份与事件表平行的紧凑数组（时刻秒数、打包的事件属性），
+ * 由buildAxis()和insertEvent()更新；冲突扫描在这些数组上进行。
+ * 直接通过vector接口修改事件表后，应当重新调用buildAxis()，否则扫描时临时重建，效率较低。
  */
 class StationEventAxis:
         public QVector<std::shared_ptr<RailStationEvent>>
@@ -22,6 +29,29 @@ class StationEventAxis:
      * 显然，同一运行线在站前或站后分别最多只出现一次。通过事件同时算站前和站后。
      */
      line_map_t _preEvents, _postEvents;
+
+    /**
+     * 2026.10.19
+     * 与事件表逐项平行的SoA视图：secs为日内秒数，keys为eventKey()打包的位置、方向、附加时分标志；
+     * mask记录出现过的key，用于只对实际出现的事件类别查间隔约束。
+     */
+    struct KeyedTimes {
+        std::vector<int> secs;
+        std::vector<std::uint8_t> keys;
+        std::uint32_t mask = 0;
+
+        void clear() { secs.clear(); keys.clear(); mask = 0; }
+    };
+    KeyedTimes _keyed;
+
+    /**
+     * 2026.10.19
+     * 对给定的待排事件，各类别（key）事件作为左、右事件时的冲突阈值（秒）：
+     * 间隔小于阈值即冲突；不构成间隔的阈值为0。
+     */
+    struct GapThresholds {
+        std::array<int, 32> left{}, right{};
+    };
 public:
     using QVector<std::shared_ptr<RailStationEvent>>::QVector;
 
@@ -62,6 +92,34 @@ public:
                       const GapConstraints& constraint,
                       bool singleLine) const;
 
+    /**
+     * 2026.10.19
+     * @brief feasibleDelay  求使ev与本轴上所有事件都不冲突的最小平移秒数。
+     * 每个相干事件按其间隔约束给出一段禁止的平移区间，取并集后二分查找第一个可行位置，
+     * 一次得到最早（反向推线时为最晚）可行时刻，不必逐个冲突事件反复试探。
+     * 判定规则与conflictEvent()一致。
+     * @param backward  为true时向时间减小方向平移（反向推线）
+     * @return  一天之内没有可行位置时返回空
+     */
+    std::optional<int>
+        feasibleDelay(const RailStationEventBase& ev,
+                      const GapConstraints& constraint,
+                      bool singleLine, bool backward = false) const;
+
+    /**
+     * 2026.10.19
+     * 给定若干禁止的偏移区间（闭区间，单位秒），合并后二分查找不小于0的第一个可行偏移。
+     * 不小于一天的视为不可行，返回空。windows会被就地排序。
+     */
+    static std::optional<int> firstFreeOffset(std::vector<std::pair<int, int>>& windows);
+
+    /**
+     * 2026.10.19
+     * 将位置（低2位）、方向（2位）、是否有附加时分（1位）打包为5位的类别码。
+     * 间隔类型只取决于这些属性，与具体时刻和运行线无关。
+     */
+    static std::uint8_t eventKey(const RailStationEventBase& ev);
+
 private:
 
     /**
@@ -75,10 +133,19 @@ private:
      */
     void constructLineMap();
 
-    bool isConflict(const RailStationEventBase& left,
-                    const RailStationEventBase& right,
-                    const GapConstraints& constraint,
-                    bool singleLine) const;
+    /**
+     * 2026.10.19  按当前事件表重建_keyed
+     */
+    void constructKeyedTimes();
+
+    /**
+     * 2026.10.19
+     * 若_keyed与事件表一致，直接返回之；否则在buffer中临时重建并返回buffer。
+     */
+    const KeyedTimes& keyedTimes(KeyedTimes& buffer)const;
+
+    static GapThresholds gapThresholds(const RailStationEventBase& ev,
+        const GapConstraints& constraint, bool singleLine, std::uint32_t mask);
 
 
 };
@@ -68,6 +68,8 @@ void SystemJson::fromJson(const QJsonObject& obj)
     auto_highlight_on_selected = obj.value("auto_highlight_on_selected").toBool(true);
     show_start_page = obj.value("show_start_page").toBool(true);
     transparent_config = obj.value("transparent_config").toBool(true);
+    journal_enabled = obj.value("journal_enabled").toBool(false);
+    journal_incremental_save = obj.value("journal_incremental_save").toBool(false);
     inform_dragging = obj.value("inform_dragging").toBool(true);
 
     const QJsonArray& arhis = obj.value("history").toArray();
@@ -97,6 +99,8 @@ QJsonObject SystemJson::toJson() const
         {"auto_highlight_on_selected",auto_highlight_on_selected},
         {"show_start_page",show_start_page},
         {"transparent_config", transparent_config},
+        {"journal_enabled", journal_enabled},
+        {"journal_incremental_save", journal_incremental_save},
         {"inform_dragging", inform_dragging},
     };
 }
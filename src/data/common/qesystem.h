@@ -44,6 +44,20 @@ public:
      */
     bool transparent_config = true;
 
+    /**
+     * 2026.10.19  编辑日志：未保存的修改追加记录到运行图文件旁的*.journal中，
+     * 用于异常退出后的恢复。关闭时不新建日志；打开文件时已有的日志仍然读取、接续，
+     * 直到下一次完整保存后删除。
+     */
+    bool journal_enabled = false;
+
+    /**
+     * 2026.10.19  增量保存：保存时只在编辑日志（*.journal）中确认修改，
+     * 日志过大时才完整写入运行图文件。需要启用编辑日志。
+     * 启用后，运行图文件本身可能不是最新的，须与日志一起使用。
+     */
+    bool journal_incremental_save = false;
+
     //todo: dock show..
 
     /**
@@ -1,5 +1,6 @@
 ﻿#include "diagram.h"
 #include "data/rail/railway.h"
+#include "data/rail/railwaypool.h"
 #include "trainadapter.h"
 #include "util/utilfunc.h"
 #include "data/train/routing.h"
@@ -9,12 +10,20 @@
 #include "mainwindow/version.h"
 #include "data/common/qesystem.h"
 #include "log/IssueManager.h"
+#include "util/qeparallel.hpp"
+#include "data/trainpath/trainpathbinding.h"
+#include "diagramdirty.h"
+#include "diagrambinary.h"
+#include "util/qetrace.h"
 
 #include <QFile>
+#include <QSaveFile>
 #include <QJsonObject>
 #include <numeric>
+#include <algorithm>
 #include <QJsonDocument>
 #include <cmath>
+#include <unordered_map>
 
 
 void Diagram::addRailway(std::shared_ptr<Railway> rail)
@@ -74,6 +83,7 @@ void Diagram::updateRailway(std::shared_ptr<Railway> r)
     foreach (const auto& p, _trainCollection.trains()){
         p->updateBoundRailway(r, _config);
     }
+    _eventCache.prune();
 }
 
 void Diagram::updateTrain(std::shared_ptr<Train> t)
@@ -86,13 +96,67 @@ void Diagram::updateTrain(std::shared_ptr<Train> t)
     else {
         t->bindWithPath();
     }
+    // 旧运行线的缓存项作废；与之相交的运行线在下次查询时自动重算
+    _eventCache.prune();
+}
+
+void Diagram::refreshDirty(DiagramDirty& dirty)
+{
+    if (!dirty.rebind)
+        return;
+    for (const auto& p : _pathcoll.paths()) {
+        bool touched = dirty.paths.count(p.get());
+        for (auto itr = dirty.railways.begin(); !touched && itr != dirty.railways.end(); ++itr) {
+            touched = p->containsRailway(itr->get());
+        }
+        if (touched) {
+            p->checkIsValid();
+            dirty.paths.insert(p.get());
+        }
+    }
+    for (const auto& r : dirty.railways) {
+        const auto& affected = _trainCollection.affectedTrainsByRailInPath(r);
+        dirty.trains.insert(affected.begin(), affected.end());
+    }
+    for (auto* p : dirty.paths) {
+        for (const auto& t : p->trainsShared()) {
+            if (t) dirty.trains.insert(t);
+        }
+    }
+
+    if (!dirty.railways.empty()) {
+        foreach(const auto & t, _trainCollection.trains()) {
+            if (!t->paths().empty())
+                continue;
+            for (const auto& r : dirty.railways) {
+                t->updateBoundRailway(r, _config);
+            }
+        }
+    }
+
+    if (dirty.rebindPathTrains) {
+        std::vector<std::shared_ptr<Train>> path_trains;
+        for (const auto& t : dirty.trains) {
+            if (!t->paths().empty()) {
+                path_trains.emplace_back(t);
+                dirty.replaced.emplace_back(t, std::move(t->adapters()));
+            }
+        }
+        TrainPathBinding::bindTrains(path_trains);
+    }
+    _eventCache.prune();
 }
 
 TrainEventList Diagram::listTrainEvents(const Train& train) const
 {
+    QE_TRACE_SCOPE("Diagram::listTrainEvents");
     TrainEventList res;
     foreach (auto p , train.adapters()) {
-        res.push_back(qMakePair(p, p->listAdapterEvents(_trainCollection)));
+        AdapterEventList lst;
+        for (const auto& line : p->lines()) {
+            lst.append(_eventCache.lineEvents(line, _trainCollection));
+        }
+        res.push_back(qMakePair(p, lst));
     }
     return res;
 }
@@ -126,6 +190,7 @@ DiagnosisList Diagram::diagnoseTrain(const Train& train, bool withIntMeet,
 DiagnosisList Diagram::diagnoseAllTrains(std::shared_ptr<Railway> railway, std::shared_ptr<RailStation> start,
     std::shared_ptr<RailStation> end) const
 {
+    QE_TRACE_SCOPE("Diagram::diagnoseAllTrains");
     DiagnosisList res;
     foreach(auto t, _trainCollection.trains()) {
         res.append(diagnoseTrain(*t, true, railway, start, end));
@@ -248,7 +313,10 @@ void Diagram::removeRailwayAtU(int i)
 
 void Diagram::rebindAllTrains()
 {
+    QE_TRACE_SCOPE("Diagram::rebindAllTrains");
     IssueManager::get()->clear();
+    _eventCache.clear();
+    std::vector<std::shared_ptr<Train>> path_trains;
     foreach (auto t , _trainCollection.trains()) {
         if (t->paths().empty()) {
             t->clearBoundRailways();
@@ -257,9 +325,11 @@ void Diagram::rebindAllTrains()
             }
         }
         else {
-            t->bindWithPath();
+            path_trains.emplace_back(t);
         }
     }
+    // 2026.10.19  按径路绑定的车次：每条径路只解析一次，并行绑定
+    TrainPathBinding::bindTrains(path_trains);
 }
 
 void Diagram::refreshAll()
@@ -384,6 +454,7 @@ std::map<std::shared_ptr<RailStation>, RailStationEventList>
 RailwayStationEventAxis Diagram::stationEventAxisForRail(std::shared_ptr<Railway> railway, 
     const ITrainFilter& filter) const
 {
+    QE_TRACE_SCOPE("Diagram::stationEventAxisForRail");
     RailwayStationEventAxis res;
     foreach(auto p, qAsConst(railway->stations())) {
         if (p->direction != PassedDirection::NoVia) {
@@ -755,44 +826,90 @@ ReadRulerReport Diagram::rulerFromMultiTrains(std::shared_ptr<Railway> railway,
     bool useAverage, int defaultStart, int defaultStop, 
     int cutStd, int cutSec, int prec, int cutCount)
 {
-    ReadRulerReport res;
-    //先直接把要计算的区间都加进去，免得多搞个set
-    foreach(auto p, intervals) {
-        res.insert({ p,{} });
-    }
-    decltype(res.begin()) itr;
-
-    foreach(auto train, trains) {
-        auto adp = train->adapterFor(*railway);
-        if (!adp)continue;
-        foreach(auto line, adp->lines()) {
-            if (line->count() < 2)continue;
-            auto pr = line->stations().begin();
-            for (auto p = std::next(pr); p != line->stations().end(); pr = p, ++p) {
-                if (pr->railStation.lock()->dirAdjacent(line->dir()) ==
-                    p->railStation.lock()) {
+    auto samples = rulerSamplesFromTrains(railway, intervals, trains);
+    return rulerFromSamples(intervals, samples, useAverage, defaultStart, defaultStop,
+        cutStd, cutSec, prec, cutCount);
+}
+
+ReadRulerSamples Diagram::rulerSamplesFromTrains(std::shared_ptr<Railway> railway,
+    const QVector<std::shared_ptr<RailInterval>>& intervals,
+    const QList<std::shared_ptr<Train>>& trains)
+{
+    const int nint = intervals.size();
+    std::unordered_map<const RailInterval*, int> intervalIndex;
+    intervalIndex.reserve(nint);
+    for (int i = 0; i < nint; i++) {
+        intervalIndex.emplace(intervals.at(i).get(), i);
+    }
+
+    // 每段线程私有的：按区间的数据，以及每个区间最后写入的车次下标（用于去重）
+    struct ChunkBuffer {
+        ReadRulerSamples samples;
+        std::vector<int> lastTrain;
+    };
+    const int ntrain = trains.size();
+    std::vector<ChunkBuffer> buffers(qeutil::parallelChunkCount(ntrain, 16));
+
+    qeutil::parallelForChunks(ntrain, [&](int chunk, int begin, int end) {
+        auto& buf = buffers[chunk];
+        buf.samples.resize(nint);
+        buf.lastTrain.assign(nint, -1);
+        for (int i = begin; i < end; i++) {
+            const auto& train = trains.at(i);
+            auto adp = train->adapterFor(*railway);
+            if (!adp)continue;
+            foreach(auto line, adp->lines()) {
+                if (line->count() < 2)continue;
+                auto pr = line->stations().begin();
+                for (auto p = std::next(pr); p != line->stations().end(); pr = p, ++p) {
+                    auto prst = pr->railStation.lock();
+                    if (prst->dirAdjacent(line->dir()) != p->railStation.lock())
+                        continue;
                     // pr->p是合法的区间
-                    auto it = pr->railStation.lock()->dirNextInterval(line->dir());
-                    if ((itr = res.find(it)) != res.end()) {
-                        //此区间是要计算的区间
-                        int secs = qeutil::secsTo(pr->trainStation->depart,
-                            p->trainStation->arrive);
-                        auto att = line->getIntervalAttachType(pr, p);
-                        itr->second.raw.emplace(train, std::make_pair(secs, att));
-                    }
+                    auto it = prst->dirNextInterval(line->dir());
+                    auto itr = intervalIndex.find(it.get());
+                    if (itr == intervalIndex.end() || buf.lastTrain[itr->second] == i)
+                        continue;    // 不是要计算的区间，或者本车次已有数据
+                    buf.lastTrain[itr->second] = i;
+                    int secs = qeutil::secsTo(pr->trainStation->depart,
+                        p->trainStation->arrive);
+                    buf.samples[itr->second].push_back(
+                        { train, secs, line->getIntervalAttachType(pr, p) });
                 }
             }
         }
+        }, 16);
+
+    ReadRulerSamples res(nint);
+    for (int i = 0; i < nint; i++) {
+        size_t n = 0;
+        for (const auto& buf : buffers)
+            if (!buf.samples.empty()) n += buf.samples[i].size();
+        res[i].reserve(n);
+        for (auto& buf : buffers) {
+            if (buf.samples.empty())continue;
+            std::move(buf.samples[i].begin(), buf.samples[i].end(),
+                std::back_inserter(res[i]));
+        }
     }
+    return res;
+}
 
-    for (auto p = res.begin(); p != res.end(); ++p) {
-        __intervalFt(p->second);
+ReadRulerReport Diagram::rulerFromSamples(const QVector<std::shared_ptr<RailInterval>>& intervals,
+    const ReadRulerSamples& samples, bool useAverage, int defaultStart, int defaultStop,
+    int cutStd, int cutSec, int prec, int cutCount)
+{
+    ReadRulerReport res;
+    for (int i = 0; i < intervals.size(); i++) {
+        auto& itrep = res[intervals.at(i)];
+        itrep.raw = samples.at(i);
+        __intervalFt(itrep);
         if (useAverage) {
-            __intervalRulerMean(p->second, defaultStart, defaultStop, 
+            __intervalRulerMean(itrep, defaultStart, defaultStop, 
                 prec, cutStd, cutSec, cutCount);
         }
         else {
-            __intervalRulerMode(p->second, defaultStart, defaultStop, prec, cutCount);
+            __intervalRulerMode(itrep, defaultStart, defaultStop, prec, cutCount);
         }
     }
     return res;
@@ -811,6 +928,16 @@ QVector<int> Diagram::pageIndexWithRail(std::shared_ptr<const Railway> railway)c
 
 void Diagram::bindAllTrains()
 {
+    bindAllTrains(nullptr);
+}
+
+bool Diagram::bindAllTrains(const std::atomic_bool* cancel, const std::function<void(int, int)>& progress)
+{
+    QE_TRACE_SCOPE("Diagram::bindAllTrains");
+    constexpr int step = 64;
+    const int total = _trainCollection.trains().size();
+    int done = 0;
+    std::vector<std::shared_ptr<Train>> path_trains;
     foreach(auto t, _trainCollection.trains()) {
         if (t->paths().empty()) {
             foreach(auto p, railways()) {
@@ -818,9 +945,22 @@ void Diagram::bindAllTrains()
             }
         }
         else {
-            t->bindWithPath();
+            // 2026.10.19  按径路绑定的车次最后一起并行绑定（每条径路只解析一次）
+            path_trains.emplace_back(t);
+        }
+        if (++done % step == 0) {
+            if (cancel && cancel->load(std::memory_order_relaxed))
+                return false;
+            if (progress)
+                progress(done, total);
         }
     }
+    if (cancel && cancel->load(std::memory_order_relaxed))
+        return false;
+    TrainPathBinding::bindTrains(path_trains);
+    if (progress)
+        progress(total, total);
+    return true;
 }
 
 QString Diagram::validPageName(const QString& prefix) const
@@ -1047,58 +1187,82 @@ bool Diagram::fromTrc(QTextStream& fin)
 
 void Diagram::__intervalFt(readruler::IntervalReport& itrep)
 {
-    for (auto p = itrep.raw.begin(); p != itrep.raw.end(); ++p) {
-        itrep.types[p->second.second].count[p->second.first]++;
+    for (const auto& sample : itrep.raw) {
+        itrep.types[sample.type].secs.push_back(sample.secs);
+    }
+    for (auto& [tp, rep] : itrep.types) {
+        std::sort(rep.secs.begin(), rep.secs.end());
+        rep.first = 0;
+        rep.last = static_cast<int>(rep.secs.size());
     }
 }
 
 
 namespace readruler {
 
-    int typeCount(const IntervalTypeCount& cnt) 
+    RangeMoment::RangeMoment(const IntervalTypeReport& rep)
     {
-        return std::accumulate(cnt.begin(), cnt.end(), 0,
-            [](auto x, auto y) { return x + y.second; });
+        if (rep.first < rep.last)
+            base = rep.secs[rep.first];
+        for (int i = rep.first; i < rep.last; i++) {
+            add(rep.secs[i], 1);
+        }
     }
 
-    /**
-     * pyETRC.Graph.__intervalRulerMean.<lambda>moment()
-     * 计算样本均值和标准差  保证输入非空
-     */
-    std::pair<double, double> moment(const IntervalTypeCount& rep)
+    void RangeMoment::add(int x, int sign)
     {
-        if (rep.size() == 1) {
-            return std::make_pair(rep.begin()->first + 0.0, 0.0);
+        double d = x - base;
+        n += sign;
+        s1 += sign * d;
+        s2 += sign * d * d;
+    }
+
+    std::pair<double, double> RangeMoment::moment(const IntervalTypeReport& rep)const
+    {
+        if (rep.secs[rep.first] == rep.secs[rep.last - 1]) {
+            return std::make_pair(rep.secs[rep.first] + 0.0, 0.0);
         }
-        int n = typeCount(rep);
-        double ave = std::accumulate(rep.begin(), rep.end(), 0.0,
-            [](auto x, auto y) {return x + y.first * y.second; }) / n;
-        double s2 = std::accumulate(rep.begin(), rep.end(), 0.0,
-            [=](auto x, auto y) {return x + std::pow(y.first - ave, 2) * y.second; })
-            / (n - 1);
-        return std::make_pair(ave, std::sqrt(s2));
+        double ave = base + s1 / n;
+        // 偏差平方和 sum((x-ave)^2) = sum(d^2) - (sum d)^2/n
+        double ss = std::max(s2 - s1 * s1 / n, 0.0);
+        return std::make_pair(ave, std::sqrt(ss / (n - 1)));
     }
 
     /**
      * pyETRC.data.Graph.__intervalRulerMean.<lambda>furthest
-     * 返回离均值最远的那个数据的迭代器，实际上只能是首末之一。
-     * 保证rep的元素数量大于1.
+     * 离均值最远的那组数据，只能是首末之一。返回是否是首端。
+     * 保证数据中的不同数值多于一个。
      */
-    IntervalTypeCount::iterator furthest(IntervalTypeCount& rep, double ave)
+    bool furthestAtFront(const IntervalTypeReport& rep, double ave)
     {
-        return std::fabs(rep.begin()->first - ave) > std::fabs(rep.rbegin()->first - ave) ?
-            rep.begin() : std::prev(rep.end());
+        return std::fabs(rep.secs[rep.first] - ave) > std::fabs(rep.secs[rep.last - 1] - ave);
     }
 
-    using _valCompTy = const std::map<int, int>::value_type&;
-    bool valueCountComp(_valCompTy x, _valCompTy y) {
-        if (x.second == y.second) {
-            return x.first > y.first;
+    /**
+     * 删除首端或末端数值相同的一整组数据（与原来删除map的一项一致）
+     */
+    void cutFurthest(IntervalTypeReport& rep, RangeMoment& mom, bool front)
+    {
+        if (front) {
+            int v = rep.secs[rep.first];
+            while (rep.first < rep.last && rep.secs[rep.first] == v) {
+                mom.add(v, -1);
+                rep.first++;
+            }
         }
         else {
-            return x.second < y.second;
+            int v = rep.secs[rep.last - 1];
+            while (rep.last > rep.first && rep.secs[rep.last - 1] == v) {
+                mom.add(v, -1);
+                rep.last--;
+            }
         }
     }
+
+    bool hasMultipleValues(const IntervalTypeReport& rep)
+    {
+        return rep.secs[rep.first] != rep.secs[rep.last - 1];
+    }
 }
 
 void Diagram::__intervalRulerMode(readruler::IntervalReport& itrep,
@@ -1106,13 +1270,22 @@ void Diagram::__intervalRulerMode(readruler::IntervalReport& itrep,
 {
     std::map<TrainLine::IntervalAttachType, double> modes;
     for (auto tp = itrep.types.begin(); tp != itrep.types.end(); ++tp) {
-        auto& tpcnt = tp->second.count;
-        // 所选的数据迭代器  一定存在
-        auto sel = std::max_element(tpcnt.begin(), tpcnt.end(), readruler::valueCountComp);
-        tp->second.value = sel->first;
-        tp->second.tot = sel->second;     //众数模式下的数据量就是最大的那个数据的数据量
-        if (sel->second >= cutCount) {
-            modes.emplace(tp->first, sel->first);
+        const auto& secs = tp->second.secs;
+        // 有序数组上按游程计数；并列时取数值较小（最快）的那个，即第一个达到最大数量的
+        int selValue = secs.front(), selCount = 0;
+        for (auto p = secs.begin(); p != secs.end();) {
+            auto q = std::upper_bound(p, secs.end(), *p);
+            int cnt = static_cast<int>(q - p);
+            if (cnt > selCount) {
+                selValue = *p;
+                selCount = cnt;
+            }
+            p = q;
+        }
+        tp->second.value = selValue;
+        tp->second.tot = selCount;     //众数模式下的数据量就是最大的那个数据的数据量
+        if (selCount >= cutCount) {
+            modes.emplace(tp->first, selValue);
             tp->second.used = true;
         }
         else {
@@ -1161,29 +1334,32 @@ void Diagram::__intervalRulerMean(readruler::IntervalReport& itrep,
     std::map<TrainLine::IntervalAttachType, double> means;   //每种情况的采信数据 
     for (auto tp = itrep.types.begin(); tp != itrep.types.end(); ++tp) {
         // 注意：IntervalTypeReport是天然按照数值排列的
-        auto& tpcnt = tp->second.count;
+        auto& rep = tp->second;
+        readruler::RangeMoment mom(rep);
         if (cutSec) {
-            while (tpcnt.size() > 1) {
-                auto [ave, sigma] = readruler::moment(tpcnt);
-                auto f = readruler::furthest(tpcnt, ave);
-                if (std::abs(f->first - ave) > cutSec) {
-                    tpcnt.erase(f);
+            while (readruler::hasMultipleValues(rep)) {
+                auto [ave, sigma] = mom.moment(rep);
+                bool front = readruler::furthestAtFront(rep, ave);
+                double f = front ? rep.secs[rep.first] : rep.secs[rep.last - 1];
+                if (std::abs(f - ave) > cutSec) {
+                    readruler::cutFurthest(rep, mom, front);
                 }
                 else break;
             }
         }
         else if (cutStd) {
-            while (tpcnt.size() > 1) {
-                auto [ave, sigma] = readruler::moment(tpcnt);
-                auto f = readruler::furthest(tpcnt, ave);
-                if (sigma && std::fabs(f->first - ave) / sigma > cutStd) {
-                    tpcnt.erase(f);
+            while (readruler::hasMultipleValues(rep)) {
+                auto [ave, sigma] = mom.moment(rep);
+                bool front = readruler::furthestAtFront(rep, ave);
+                double f = front ? rep.secs[rep.first] : rep.secs[rep.last - 1];
+                if (sigma && std::fabs(f - ave) / sigma > cutStd) {
+                    readruler::cutFurthest(rep, mom, front);
                 }
                 else break;
             }
         }
-        tp->second.tot = readruler::typeCount(tpcnt);
-        double ave = readruler::moment(tpcnt).first;
+        tp->second.tot = rep.last - rep.first;
+        double ave = mom.moment(rep).first;
         tp->second.value = ave;
         
         //检查各类的最终数据量是否符合要求
@@ -1305,11 +1481,16 @@ std::shared_ptr<const RailStationEvent> Diagram::findLastEvent(
     return nullptr;
 }
 
+bool readruler::IntervalTypeReport::isCut(int sec)const
+{
+    return first >= last || sec < secs[first] || sec > secs[last - 1];
+}
+
 int readruler::IntervalReport::satisfiedCount()const
 {
     int cnt = 0;
-    for (auto p=raw.begin();p!=raw.end();++p) {
-        if (p->second.first == stdInterval(p->second.second))
+    for (const auto& sample : raw) {
+        if (sample.secs == stdInterval(sample.type))
             cnt++;
     }
     return cnt;
@@ -1363,6 +1544,10 @@ bool Diagram::readDefaultConfigs(const QString& filename)
 
 bool Diagram::fromJson(const QString& filename)
 {
+    QE_TRACE_SCOPE("Diagram::fromJson(file)");
+    // 2026.10.19: 二进制格式按magic识别，与后缀名无关
+    if (qebin::isBinaryFile(filename))
+        return fromBinary(filename);
     QFile f(filename);
     f.open(QFile::ReadOnly);
     if (!f.isOpen()) {
@@ -1386,14 +1571,39 @@ bool Diagram::fromJson(const QString& filename)
     return flag;
 }
 
+bool Diagram::fromBinary(const QString& filename)
+{
+    qebin::DiagramReader reader;
+    if (!reader.open(filename))
+        return false;
+    const QJsonObject& obj = reader.readAll();
+    if (obj.isEmpty())   // 数据损坏，不读入部分数据
+        return false;
+    bool flag = fromJson(obj);
+    if (flag)
+        _filename = filename;
+    return flag;
+}
+
 bool Diagram::fromJson(const QJsonObject& obj)
 {
+    if (!fromJsonUnbound(obj))
+        return false;
+    bindAllTrains();
+    return true;
+}
+
+bool Diagram::fromJsonUnbound(const QJsonObject& obj)
+{
+    QE_TRACE_SCOPE("Diagram::fromJsonUnbound");
     if (obj.empty())
         return false;
     railways().clear();
 
     //车次和Config直接转发即可
     _trainCollection.fromJson(obj, _defaultManager);
+    if (_railPool)
+        _railPool->internNames(_trainCollection);
     bool flag = _config.fromJson(obj.value("config").toObject(), false);
     if (!flag) {
         //缺配置信息，使用默认值
@@ -1403,22 +1613,30 @@ bool Diagram::fromJson(const QJsonObject& obj)
     _version = obj.value("qetrc_version").toString();
     _releaseCode = obj.value("qetrc_release").toInt(qespec::RELEASE_CODE);
 
+    //特殊：旧版排图标尺 （优先级低于rail中的）
+    const auto& t = obj.value("config").toObject().value("ordinate");
+    const bool oldOrdinate = t.isString() && !t.toString().isEmpty();
+
+    // 2026.10.19: 设置了RailwayPool的，内容相同的线路共享同一对象。
+    // 旧版排图标尺要修改第一条线路，不能共享
+    auto makeRailway = [this](const QJsonObject& robj, bool shareable) {
+        if (_railPool && shareable)
+            return _railPool->railway(robj);
+        auto rail = std::make_shared<Railway>();
+        rail->fromJson(robj);
+        return rail;
+    };
+
     //线路  line作为第一个，lines作为其他，不存在就是空
-    auto rail0 = std::make_shared<Railway>();
-    rail0->fromJson(obj.value("line").toObject());
-    railways().append(rail0);
+    railways().append(makeRailway(obj.value("line").toObject(), !oldOrdinate));
 
     //其他线路
     const QJsonArray& arrail = obj.value("lines").toArray();
     for (const auto& r : arrail) {
-        auto tt = std::make_shared<Railway>();
-        tt->fromJson(r.toObject());
-        railways().append(tt);
+        railways().append(makeRailway(r.toObject(), true));
     }
 
-    //特殊：旧版排图标尺 （优先级低于rail中的）
-    const auto& t = obj.value("config").toObject().value("ordinate");
-    if (t.isString() && !t.toString().isEmpty()) {
+    if (oldOrdinate) {
         railways().at(0)->setOrdinate(t.toString());
         railways().at(0)->calStationYCoeff();
     }
@@ -1432,8 +1650,6 @@ bool Diagram::fromJson(const QJsonObject& obj)
     // 2023.08.12  paths
     const QJsonArray& arpath = obj.value("paths").toArray();
     _pathcoll.fromJson(arpath, _railcat, _trainCollection);
-
-    bindAllTrains();
     return true;
 }
 
@@ -1597,22 +1813,42 @@ bool Diagram::saveAs(const QString& filename)
 
 bool Diagram::save() const
 {
-    QFile file(_filename);
-    file.open(QFile::WriteOnly);
-    if (!file.isOpen()) {
-        qDebug() << "Diagram::save: WARNING: open file " << _filename << " failed. Nothing todo."
-            << Qt::endl;
-        return false;
-    }
-    QJsonDocument doc(toJson());
-    file.write(doc.toJson(QJsonDocument::Compact));
-    file.close();
-    return true;
+    return writeSnapshot(saveSnapshot()) >= 0;
+}
+
+Diagram::SaveSnapshot Diagram::saveSnapshot(const QString& filename) const
+{
+    QE_TRACE_SCOPE("Diagram::saveSnapshot");
+    SaveSnapshot snap{ filename.isEmpty() ? _filename : filename, toJson(), {} };
+    if (snap.filename.endsWith(qebin::fileSuffix, Qt::CaseInsensitive))
+        snap.trainRails = qebin::trainRailIndexes(*this);
+    return snap;
+}
+
+qint64 Diagram::writeSnapshot(const SaveSnapshot& snap, QString* errorString)
+{
+    QE_TRACE_SCOPE("Diagram::writeSnapshot");
+    QByteArray contents;
+    if (snap.filename.endsWith(qebin::fileSuffix, Qt::CaseInsensitive))
+        contents = qebin::encodeDiagram(snap.data, snap.trainRails);
+    else
+        contents = QJsonDocument(snap.data).toJson(QJsonDocument::Compact);
+
+    QSaveFile file(snap.filename);
+    if (!file.open(QFile::WriteOnly) || file.write(contents) != contents.size() || !file.commit()) {
+        qDebug() << "Diagram::writeSnapshot: WARNING: write file " << snap.filename << " failed: "
+            << file.errorString() << Qt::endl;
+        if (errorString)
+            *errorString = file.errorString();
+        return -1;
+    }
+    return contents.size();
 }
 
 void Diagram::clear()
 {
     _pages.clear();
+    _eventCache.clear();
     _trainCollection.clear(_defaultManager);
     railways().clear();
     pathCollection().clear();
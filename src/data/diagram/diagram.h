@@ -3,35 +3,82 @@
 #include <memory>
 #include <QList>
 #include <QString>
+#include <QJsonObject>
+#include <vector>
+#include <atomic>
+#include <functional>
 #include "config.h"
 #include "data/train/traincollection.h"
 #include "data/diagram/trainline.h"    // for: alias
 #include "data/rail/railcategory.h"
 #include "data/calculation/railwaystationeventaxis.h"
 #include "data/trainpath/trainpathcollection.h"
+#include "data/diagram/traineventcache.h"
 
 
 class Train;
 class Railway;
 struct TrainGap;
+struct DiagramDirty;
 class TrainFilterCore;
 class ITrainFilter;
 
 
 class DiagramPage;
+class RailwayPool;
 namespace readruler {
+
+    /**
+     * 2026.10.19  单个车次在某区间的一条运行数据（秒数、附加情况）
+     */
+    struct IntervalSample {
+        std::shared_ptr<Train> train;
+        int secs;
+        TrainLine::IntervalAttachType type;
+    };
+
     /**
-     * 每个区间的每一种（四种附加情况）数据的描述：
-     * 数据数值 -> 数据量
+     * 每个区间的全部运行数据，按列车输入顺序排列；每个车次至多一条。
      */
-    using IntervalTypeCount =
-        std::map<int, int>;
+    using IntervalSamples = std::vector<IntervalSample>;
 
+    /**
+     * 每个区间的每一种（四种附加情况）数据的描述。
+     * 2026.10.19: 由 数值->数据量 的map改为有序的连续数组，
+     * 截断操作只移动[first, last)的边界，不删除数据。
+     */
     struct IntervalTypeReport {
-        IntervalTypeCount count;  
-        int tot;        // 最终的总数据量
-        bool used;      // 是否使用本类数据
-        double value;   // 本类计算结果
+        std::vector<int> secs;   // 本类所有数据，升序
+        int first = 0, last = 0;   // 截断后保留的数据范围 [first, last)
+        int tot = 0;        // 最终的总数据量
+        bool used = false;      // 是否使用本类数据
+        double value = 0;   // 本类计算结果
+
+        /**
+         * 所给数据是否被截断（均值模式）。截断总是从两端删除整组相同的数值，
+         * 因此保留的数据是一个连续的数值范围。
+         */
+        bool isCut(int sec)const;
+    };
+
+    /**
+     * 2026.10.19  有序数据[first, last)的累加和与平方和，用于截断过程中的增量计算。
+     * 以构造时的首个数值为基准平移后按double累加：整数秒数的偏差和与偏差平方和
+     * 在2^53以内是精确的，不会像n*sum(x^2)那样在大样本下溢出。
+     */
+    struct RangeMoment {
+        int n = 0;
+        double base = 0, s1 = 0, s2 = 0;
+
+        RangeMoment(const IntervalTypeReport& rep);
+
+        void add(int x, int sign);
+
+        /**
+         * pyETRC.Graph.__intervalRulerMean.<lambda>moment()
+         * 计算样本均值和（无偏）标准差  保证输入非空
+         */
+        std::pair<double, double> moment(const IntervalTypeReport& rep)const;
     };
 
     /**
@@ -41,7 +88,7 @@ namespace readruler {
      */
     struct IntervalReport {
         int interval = 0, start = 0, stop = 0;
-        std::map<std::shared_ptr<Train>, std::pair<int, TrainLine::IntervalAttachType>> raw;
+        IntervalSamples raw;
         std::map<TrainLine::IntervalAttachType, IntervalTypeReport> types;
         bool isValid()const { return interval || start || stop; }
 
@@ -54,6 +101,12 @@ namespace readruler {
     };
 }
 
+/**
+ * 2026.10.19  标尺综合的原始数据，与区间列表按下标一一对应。
+ * 采集一次之后，修改截断参数只需重新统计。
+ */
+using ReadRulerSamples = std::vector<readruler::IntervalSamples>;
+
 using ReadRulerReport = std::map<std::shared_ptr<RailInterval>, readruler::IntervalReport>;
 
 
@@ -77,6 +130,16 @@ class Diagram
     QList<std::shared_ptr<DiagramPage>> _pages;
     TrainPathCollection _pathcoll;
 
+    /**
+     * 2026.10.19  运行线事件表缓存，见listTrainEvents()
+     */
+    mutable TrainEventCache _eventCache;
+
+    /**
+     * 2026.10.19  读图时共享线路和名称的池，见setRailwayPool()
+     */
+    RailwayPool* _railPool = nullptr;
+
 public:
     Diagram() = default;
 
@@ -113,13 +176,40 @@ public:
      */
     bool fromJson(const QString& filename);
 
-    
+    /**
+     * 2026.10.19  读取二进制格式（*.pyetgrb），同时保存文件名。
+     * 一般不直接调用：fromJson(filename)会按文件头自动识别。
+     * 任何数据段损坏时返回false，不读入部分数据。
+     */
+    bool fromBinary(const QString& filename);
 
     /**
      * @brief fromJson  读入数据后绑定车次和线路
      * 返回是否成功 （如果为空则失败）
      */
     bool fromJson(const QJsonObject& obj);
+
+    /**
+     * 2026.10.19  同fromJson(obj)，但不绑定车次。
+     * 用于异步打开时分阶段执行；之后须调用bindAllTrains(cancel, progress)。
+     */
+    bool fromJsonUnbound(const QJsonObject& obj);
+
+    /**
+     * 2026.10.19  设置之后读图（fromJson系列）时，内容相同的线路从pool中取得共享的对象，
+     * 车次名、站名等字符串也在pool中去重。用于DiagramWorkspace中的只读运行图；
+     * 共享的线路不可修改，因此要编辑的运行图（主窗口）不应设置。pool须比本对象活得久。
+     */
+    void setRailwayPool(RailwayPool* pool) { _railPool = pool; }
+
+    /**
+     * 2026.10.19  绑定全部车次，可以在工作线程中对尚未交给界面的Diagram调用。
+     * cancel非空且被置位时提前返回false，此时绑定不完整，对象应当丢弃。
+     * progress(done, total)每绑定若干车次调用一次（在调用线程中）。
+     */
+    bool bindAllTrains(const std::atomic_bool* cancel,
+        const std::function<void(int, int)>& progress = {});
+
     QJsonObject toJson()const;
 
     /**
@@ -147,9 +237,37 @@ public:
 
     /**
      * 保存 （使用当前文件名）
+     * 2026.10.19: 后缀名为qebin::fileSuffix时保存为二进制格式；
+     * 现在等价于writeSnapshot(saveSnapshot())，写入过程是原子的。
      */
     bool save()const;
 
+    /**
+     * 2026.10.19  保存用的快照。
+     * data是toJson()的结果（隐式共享、不再被Diagram修改），
+     * 因此快照生成后可以交给工作线程完成序列化和写文件，期间GUI线程可以继续编辑。
+     */
+    struct SaveSnapshot {
+        QString filename;
+        QJsonObject data;
+        std::vector<std::vector<int>> trainRails;   // 仅二进制格式使用，见qebin::trainRailIndexes
+    };
+
+    /**
+     * 生成保存快照。须在GUI线程调用。
+     * filename为写入的文件名，空则为当前文件名；不改变当前文件名。
+     * 快照仍需完整调用一次toJson()，用时与运行图规模成正比；只有序列化和写文件移出了GUI线程。
+     */
+    SaveSnapshot saveSnapshot(const QString& filename = {})const;
+
+    /**
+     * 2026.10.19  序列化快照并写入snap.filename。不访问任何Diagram对象，可在任意线程调用。
+     * 先写入同目录的临时文件，刷新到磁盘（fsync）后再替换目标文件（QSaveFile），
+     * 中途失败或程序崩溃时原文件不受影响。
+     * @return  写入的字节数，失败返回-1，错误信息写入errorString（若非空）
+     */
+    static qint64 writeSnapshot(const SaveSnapshot& snap, QString* errorString = nullptr);
+
     /**
      * 打开新运行图或者新建等操作调用
      * 清理所有数据
@@ -214,6 +332,13 @@ public:
      */
     void updateTrain(std::shared_ptr<Train> t);
 
+    /**
+     * 2026.10.19  增量刷新：只检查、重新绑定dirty涉及的径路和车次（见DiagramDirty）。
+     * dirty.trains扩展为全部受影响的车次；重新绑定的径路车次及其原有Adapter写入dirty.replaced。
+     * 不负责重绘。
+     */
+    void refreshDirty(DiagramDirty& dirty);
+
     auto& trains() { return _trainCollection.trains(); }
 
     /**
@@ -227,6 +352,7 @@ public:
      *    则第一站只列出出发时刻数据。
      * 4. 任何区间和停站时长都小于12小时。否则会干扰时刻前后判断。
      *    时刻前后的判断不依赖于前后文，只考虑当前：PBC下使得差值绝对值较小的理解。
+     * 2026.10.19: 各运行线的结果经_eventCache缓存，只有本线或相交运行线变化后才重新计算。
      */
     TrainEventList listTrainEvents(const Train& train)const;
 
@@ -421,6 +547,7 @@ public:
     /**
      * @brief rulerFromMultiTrains  pyETRC.graph.rulerFromMultiTrains() 标尺综合
      * 参数、返回值、算法、函数名等基本照搬pyETRC。
+     * 2026.10.19: 拆分为数据采集 rulerSamplesFromTrains() 和统计 rulerFromSamples() 两步。
      * @param railway  qETRC新增  要读取的线路
      * @param intervals  要计算的区间
      * @param trains  用来计算的列车
@@ -442,6 +569,27 @@ public:
             int cutCount=1
             );
 
+    /**
+     * 2026.10.19  标尺综合的数据采集部分。
+     * 按列车分段并行地读取各区间的运行秒数和附加情况，返回值与intervals下标对应。
+     * 每段线程只写入私有的缓存，最后按列车顺序合并，结果与串行版本一致。
+     */
+    static ReadRulerSamples rulerSamplesFromTrains(
+        std::shared_ptr<Railway> railway,
+        const QVector<std::shared_ptr<RailInterval>>& intervals,
+        const QList<std::shared_ptr<Train>>& trains);
+
+    /**
+     * 2026.10.19  标尺综合的统计部分，参数意义同rulerFromMultiTrains()。
+     * 只做排序和统计，代价很小，可以在参数变化时反复调用。
+     */
+    ReadRulerReport rulerFromSamples(
+        const QVector<std::shared_ptr<RailInterval>>& intervals,
+        const ReadRulerSamples& samples,
+        bool useAverage, int defaultStart, int defaultStop,
+        int cutStd = 1, int cutSec = 10, int prec = 1,
+        int cutCount = 1);
+
     /**
      * 返回包含所给线路的Page的下标集合。
      */
@@ -459,6 +607,7 @@ private:
     /**
      * pyETRC.data.Graph.__intervalFt()  区间数据统计
      * 对四种起停附加情况，统计频数
+     * 2026.10.19: 改为按附加情况分组并排序。
      */
     void __intervalFt(readruler::IntervalReport& itrep);
 
@@ -0,0 +1,545 @@
+#include "diagrambinary.h"
+#include "diagram.h"
+#include "trainadapter.h"
+#include "data/rail/railway.h"
+#include "data/train/train.h"
+
+#include <QJsonArray>
+#include <QDebug>
+#include <QSaveFile>
+#include <QtEndian>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+const QString qebin::fileSuffix = ".pyetgrb";
+
+namespace qebin {
+
+    namespace {
+
+        enum Tag : quint8 {
+            TagNull = 0,
+            TagFalse,
+            TagTrue,
+            TagInt,
+            TagDouble,
+            TagString,
+            TagArray,
+            TagObject,
+        };
+
+        constexpr int HEADER_SIZE = 16;        // magic + version + 目录项数
+        constexpr int ENTRY_SIZE = 28;         // kind, index, nameId, offset, size
+        constexpr int MAX_DEPTH = 256;
+
+        class ByteWriter {
+        public:
+            QByteArray buf;
+
+            void u8(quint8 v) { buf.append(static_cast<char>(v)); }
+
+            void varint(quint64 v)
+            {
+                while (v >= 0x80) {
+                    buf.append(static_cast<char>((v & 0x7f) | 0x80));
+                    v >>= 7;
+                }
+                buf.append(static_cast<char>(v));
+            }
+
+            // zigzag
+            void svarint(qint64 v)
+            {
+                varint((static_cast<quint64>(v) << 1) ^ static_cast<quint64>(v >> 63));
+            }
+
+            template <typename T>
+            void fixed(T v)
+            {
+                v = qToLittleEndian(v);
+                buf.append(reinterpret_cast<const char*>(&v), sizeof(T));
+            }
+
+            void f64(double d)
+            {
+                quint64 bits;
+                std::memcpy(&bits, &d, sizeof(bits));
+                fixed(bits);
+            }
+
+            void bytes(const QByteArray& b)
+            {
+                varint(b.size());
+                buf.append(b);
+            }
+        };
+
+        class ByteReader {
+            const char* p;
+            const char* end;
+        public:
+            bool ok = true;
+
+            ByteReader(const char* begin, quint64 size) : p(begin), end(begin + size) {}
+
+            bool atEnd()const { return p >= end; }
+
+            quint8 u8()
+            {
+                if (p >= end) { ok = false; return 0; }
+                return static_cast<quint8>(*p++);
+            }
+
+            quint64 varint()
+            {
+                quint64 res = 0;
+                for (int shift = 0; shift < 64; shift += 7) {
+                    quint8 b = u8();
+                    if (!ok) return 0;
+                    res |= static_cast<quint64>(b & 0x7f) << shift;
+                    if (!(b & 0x80))
+                        return res;
+                }
+                ok = false;
+                return 0;
+            }
+
+            qint64 svarint()
+            {
+                quint64 v = varint();
+                return static_cast<qint64>(v >> 1) ^ -static_cast<qint64>(v & 1);
+            }
+
+            template <typename T>
+            T fixed()
+            {
+                if (end - p < static_cast<qint64>(sizeof(T))) { ok = false; return T{}; }
+                T v;
+                std::memcpy(&v, p, sizeof(T));
+                p += sizeof(T);
+                return qFromLittleEndian(v);
+            }
+
+            double f64()
+            {
+                quint64 bits = fixed<quint64>();
+                double d;
+                std::memcpy(&d, &bits, sizeof(d));
+                return d;
+            }
+
+            const char* take(quint64 n)
+            {
+                if (static_cast<quint64>(end - p) < n) { ok = false; return nullptr; }
+                const char* res = p;
+                p += n;
+                return res;
+            }
+        };
+
+        class StringTable {
+            QHash<QString, int> ids;
+        public:
+            QStringList list;
+
+            int id(const QString& s)
+            {
+                auto p = ids.find(s);
+                if (p != ids.end())
+                    return p.value();
+                int i = list.size();
+                ids.insert(s, i);
+                list.append(s);
+                return i;
+            }
+        };
+
+        void encodeValue(const QJsonValue& v, ByteWriter& w, StringTable& tab)
+        {
+            switch (v.type()) {
+            case QJsonValue::Bool: w.u8(v.toBool() ? TagTrue : TagFalse); break;
+            case QJsonValue::Double: {
+                double d = v.toDouble();
+                // 整数值（保持-0.0的符号）采用变长整数，否则保存原始的double
+                if (std::floor(d) == d && std::fabs(d) < 9007199254740992.0 &&
+                    !(d == 0 && std::signbit(d))) {
+                    w.u8(TagInt);
+                    w.svarint(static_cast<qint64>(d));
+                }
+                else {
+                    w.u8(TagDouble);
+                    w.f64(d);
+                }
+                break;
+            }
+            case QJsonValue::String:
+                w.u8(TagString);
+                w.varint(tab.id(v.toString()));
+                break;
+            case QJsonValue::Array: {
+                const QJsonArray& ar = v.toArray();
+                w.u8(TagArray);
+                w.varint(ar.size());
+                for (const auto& t : ar)
+                    encodeValue(t, w, tab);
+                break;
+            }
+            case QJsonValue::Object: {
+                const QJsonObject& obj = v.toObject();
+                w.u8(TagObject);
+                w.varint(obj.size());
+                for (auto p = obj.begin(); p != obj.end(); ++p) {
+                    w.varint(tab.id(p.key()));
+                    encodeValue(p.value(), w, tab);
+                }
+                break;
+            }
+            default: w.u8(TagNull); break;
+            }
+        }
+
+        QJsonValue decodeValue(ByteReader& r, const QStringList& strings, int depth = 0)
+        {
+            if (depth > MAX_DEPTH) {
+                r.ok = false;
+                return {};
+            }
+            auto string = [&]() -> QString {
+                quint64 id = r.varint();
+                if (id >= static_cast<quint64>(strings.size())) {
+                    r.ok = false;
+                    return {};
+                }
+                return strings.at(static_cast<int>(id));
+            };
+            switch (r.u8()) {
+            case TagNull: return QJsonValue(QJsonValue::Null);
+            case TagFalse: return false;
+            case TagTrue: return true;
+            case TagInt: return static_cast<qint64>(r.svarint());
+            case TagDouble: return r.f64();
+            case TagString: return string();
+            case TagArray: {
+                QJsonArray ar;
+                quint64 n = r.varint();
+                for (quint64 i = 0; i < n && r.ok; i++)
+                    ar.append(decodeValue(r, strings, depth + 1));
+                return ar;
+            }
+            case TagObject: {
+                QJsonObject obj;
+                quint64 n = r.varint();
+                for (quint64 i = 0; i < n && r.ok; i++) {
+                    QString key = string();
+                    obj.insert(key, decodeValue(r, strings, depth + 1));
+                }
+                return obj;
+            }
+            default:
+                r.ok = false;
+                return {};
+            }
+        }
+
+        struct PendingSection {
+            SectionKind kind;
+            int index = -1;
+            int nameId = -1;
+            QByteArray payload;
+        };
+
+        /**
+         * JSON顶层key与数组段的对应关系（不含线路、元数据）
+         */
+        const std::vector<std::pair<SectionKind, QString>>& arraySectionKeys()
+        {
+            static const std::vector<std::pair<SectionKind, QString>> keys{
+                {SectionKind::Trains, QStringLiteral("trains")},
+                {SectionKind::Routings, QStringLiteral("circuits")},
+                {SectionKind::Filters, QStringLiteral("filters")},
+                {SectionKind::Paths, QStringLiteral("paths")},
+                {SectionKind::Pages, QStringLiteral("pages")},
+            };
+            return keys;
+        }
+    }
+
+    bool isBinaryFile(const QString& filename)
+    {
+        QFile f(filename);
+        if (!f.open(QFile::ReadOnly))
+            return false;
+        QByteArray head = f.read(sizeof(MAGIC));
+        return head.size() == sizeof(MAGIC) && std::memcmp(head.constData(), MAGIC, sizeof(MAGIC)) == 0;
+    }
+
+    std::vector<std::vector<int>> trainRailIndexes(const Diagram& diagram)
+    {
+        std::unordered_map<const Railway*, int> railIndex;
+        for (int i = 0; i < diagram.railways().size(); i++)
+            railIndex.emplace(diagram.railways().at(i).get(), i);
+        const auto& trains = diagram.trainCollection().trains();
+        std::vector<std::vector<int>> res(trains.size());
+        for (int i = 0; i < trains.size(); i++) {
+            for (const auto& adp : trains.at(i)->adapters()) {
+                auto rail = adp->railway();
+                if (auto p = railIndex.find(rail.get()); p != railIndex.end())
+                    res[i].push_back(p->second);
+            }
+        }
+        return res;
+    }
+
+    QByteArray encodeDiagram(QJsonObject obj, const std::vector<std::vector<int>>& trainRails)
+    {
+        StringTable tab;
+        std::vector<PendingSection> pending;
+
+        // 线路：0号为"line"，其余为"lines"
+        QJsonArray rails;
+        if (obj.contains("line"))
+            rails.append(obj.take("line"));
+        for (const auto& r : obj.take("lines").toArray())
+            rails.append(r);
+        for (int i = 0; i < rails.size(); i++) {
+            ByteWriter w;
+            encodeValue(rails.at(i), w, tab);
+            pending.push_back({ SectionKind::Railway, i,
+                tab.id(rails.at(i).toObject().value("name").toString()), std::move(w.buf) });
+        }
+
+        // 列车：每个车次附带当前绑定的线路下标
+        QJsonArray artrains = obj.take("trains").toArray();
+        {
+            ByteWriter w;
+            w.varint(artrains.size());
+            for (int i = 0; i < artrains.size(); i++) {
+                static const std::vector<int> none;
+                const auto& bound = i < static_cast<int>(trainRails.size()) ? trainRails.at(i) : none;
+                w.varint(bound.size());
+                for (int r : bound) w.varint(r);
+                ByteWriter tw;
+                encodeValue(artrains.at(i), tw, tab);
+                w.bytes(tw.buf);
+            }
+            pending.push_back({ SectionKind::Trains, -1, -1, std::move(w.buf) });
+        }
+
+        for (const auto& [kind, key] : arraySectionKeys()) {
+            if (kind == SectionKind::Trains || !obj.contains(key))
+                continue;
+            ByteWriter w;
+            encodeValue(obj.take(key), w, tab);
+            pending.push_back({ kind, -1, -1, std::move(w.buf) });
+        }
+
+        // 剩下的都是元数据
+        {
+            ByteWriter w;
+            encodeValue(obj, w, tab);
+            pending.push_back({ SectionKind::Meta, -1, -1, std::move(w.buf) });
+        }
+
+        // 字符串表最后生成，但放在最前面
+        {
+            ByteWriter w;
+            w.varint(tab.list.size());
+            for (const auto& s : tab.list)
+                w.bytes(s.toUtf8());
+            pending.insert(pending.begin(), { SectionKind::StringTable, -1, -1, std::move(w.buf) });
+        }
+
+        ByteWriter head;
+        head.buf.append(MAGIC, sizeof(MAGIC));
+        head.fixed<quint32>(FORMAT_VERSION);
+        head.fixed<quint32>(static_cast<quint32>(pending.size()));
+        quint64 offset = HEADER_SIZE + ENTRY_SIZE * pending.size();
+        for (const auto& sec : pending) {
+            head.fixed<quint32>(static_cast<quint32>(sec.kind));
+            head.fixed<qint32>(sec.index);
+            head.fixed<qint32>(sec.nameId);
+            head.fixed<quint64>(offset);
+            head.fixed<quint64>(sec.payload.size());
+            offset += sec.payload.size();
+        }
+
+        QByteArray res = std::move(head.buf);
+        res.reserve(static_cast<int>(offset));
+        for (const auto& sec : pending)
+            res.append(sec.payload);
+        return res;
+    }
+
+    bool writeDiagram(const Diagram& diagram, const QString& filename)
+    {
+        const QByteArray contents = encodeDiagram(diagram.toJson(), trainRailIndexes(diagram));
+        // 与Diagram::writeSnapshot()相同，写完整之后才替换原文件
+        QSaveFile file(filename);
+        if (!file.open(QFile::WriteOnly) || file.write(contents) != contents.size() || !file.commit()) {
+            qDebug() << "qebin::writeDiagram: WARNING: write file " << filename << " failed: "
+                << file.errorString() << Qt::endl;
+            return false;
+        }
+        return true;
+    }
+
+    DiagramReader::~DiagramReader()
+    {
+        file.close();   // 同时解除映射
+    }
+
+    bool DiagramReader::open(const QString& filename)
+    {
+        file.setFileName(filename);
+        if (!file.open(QFile::ReadOnly))
+            return fail(QObject::tr("无法打开文件"));
+        dataSize = file.size();
+        data = reinterpret_cast<const char*>(file.map(0, dataSize));
+        if (!data) {
+            buffer = file.readAll();
+            data = buffer.constData();
+            dataSize = buffer.size();
+        }
+
+        ByteReader r(data, dataSize);
+        const char* magic = r.take(sizeof(MAGIC));
+        if (!magic || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0)
+            return fail(QObject::tr("不是qETRC二进制运行图文件"));
+        quint32 version = r.fixed<quint32>();
+        if (version > FORMAT_VERSION)
+            return fail(QObject::tr("文件格式版本%1高于当前程序支持的版本%2").arg(version).arg(FORMAT_VERSION));
+        quint32 count = r.fixed<quint32>();
+        sections.clear();
+        for (quint32 i = 0; i < count && r.ok; i++) {
+            SectionEntry e;
+            e.kind = static_cast<SectionKind>(r.fixed<quint32>());
+            e.index = r.fixed<qint32>();
+            e.nameId = r.fixed<qint32>();
+            e.offset = r.fixed<quint64>();
+            e.size = r.fixed<quint64>();
+            if (e.offset > static_cast<quint64>(dataSize) || e.size > static_cast<quint64>(dataSize) - e.offset)
+                return fail(QObject::tr("文件目录损坏"));
+            sections.push_back(e);
+        }
+        if (!r.ok)
+            return fail(QObject::tr("文件头损坏"));
+
+        const auto* st = findSection(SectionKind::StringTable);
+        if (!st)
+            return fail(QObject::tr("缺少字符串表"));
+        ByteReader sr(data + st->offset, st->size);
+        quint64 n = sr.varint();
+        strings.clear();
+        strings.reserve(static_cast<int>(std::min<quint64>(n, st->size)));
+        for (quint64 i = 0; i < n && sr.ok; i++) {
+            quint64 len = sr.varint();
+            const char* s = sr.take(len);
+            if (s) strings.append(QString::fromUtf8(s, static_cast<int>(len)));
+        }
+        if (!sr.ok)
+            return fail(QObject::tr("字符串表损坏"));
+        return true;
+    }
+
+    QStringList DiagramReader::railwayNames() const
+    {
+        std::vector<std::pair<int, QString>> lst;
+        for (const auto& e : sections) {
+            if (e.kind == SectionKind::Railway)
+                lst.emplace_back(e.index, e.nameId >= 0 ? strings.value(e.nameId) : QString());
+        }
+        std::sort(lst.begin(), lst.end(), [](const auto& a, const auto& b) {return a.first < b.first; });
+        QStringList res;
+        for (const auto& p : lst) res.append(p.second);
+        return res;
+    }
+
+    QJsonObject DiagramReader::readAll()
+    {
+        _error.clear();
+        QJsonObject obj;
+        if (const auto* m = findSection(SectionKind::Meta))
+            obj = decodeSection(*m).toObject();
+
+        std::vector<const SectionEntry*> rails;
+        for (const auto& e : sections)
+            if (e.kind == SectionKind::Railway) rails.push_back(&e);
+        std::sort(rails.begin(), rails.end(), [](auto a, auto b) {return a->index < b->index; });
+        QJsonArray lines;
+        for (const auto* e : rails) {
+            if (e->index == 0) obj.insert("line", decodeSection(*e));
+            else lines.append(decodeSection(*e));
+        }
+        if (!lines.isEmpty())
+            obj.insert("lines", lines);
+
+        for (const auto& [kind, key] : arraySectionKeys()) {
+            const auto* e = findSection(kind);
+            if (!e) continue;
+            if (kind == SectionKind::Trains)
+                obj.insert(key, decodeTrains(*e));
+            else
+                obj.insert(key, decodeSection(*e));
+        }
+        // 任何一段损坏都视为读取失败，不返回部分数据
+        if (!_error.isEmpty())
+            return {};
+        return obj;
+    }
+
+    const SectionEntry* DiagramReader::findSection(SectionKind kind, int index) const
+    {
+        for (const auto& e : sections) {
+            if (e.kind == kind && (index == -1 || e.index == index))
+                return &e;
+        }
+        return nullptr;
+    }
+
+    QJsonValue DiagramReader::decodeSection(const SectionEntry& entry)
+    {
+        ByteReader r(data + entry.offset, entry.size);
+        auto v = decodeValue(r, strings);
+        if (!r.ok) {
+            fail(QObject::tr("数据段损坏（类型%1，下标%2）").arg(static_cast<int>(entry.kind)).arg(entry.index));
+            return {};
+        }
+        return v;
+    }
+
+    QJsonArray DiagramReader::decodeTrains(const SectionEntry& entry)
+    {
+        QJsonArray res;
+        ByteReader r(data + entry.offset, entry.size);
+        quint64 n = r.varint();
+        for (quint64 i = 0; i < n && r.ok; i++) {
+            // 绑定线路下标：目前读取时不使用，跳过
+            quint64 nrail = r.varint();
+            for (quint64 k = 0; k < nrail && r.ok; k++)
+                r.varint();
+            quint64 len = r.varint();
+            const char* p = r.take(len);
+            if (!p) break;
+            ByteReader tr(p, len);
+            auto v = decodeValue(tr, strings);
+            if (!tr.ok) {
+                fail(QObject::tr("第%1个车次的数据损坏").arg(i + 1));
+                return {};
+            }
+            res.append(v);
+        }
+        if (!r.ok) {
+            fail(QObject::tr("列车数据段损坏"));
+            return {};
+        }
+        return res;
+    }
+
+    bool DiagramReader::fail(const QString& msg)
+    {
+        _error = msg;
+        qWarning() << "qebin::DiagramReader: " << file.fileName() << ": " << msg;
+        return false;
+    }
+}
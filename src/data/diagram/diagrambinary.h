@@ -0,0 +1,127 @@
+#pragma once
+
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QString>
+#include <QStringList>
+#include <vector>
+
+class Diagram;
+
+/**
+ * 2026.10.19  二进制运行图格式（*.pyetgrb）
+ * 内容与pyetgr（JSON）一一对应，可无损互转。
+ * 文件结构：
+ *   [文件头] magic(8) + 格式版本(u32) + 目录项数(u32)
+ *   [目录]   各段的类型、下标、名称（字符串表下标）、偏移、长度
+ *   [各段]   字符串表、元数据（config等）、每条线路一段、列车、交路、筛选器、径路、运行图页面
+ * JSON值采用紧凑的标签编码，所有字符串（含key）统一进入字符串表，按下标引用。
+ * 整数一律采用变长编码（LEB128）。
+ * 列车段中，每个车次记录有保存时绑定的线路下标。读取时目前总是解码全部数据
+ * （编辑器需要完整的运行图），这些下标保留在格式中，供以后按线路部分读取时使用。
+ */
+namespace qebin {
+
+    constexpr char MAGIC[8] = { 'Q','E','T','R','C','B','I','N' };
+    constexpr quint32 FORMAT_VERSION = 1;
+
+    /**
+     * 二进制文件的后缀名。保存时，按后缀名决定格式。
+     */
+    extern const QString fileSuffix;
+
+    enum class SectionKind : quint32 {
+        StringTable = 1,
+        Meta,       // 除下列各项之外的顶层数据
+        Railway,    // 每条线路一段，index为线路下标（0对应JSON中的"line"）
+        Trains,
+        Routings,   // "circuits"
+        Filters,
+        Paths,
+        Pages,
+    };
+
+    struct SectionEntry {
+        SectionKind kind;
+        int index;          // 仅对Railway有意义
+        int nameId;         // 字符串表下标，-1表示无。线路段为线路名
+        quint64 offset, size;
+    };
+
+    /**
+     * 文件是否是本格式（只检查magic）
+     */
+    bool isBinaryFile(const QString& filename);
+
+    /**
+     * 各车次当前绑定的线路下标，与trainCollection().trains()顺序一致。
+     * 须在GUI线程调用。
+     */
+    std::vector<std::vector<int>> trainRailIndexes(const Diagram& diagram);
+
+    /**
+     * 将Diagram::toJson()的结果编码为二进制文件内容。只访问参数，可在工作线程中调用。
+     * trainRails：见trainRailIndexes()
+     */
+    QByteArray encodeDiagram(QJsonObject obj, const std::vector<std::vector<int>>& trainRails);
+
+    /**
+     * 写入二进制文件（QSaveFile，写完整后才替换原文件）。失败返回false。
+     */
+    bool writeDiagram(const Diagram& diagram, const QString& filename);
+
+    /**
+     * 二进制文件读取器。open()只读取文件头、目录和字符串表（文件本身采用内存映射），
+     * 各段在readAll()时解码。
+     */
+    class DiagramReader
+    {
+        QFile file;
+        QByteArray buffer;      // 无法内存映射时的后备
+        const char* data = nullptr;
+        qint64 dataSize = 0;
+        std::vector<SectionEntry> sections;
+        QStringList strings;
+        QString _error;
+
+    public:
+        DiagramReader() = default;
+        DiagramReader(const DiagramReader&) = delete;
+        DiagramReader& operator=(const DiagramReader&) = delete;
+        ~DiagramReader();
+
+        bool open(const QString& filename);
+        const QString& errorString()const { return _error; }
+
+        const auto& sectionEntries()const { return sections; }
+
+        /**
+         * 线路名称，按线路下标排列
+         */
+        QStringList railwayNames()const;
+
+        /**
+         * 解码全部数据，结果与Diagram::toJson()一致。
+         * 任何一段（或一个车次记录）损坏时返回空对象，原因见errorString()。
+         */
+        QJsonObject readAll();
+
+    private:
+        const SectionEntry* findSection(SectionKind kind, int index = -1)const;
+        /**
+         * 解码失败时调用fail()记录原因
+         */
+        QJsonValue decodeSection(const SectionEntry& entry);
+
+        /**
+         * 解码列车段（跳过各车次记录前的线路下标）
+         */
+        QJsonArray decodeTrains(const SectionEntry& entry);
+
+        bool fail(const QString& msg);
+    };
+
+}
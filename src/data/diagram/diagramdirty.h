@@ -0,0 +1,43 @@
+#pragma once
+
+#include <QVector>
+#include <memory>
+#include <set>
+#include <utility>
+#include <vector>
+
+class Railway;
+class Train;
+class TrainPath;
+class TrainAdapter;
+
+/**
+ * 2026.10.19  一次编辑“弄脏”的线路、径路、车次，用于增量刷新（代替全量的refreshAll）。
+ * 由Diagram::refreshDirty()扩展并重新绑定，再由MainWindow::refreshDirty()重绘：
+ * 线路脏：经过该线路的径路重新检查，径路车次（TrainCollection::affectedTrainsByRailInPath）记为脏车次，
+ *   非径路车次与该线路重新绑定；包含该线路的页面整页重绘。
+ * 径路脏：径路上的车次记为脏车次。
+ * 车次脏：在其余页面上只重绘该车次的运行线。
+ */
+struct DiagramDirty {
+    std::set<std::shared_ptr<Railway>> railways;
+    std::set<TrainPath*> paths;
+    std::set<std::shared_ptr<Train>> trains;
+
+    /**
+     * 是否需要重新绑定。只影响显示的修改（例如全局站名修改）为false，此时只重绘。
+     */
+    bool rebind = true;
+
+    /**
+     * 是否重新绑定径路车次。已经由qecmd::RebindTrainsByPaths（可撤销）负责的场合为false。
+     */
+    bool rebindPathTrains = true;
+
+    /**
+     * 输出：重新绑定的径路车次及其原有的Adapter，用于从未整页重绘的页面上删除原有运行线。
+     */
+    std::vector<std::pair<std::shared_ptr<Train>, QVector<std::shared_ptr<TrainAdapter>>>> replaced;
+
+    bool empty()const { return railways.empty() && paths.empty() && trains.empty(); }
+};
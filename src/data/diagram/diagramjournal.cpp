@@ -0,0 +1,541 @@
+#include "diagramjournal.h"
+#include "diagram.h"
+#include "diagrambinary.h"
+#include "data/rail/railway.h"
+#include "data/train/train.h"
+#include "data/train/routing.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <algorithm>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+const QString DiagramJournal::baseIdKey = "journal_id";
+
+namespace {
+
+    /**
+     * 日志中三类对象在运行图JSON中的位置和名称
+     */
+    QString trainKey(const QJsonObject& t)
+    {
+        return t.value("checi").toArray().at(0).toString();
+    }
+
+    QString nameKey(const QJsonObject& t)
+    {
+        return t.value("name").toString();
+    }
+
+    /**
+     * hint：记录时对象的下标，通常就是其当前位置，先检查
+     */
+    int findByName(const QJsonArray& arr, QString(*key)(const QJsonObject&), const QString& name,
+        int hint = -1)
+    {
+        if (hint >= 0 && hint < arr.size() && key(arr.at(hint).toObject()) == name)
+            return hint;
+        for (int i = 0; i < arr.size(); i++) {
+            if (key(arr.at(i).toObject()) == name)
+                return i;
+        }
+        return -1;
+    }
+
+    void upsert(QJsonArray& arr, QString(*key)(const QJsonObject&), const QJsonObject& rec)
+    {
+        const QString& old = rec.value("old").toString(rec.value("name").toString());
+        int idx = findByName(arr, key, old, rec.value("index").toInt(-1));
+        if (idx >= 0) {
+            arr.replace(idx, rec.value("data"));
+        }
+        else {
+            int pos = std::clamp(rec.value("index").toInt(arr.size()), 0, static_cast<int>(arr.size()));
+            arr.insert(pos, rec.value("data"));
+        }
+    }
+
+    void removeByName(QJsonArray& arr, QString(*key)(const QJsonObject&), const QString& name)
+    {
+        if (int idx = findByName(arr, key, name); idx >= 0)
+            arr.removeAt(idx);
+    }
+
+    /**
+     * 回放中的运行图数据。车次、线路、交路三个数组单独保存，逐条记录原地修改，
+     * 只在需要完整数据时（commit、回放结束）组装，避免每条记录都复制整个数组。
+     */
+    struct ReplayData {
+        QJsonObject other;      // 以下三项之外的数据
+        QJsonArray trains, rails, routings;    // rails：line为第一条，lines为其余
+
+        void load(QJsonObject obj)
+        {
+            trains = obj.take("trains").toArray();
+            routings = obj.take("circuits").toArray();
+            rails = QJsonArray();
+            if (obj.contains("line"))
+                rails.append(obj.take("line"));
+            for (const auto& r : obj.take("lines").toArray())
+                rails.append(r);
+            other = std::move(obj);
+        }
+
+        QJsonObject toJson()const
+        {
+            QJsonObject obj = other;
+            obj.insert("trains", trains);
+            obj.insert("circuits", routings);
+            if (!rails.isEmpty()) {
+                obj.insert("line", rails.first());
+                if (rails.size() > 1) {
+                    QJsonArray lines;
+                    for (int i = 1; i < rails.size(); i++)
+                        lines.append(rails.at(i));
+                    obj.insert("lines", lines);
+                }
+            }
+            return obj;
+        }
+
+        bool apply(const QJsonObject& rec)
+        {
+            const QString& op = rec.value("op").toString();
+            if (op == "train") upsert(trains, trainKey, rec);
+            else if (op == "train_del") removeByName(trains, trainKey, rec.value("name").toString());
+            else if (op == "rail") upsert(rails, nameKey, rec);
+            else if (op == "rail_del") removeByName(rails, nameKey, rec.value("name").toString());
+            else if (op == "routing") upsert(routings, nameKey, rec);
+            else if (op == "routing_del") removeByName(routings, nameKey, rec.value("name").toString());
+            else if (op == "full") load(rec.value("data").toObject());
+            else return false;
+            return true;
+        }
+    };
+
+    bool syncToDisk(QFile& file)
+    {
+        if (!file.flush())
+            return false;
+#ifdef Q_OS_WIN
+        return _commit(file.handle()) == 0;
+#else
+        return ::fsync(file.handle()) == 0;
+#endif
+    }
+}
+
+QString DiagramJournal::journalFileName(const QString& diagramFile)
+{
+    return diagramFile + ".journal";
+}
+
+DiagramJournal::DiagramJournal(Diagram& diagram) :
+    diagram(diagram)
+{
+}
+
+DiagramJournal::~DiagramJournal()
+{
+    if (!_writer.joinable())
+        return;
+    {
+        std::lock_guard lck(_mtx);
+        _stop = true;
+    }
+    _cvJob.notify_all();
+    _writer.join();
+}
+
+bool DiagramJournal::needsCompaction() const
+{
+    return _records >= COMPACT_RECORDS || _fullRecords >= COMPACT_FULL_RECORDS || size() >= COMPACT_BYTES;
+}
+
+void DiagramJournal::startWriter()
+{
+    if (!_writer.joinable())
+        _writer = std::thread([this]() { writerLoop(); });
+}
+
+void DiagramJournal::writerLoop()
+{
+    std::unique_lock lck(_mtx);
+    while (true) {
+        _cvJob.wait(lck, [this]() { return _stop || !_jobs.empty(); });
+        if (_jobs.empty())
+            return;   // _stop，且已经写完
+        WriteJob job = std::move(_jobs.front());
+        _jobs.pop_front();
+        _busy = true;
+        lck.unlock();
+        writeJob(job);
+        lck.lock();
+        _busy = false;
+        if (_jobs.empty())
+            _cvIdle.notify_all();
+    }
+}
+
+void DiagramJournal::writeJob(const WriteJob& job)
+{
+    if (job.truncate && !(file.resize(0) && file.seek(0))) {
+        qWarning() << "DiagramJournal: cannot truncate journal: " << file.errorString();
+        return;
+    }
+    QByteArray data;
+    for (const auto& rec : job.records) {
+        data.append(QJsonDocument(rec).toJson(QJsonDocument::Compact));
+        data.append('\n');
+    }
+    // 只刷新到操作系统：程序崩溃时不丢失；commit时才同步到磁盘
+    if (file.write(data) != data.size() || !file.flush()) {
+        qWarning() << "DiagramJournal: write failed: " << file.errorString();
+    }
+    _written = file.pos();
+}
+
+void DiagramJournal::drain()
+{
+    std::unique_lock lck(_mtx);
+    _cvIdle.wait(lck, [this]() { return _jobs.empty() && !_busy; });
+}
+
+QJsonObject DiagramJournal::baseHeader(const QString& filename, const QString& baseId)
+{
+    QJsonObject head{
+        {"qetrc_journal", FORMAT_VERSION},
+        {"base_id", baseId},
+    };
+    if (baseId.isEmpty()) {
+        QFileInfo info(filename);
+        head.insert("base_size", info.size());
+        head.insert("base_mtime", info.lastModified().toMSecsSinceEpoch());
+    }
+    return head;
+}
+
+bool DiagramJournal::restart(const QString& baseId)
+{
+    drain();
+    file.close();
+    _active = false;
+    if (diagram.filename().isEmpty())
+        return false;
+    file.setFileName(journalFileName(diagram.filename()));
+    if (!file.open(QFile::WriteOnly | QFile::Truncate)) {
+        qWarning() << "DiagramJournal: cannot open journal file " << file.fileName();
+        return false;
+    }
+    _records = _pending = _fullRecords = 0;
+    _hasCommit = false;
+    _header = baseHeader(diagram.filename(), baseId);
+    if (!writeLine(_header)) {
+        file.close();
+        return false;
+    }
+    _committedSize = _written = file.pos();
+    startWriter();
+    _active = true;
+    rebuildNameMaps();
+    return true;
+}
+
+bool DiagramJournal::resume(qint64 keepBytes, qint64 committedSize, bool hasCommit, int records)
+{
+    drain();
+    file.close();
+    _active = false;
+    if (diagram.filename().isEmpty())
+        return false;
+    file.setFileName(journalFileName(diagram.filename()));
+    if (!file.open(QFile::ReadWrite) || !file.resize(keepBytes)) {
+        qWarning() << "DiagramJournal: cannot resume journal file " << file.fileName();
+        file.close();
+        return false;
+    }
+    _header = QJsonDocument::fromJson(file.readLine()).object();
+    if (!file.seek(keepBytes)) {
+        file.close();
+        return false;
+    }
+    _committedSize = std::min(committedSize, keepBytes);
+    _written = keepBytes;
+    _hasCommit = hasCommit;
+    _records = records;
+    _pending = _fullRecords = 0;
+    startWriter();
+    _active = true;
+    rebuildNameMaps();
+    return true;
+}
+
+void DiagramJournal::discardUncommitted()
+{
+    if (!isActive())
+        return;
+    drain();
+    if (_hasCommit) {
+        file.resize(_committedSize);
+        file.close();
+    }
+    else {
+        file.close();
+        file.remove();
+    }
+    _active = false;
+    _records = _pending = _fullRecords = 0;
+}
+
+void DiagramJournal::remove()
+{
+    if (!isActive())
+        return;
+    drain();
+    file.close();
+    file.remove();
+    _active = false;
+    _hasCommit = false;
+    _records = _pending = _fullRecords = 0;
+}
+
+void DiagramJournal::rebuildNameMaps()
+{
+    trainNames.clear();
+    railNames.clear();
+    routingNames.clear();
+    for (const auto& t : diagram.trainCollection().trains())
+        trainNames.emplace(t.get(), t->trainName().full());
+    for (const auto& r : diagram.railways())
+        railNames.emplace(r.get(), r->name());
+    for (const auto& r : diagram.trainCollection().routings())
+        routingNames.emplace(r.get(), r->name());
+}
+
+void DiagramJournal::append(const QJsonObject& rec)
+{
+    {
+        std::lock_guard lck(_mtx);
+        _jobs.push_back(WriteJob{ { rec }, false });
+    }
+    _cvJob.notify_one();
+}
+
+bool DiagramJournal::writeLine(const QJsonObject& rec)
+{
+    QByteArray line = QJsonDocument(rec).toJson(QJsonDocument::Compact);
+    line.append('\n');
+    if (file.write(line) != line.size() || !file.flush()) {
+        qWarning() << "DiagramJournal: write failed: " << file.errorString();
+        return false;
+    }
+    _written = file.pos();
+    return true;
+}
+
+void DiagramJournal::checkpoint(QJsonObject full)
+{
+    {
+        std::lock_guard lck(_mtx);
+        _jobs.push_back(WriteJob{ { _header, std::move(full) }, true });
+    }
+    _cvJob.notify_one();
+    // 恢复时，这个快照是唯一一条未保存的修改
+    _records = _pending = _fullRecords = 1;
+}
+
+void DiagramJournal::compactIfNeeded()
+{
+    if (!_hasCommit && needsCompaction()) {
+        checkpoint(QJsonObject{ {"op","full"}, {"data",diagram.toJson()} });
+        rebuildNameMaps();
+    }
+}
+
+void DiagramJournal::record(const JournalTouch& touch)
+{
+    if (!isActive())
+        return;
+    if (touch.full) {
+        recordFull();
+        return;
+    }
+
+    auto& coll = diagram.trainCollection();
+    for (const auto& train : touch.trains) {
+        auto p = trainNames.find(train.get());
+        int idx = coll.getTrainIndex(train);
+        if (idx >= 0) {
+            const QString& name = train->trainName().full();
+            QJsonObject rec{ {"op","train"}, {"name",name}, {"index",idx}, {"data",train->toJson()} };
+            if (p != trainNames.end() && p->second != name)
+                rec.insert("old", p->second);
+            append(rec);
+            trainNames[train.get()] = name;
+        }
+        else if (p != trainNames.end()) {
+            append(QJsonObject{ {"op","train_del"}, {"name",p->second} });
+            trainNames.erase(p);
+        }
+        else continue;
+        _records++;
+        _pending++;
+    }
+
+    for (const auto& rail : touch.railways) {
+        auto p = railNames.find(rail.get());
+        int idx = diagram.railways().indexOf(rail);
+        if (idx >= 0) {
+            QJsonObject rec{ {"op","rail"}, {"name",rail->name()}, {"index",idx}, {"data",rail->toJson()} };
+            if (p != railNames.end() && p->second != rail->name())
+                rec.insert("old", p->second);
+            append(rec);
+            railNames[rail.get()] = rail->name();
+        }
+        else if (p != railNames.end()) {
+            append(QJsonObject{ {"op","rail_del"}, {"name",p->second} });
+            railNames.erase(p);
+        }
+        else continue;
+        _records++;
+        _pending++;
+    }
+
+    for (const auto& routing : touch.routings) {
+        auto p = routingNames.find(routing.get());
+        int idx = coll.getRoutingIndex(routing);
+        if (idx >= 0) {
+            QJsonObject rec{ {"op","routing"}, {"name",routing->name()}, {"index",idx},
+                {"data",routing->toJson()} };
+            if (p != routingNames.end() && p->second != routing->name())
+                rec.insert("old", p->second);
+            append(rec);
+            routingNames[routing.get()] = routing->name();
+        }
+        else if (p != routingNames.end()) {
+            append(QJsonObject{ {"op","routing_del"}, {"name",p->second} });
+            routingNames.erase(p);
+        }
+        else continue;
+        _records++;
+        _pending++;
+    }
+    compactIfNeeded();
+}
+
+void DiagramJournal::recordFull()
+{
+    if (!isActive())
+        return;
+    QJsonObject rec{ {"op","full"}, {"data",diagram.toJson()} };
+    _records++;
+    _pending++;
+    _fullRecords++;
+    if (!_hasCommit && needsCompaction())
+        checkpoint(std::move(rec));
+    else
+        append(rec);
+    rebuildNameMaps();
+}
+
+bool DiagramJournal::commit()
+{
+    if (!isActive())
+        return false;
+    drain();
+    if (!writeLine(QJsonObject{ {"op","commit"} }) || !syncToDisk(file))
+        return false;
+    _committedSize = file.pos();
+    _hasCommit = true;
+    _pending = 0;
+    return true;
+}
+
+QJsonObject DiagramJournal::readBaseJson(const QString& filename)
+{
+    if (qebin::isBinaryFile(filename)) {
+        qebin::DiagramReader reader;
+        if (!reader.open(filename))
+            return {};
+        return reader.readAll();
+    }
+    QFile f(filename);
+    if (!f.open(QFile::ReadOnly))
+        return {};
+    return QJsonDocument::fromJson(f.readAll()).object();
+}
+
+DiagramJournal::ReplayResult DiagramJournal::replay(const QString& filename, const QJsonObject& base)
+{
+    ReplayResult res;
+    QFile f(journalFileName(filename));
+    if (!f.open(QFile::ReadOnly))
+        return res;
+
+    const QJsonObject& head = QJsonDocument::fromJson(f.readLine()).object();
+    if (head.value("qetrc_journal").toInt() <= 0 || head.value("qetrc_journal").toInt() > FORMAT_VERSION)
+        return res;
+    res.committedSize = res.totalSize = f.pos();
+
+    // 基准文件不匹配时，只能从日志中的第一个完整快照开始
+    bool baseMatched;
+    const QString& baseId = head.value("base_id").toString();
+    if (!baseId.isEmpty()) {
+        baseMatched = (base.value(baseIdKey).toString() == baseId);
+    }
+    else {
+        QFileInfo info(filename);
+        baseMatched = !base.isEmpty() &&
+            head.value("base_size").toVariant().toLongLong() == info.size() &&
+            head.value("base_mtime").toVariant().toLongLong() == info.lastModified().toMSecsSinceEpoch();
+    }
+
+    ReplayData data;
+    data.load(baseMatched ? base : QJsonObject{});
+    bool started = baseMatched;
+    int pending = 0;
+    while (!f.atEnd()) {
+        QByteArray line = f.readLine();
+        if (!line.endsWith('\n'))
+            break;   // 写入中途崩溃
+        QJsonParseError err;
+        const QJsonObject& rec = QJsonDocument::fromJson(line, &err).object();
+        if (err.error != QJsonParseError::NoError)
+            break;
+        res.totalSize = f.pos();
+        if (rec.value("op").toString() == "commit") {
+            if (started) {
+                res.committed += pending;
+                pending = 0;
+                res.committedData = data.toJson();
+                res.hasCommit = true;
+            }
+            res.committedSize = res.totalSize;
+            continue;
+        }
+        if (!started) {
+            if (rec.value("op").toString() != "full")
+                continue;
+            started = true;
+        }
+        if (data.apply(rec))
+            pending++;
+    }
+    if (!started) {
+        qWarning() << "DiagramJournal: journal does not match " << filename << ", ignored";
+        return res;
+    }
+    res.valid = true;
+    res.uncommitted = pending;
+    if (!res.hasCommit)
+        res.committedData = baseMatched ? base : QJsonObject{};
+    res.allData = data.toJson();
+    return res;
+}
@@ -0,0 +1,206 @@
+#pragma once
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QString>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class Diagram;
+class Train;
+class Railway;
+class Routing;
+
+/**
+ * 2026.10.19  一条（或一组）撤销命令所改动的对象。
+ * 日志按对象记录命令执行（或撤销）之后的完整状态，因此redo/undo/merge都只需报告改动了谁。
+ */
+struct JournalTouch {
+    std::vector<std::shared_ptr<Train>> trains;
+    std::vector<std::shared_ptr<Railway>> railways;
+    std::vector<std::shared_ptr<Routing>> routings;
+
+    /**
+     * 改动了上述之外的数据（例如径路、页面、配置），需要记录完整快照
+     */
+    bool full = false;
+};
+
+namespace qecmd {
+    /**
+     * 2026.10.19  可以增量记录到编辑日志的撤销命令。
+     * 与QUndoCommand一起作为基类；未实现本接口的命令在日志中记为完整快照。
+     */
+    class JournaledCommand {
+    public:
+        virtual ~JournaledCommand() = default;
+        virtual void journalTouched(JournalTouch& touch)const = 0;
+    };
+}
+
+/**
+ * 2026.10.19  运行图文件的追加式编辑日志（文件名为运行图文件名 + ".journal"）。
+ * 每行一条紧凑JSON记录：第一行为文件头，记录对应的基准文件标识；
+ * 其后每条记录为一个对象改动后的完整数据（按名称定位），或者删除，或者完整快照；
+ * {"op":"commit"} 表示此前的记录已经由增量保存确认。
+ * 最后一次commit之后的记录是未保存的编辑，程序异常退出后可据此恢复。
+ * 是否启用见SystemJson::journal_enabled。
+ *
+ * 日志只由MainWindow在GUI线程中使用。记录的数据（QJsonObject）在GUI线程中生成，
+ * 序列化和写文件由日志自己的后台线程按顺序完成；commit()等需要文件位置的操作先等待写完。
+ * 后台线程在第一次restart()或resume()时才启动，未启用日志时不占用线程。
+ * 还没有commit时，完整快照累计过多或日志过大，则改写为文件头加一个当前的完整快照（检查点）；
+ * 有commit时不能这样合并（须保留已确认与未确认的界限），由下一次完整保存重新开始日志。
+ */
+class DiagramJournal
+{
+    Diagram& diagram;
+    QFile file;
+    QJsonObject _header;
+    bool _active = false;
+    qint64 _committedSize = 0;      // 最后一条commit之后的位置（没有commit时为文件头之后）
+    bool _hasCommit = false;
+    int _records = 0, _pending = 0, _fullRecords = 0;
+
+    /**
+     * 交给后台线程的写入：依次写入records；truncate为true时先清空文件
+     */
+    struct WriteJob {
+        std::vector<QJsonObject> records;
+        bool truncate = false;
+    };
+    std::thread _writer;
+    std::mutex _mtx;
+    std::condition_variable _cvJob, _cvIdle;
+    std::deque<WriteJob> _jobs;
+    bool _busy = false, _stop = false;
+    std::atomic<qint64> _written{ 0 };     // 后台线程写完的文件长度
+
+    // 各对象在日志中的当前名称，用于识别改名和删除
+    std::unordered_map<const Train*, QString> trainNames;
+    std::unordered_map<const Railway*, QString> railNames;
+    std::unordered_map<const Routing*, QString> routingNames;
+
+public:
+    static constexpr int FORMAT_VERSION = 1;
+
+    /**
+     * 超过这些限度时，应当以完整保存代替增量保存（压缩日志）
+     */
+    static constexpr int COMPACT_RECORDS = 1000;
+    static constexpr int COMPACT_FULL_RECORDS = 8;
+    static constexpr qint64 COMPACT_BYTES = 16 << 20;
+
+    /**
+     * 写入运行图文件中的基准标识的key。文件中没有标识时（旧文件），改用文件大小和修改时间。
+     */
+    static const QString baseIdKey;
+
+    static QString journalFileName(const QString& diagramFile);
+
+    explicit DiagramJournal(Diagram& diagram);
+    DiagramJournal(const DiagramJournal&) = delete;
+    DiagramJournal& operator=(const DiagramJournal&) = delete;
+    ~DiagramJournal();
+
+    bool isActive()const { return _active; }
+    int recordCount()const { return _records; }
+    int pendingCount()const { return _pending; }
+
+    /**
+     * 已经写入文件的长度（不含尚在后台队列中的记录）
+     */
+    qint64 size()const { return isActive() ? _written.load() : 0; }
+    bool needsCompaction()const;
+
+    /**
+     * 为diagram当前的文件名新建日志（覆盖旧日志）。
+     * baseId为基准文件中的标识，为空时记录基准文件当前的大小和修改时间。
+     */
+    bool restart(const QString& baseId);
+
+    /**
+     * 打开文件时接续已有日志：截断到keepBytes，此后继续追加。
+     * committedSize/hasCommit/records见ReplayResult。
+     */
+    bool resume(qint64 keepBytes, qint64 committedSize, bool hasCommit, int records);
+
+    /**
+     * 丢弃最后一次commit之后的记录并关闭；没有commit时删除日志文件。
+     * 用于正常关闭（用户已经选择保存或放弃修改）。
+     */
+    void discardUncommitted();
+
+    /**
+     * 关闭并删除日志文件。用于未启用日志时，接续的旧日志已经完整保存到运行图文件之后。
+     */
+    void remove();
+
+    void record(const JournalTouch& touch);
+    void recordFull();
+
+    /**
+     * 增量保存：写入commit并刷新到磁盘。
+     */
+    bool commit();
+
+    struct ReplayResult {
+        bool valid = false;             // 日志与基准文件匹配
+        QJsonObject committedData;      // 应用到最后一次commit为止
+        QJsonObject allData;            // 应用全部记录
+        int committed = 0, uncommitted = 0;
+        bool hasCommit = false;
+        qint64 committedSize = 0, totalSize = 0;
+    };
+
+    /**
+     * 读取运行图文件filename的原始数据（JSON或二进制格式），失败返回空对象。
+     */
+    static QJsonObject readBaseJson(const QString& filename);
+
+    /**
+     * 读取filename对应的日志，并应用到基准数据上。
+     * 末尾不完整的记录（写入中途崩溃）被忽略。
+     */
+    static ReplayResult replay(const QString& filename, const QJsonObject& base);
+
+private:
+    void rebuildNameMaps();
+
+    /**
+     * 交给后台线程追加一条记录
+     */
+    void append(const QJsonObject& rec);
+
+    /**
+     * 立即写入一条记录。仅在后台线程空闲时（drain()之后）调用。
+     */
+    bool writeLine(const QJsonObject& rec);
+
+    /**
+     * 等待后台线程写完已提交的记录
+     */
+    void drain();
+
+    /**
+     * 后台线程尚未启动时启动
+     */
+    void startWriter();
+    void writerLoop();
+    void writeJob(const WriteJob& job);
+
+    /**
+     * 没有commit时，日志过大则改写为文件头加上full（当前数据的完整快照）
+     */
+    void checkpoint(QJsonObject full);
+    void compactIfNeeded();
+
+    static QJsonObject baseHeader(const QString& filename, const QString& baseId);
+};
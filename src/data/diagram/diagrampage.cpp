@@ -50,6 +50,14 @@ int DiagramPage::railwayIndex(const Railway& rail) const
     return -1;
 }
 
+void DiagramPage::updatePaintedRailIndex()
+{
+    _railIndex.clear();
+    for (int i = 0; i < _railways.size(); i++) {
+        _railIndex.insert(_railways.at(i).get(), i);
+    }
+}
+
 double DiagramPage::railwayStartY(const Railway& rail) const
 {
     int idx = railwayIndex(rail);
@@ -187,6 +195,7 @@ void DiagramPage::addForbidItem(const Forbid* forbid, Direction dir, QGraphicsRe
 void DiagramPage::clearGraphics()
 {
     _itemMap.clear();
+    _segmentIndex.clear();
     _forbidDMap.clear();
     _forbidUMap.clear();
     _belowLabels.clear();
@@ -228,7 +237,9 @@ void DiagramPage::swap(DiagramPage& other)
 
     // Items
     SWAP(_startYs);
+    SWAP(_railIndex);
     SWAP(_itemMap);
+    SWAP(_segmentIndex);
     SWAP(_forbidDMap);
     SWAP(_forbidUMap);
     SWAP(_overLabels);
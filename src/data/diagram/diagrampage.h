@@ -8,6 +8,7 @@
 #include "data/train/train.h"
 #include "config.h"
 #include "data/diagram/routelinklayer.h"
+#include "data/diagram/trainsegmentindex.h"
 
 class Railway;
 class Diagram;
@@ -59,9 +60,19 @@ class DiagramPage
     Config _config;
     QList<std::shared_ptr<Railway>> _railways;
     QList<double> _startYs;
+
+    /**
+     * 2026.10.19  铺画时建立的线路序号表（地址->下标），与_startYs同时更新
+     */
+    QHash<const Railway*, int> _railIndex;
     QString _name;
     QString _note;
     QHash<TrainLine*, TrainItem*> _itemMap;
+
+    /**
+     * 2026.10.19  运行线线段的空间索引，由TrainItem生成、删除运行线时维护
+     */
+    TrainSegmentIndex _segmentIndex;
     QHash<const Forbid*, QList<QGraphicsRectItem*>> _forbidDMap, _forbidUMap;   //天窗的item映射，分为上下行
     
     /**
@@ -111,6 +122,9 @@ public:
     auto& itemMap() { return _itemMap; }
     const auto& itemMap()const { return _itemMap; }
 
+    auto& segmentIndex() { return _segmentIndex; }
+    const auto& segmentIndex()const { return _segmentIndex; }
+
     QString railNameString()const;
 
     inline int railwayCount()const { return _railways.size(); }
@@ -125,6 +139,17 @@ public:
 
     double railwayStartY(const Railway& rail)const;
 
+    /**
+     * 2026.10.19  按铺画时建立的序号表查找线路下标，常数时间；找不到返回-1。
+     * 仅在铺画之后（startYs有效时）使用。
+     */
+    int paintedRailwayIndex(const Railway& rail)const { return _railIndex.value(&rail, -1); }
+
+    /**
+     * 2026.10.19  铺画时（设置startYs的同时）重建线路序号表
+     */
+    void updatePaintedRailIndex();
+
     void fromJson(const QJsonObject& obj, Diagram& _diagram);
     QJsonObject toJson()const;
 
@@ -0,0 +1,77 @@
+#include "diagramworkspace.h"
+
+#include <algorithm>
+#include <QFileInfo>
+
+#include "diagram.h"
+#include "util/qetrace.h"
+
+DiagramWorkspace* DiagramWorkspace::get()
+{
+    static DiagramWorkspace instance;
+    return &instance;
+}
+
+std::shared_ptr<const Diagram> DiagramWorkspace::open(const QString& filename)
+{
+    QE_TRACE_SCOPE("DiagramWorkspace::open");
+    const QFileInfo info(filename);
+    if (!info.exists())
+        return nullptr;
+    const QString name = canonicalName(filename);
+
+    auto p = std::find_if(_entries.begin(), _entries.end(),
+        [&name](const Entry& e) { return e.filename == name; });
+    if (p != _entries.end()) {
+        if (p->modified == info.lastModified() && p->size == info.size()) {
+            _entries.splice(_entries.begin(), _entries, p);
+            return _entries.front().diagram;
+        }
+        // 文件已经改变，重新读取
+        _entries.erase(p);
+        releaseUnused();
+    }
+
+    auto dia = std::make_shared<Diagram>();
+    dia->setRailwayPool(&_pool);
+    const bool flag = dia->fromJson(filename);
+    dia->setRailwayPool(nullptr);
+    if (!flag || dia->isNull())
+        return nullptr;
+
+    _entries.push_front(Entry{ name, info.lastModified(), info.size(), dia });
+    shrink();
+    return dia;
+}
+
+void DiagramWorkspace::setCapacity(int n)
+{
+    _capacity = std::max(n, 1);
+    shrink();
+}
+
+QString DiagramWorkspace::canonicalName(const QString& filename)
+{
+    const QFileInfo info(filename);
+    const QString s = info.canonicalFilePath();
+    return s.isEmpty() ? info.absoluteFilePath() : s;
+}
+
+void DiagramWorkspace::shrink()
+{
+    if (static_cast<int>(_entries.size()) <= _capacity)
+        return;
+    _entries.resize(_capacity);
+    releaseUnused();
+}
+
+void DiagramWorkspace::releaseUnused()
+{
+    QE_TRACE_SCOPE("DiagramWorkspace::releaseUnused");
+    _pool.purge();
+    _pool.clearNames();
+    for (const auto& e : _entries) {
+        // 重新登记只是以相同内容的字符串替换，不改变运行图的数据
+        _pool.internNames(e.diagram->trainCollection());
+    }
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <list>
+#include <memory>
+#include <QDateTime>
+#include <QString>
+
+#include "data/rail/railwaypool.h"
+
+class Diagram;
+
+/**
+ * 2026.10.19
+ * @brief The DiagramWorkspace class
+ * 同时保持读入的若干运行图文件（主窗口的运行图以外），供运行图对比、导入车次等功能使用，
+ * 以免每次操作都重新读取、解析整个文件。
+ *
+ * 运行图按文件路径缓存，文件的修改时间、大小不变时直接返回已读入的对象；
+ * 超过容量时释放最久未使用的。所有运行图通过同一个RailwayPool读入：
+ * 同一线路的多个版本之间，内容相同的线路只解析、保存一份，车次名和站名也共享存储。
+ * 因此这里的运行图都是只读的（open()返回const）；要修改数据的，应当由其数据另行构造，
+ * 例如导入车次时由trainCollection().toJson()另建TrainCollection。
+ *
+ * 全局单例，非线程安全，仅在主线程中使用。
+ */
+class DiagramWorkspace
+{
+public:
+    struct Entry {
+        QString filename;   // 规范化的绝对路径
+        QDateTime modified;
+        qint64 size = 0;
+        std::shared_ptr<Diagram> diagram;
+    };
+
+private:
+    std::list<Entry> _entries;   // 最近使用的在前
+    RailwayPool _pool;
+    int _capacity = 8;
+
+    DiagramWorkspace() = default;
+
+public:
+    DiagramWorkspace(const DiagramWorkspace&) = delete;
+    DiagramWorkspace& operator=(const DiagramWorkspace&) = delete;
+
+    static DiagramWorkspace* get();
+
+    /**
+     * 读入（或取得已读入的）运行图文件，支持fromJson(filename)能识别的全部格式。
+     * 失败（文件不存在、格式错误或为空）返回空指针。
+     * 返回的对象在释放之前一直有效，即使之后被移出工作区。
+     */
+    std::shared_ptr<const Diagram> open(const QString& filename);
+
+    const auto& entries()const { return _entries; }
+    const RailwayPool& pool()const { return _pool; }
+
+    int capacity()const { return _capacity; }
+
+    /**
+     * 最多保持的运行图数；至少为1
+     */
+    void setCapacity(int n);
+
+private:
+    static QString canonicalName(const QString& filename);
+    void shrink();
+
+    /**
+     * 移出运行图后，释放池中不再使用的线路和名称：
+     * 删除已释放线路的登记项；名称表清空后，由仍在工作区中的运行图重新登记。
+     */
+    void releaseUnused();
+};
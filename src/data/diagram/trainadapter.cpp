@@ -8,6 +8,7 @@
 #include "data/rail/ruler.h"
 #include "data/train/train.h"
 #include "data/trainpath/trainpath.h"
+#include "data/trainpath/trainpathbinding.h"
 
 #include "log/IssueManager.h"
 
@@ -51,17 +52,17 @@ void TrainAdapter::bindTrainByPath(std::shared_ptr<Train> train, const TrainPath
 			"此径路将被忽略").arg(path->name())));
 		return;
 	}
+	bindTrainByPath(std::move(train), TrainPathBinding(path));
+}
 
+void TrainAdapter::bindTrainByPath(std::shared_ptr<Train> train, const TrainPathBinding& binding)
+{
+	assert(binding.valid());
 	std::map<Railway*, std::shared_ptr<TrainAdapter>> adp_map;
 	
-	StationName start_station = path->startStation();
 	auto tit_last_bind = train->timetable().begin();
-	for (const auto& seg : path->segments()) {
-		auto rail = seg.railway.lock();
-		auto rst_start = rail->stationByName(start_station);
-		auto rst_end = rail->stationByName(seg.end_station);
-		double mile_start = rst_start->mile;
-		double mile_end = rst_end->mile;
+	for (const auto& seg : binding.segments()) {
+		const auto& rail = seg.railway;
 
 		std::shared_ptr<TrainAdapter> adp{};
 		if (auto itr = adp_map.find(rail.get()); itr != adp_map.end()) {
@@ -79,14 +80,14 @@ void TrainAdapter::bindTrainByPath(std::shared_ptr<Train> train, const TrainPath
 		auto tit_last_bind_before_loop = tit_last_bind;
 		// loop over train stations
 		for (auto tit = tit_last_bind; tit != train->timetable().end(); ++tit) {
-			auto rst = rail->stationByGeneralName(tit->name);
+			int ipos;
+			auto rst = seg.stationByGeneralName(tit->name, ipos);
 			if (!rst) {
 				// station not in railway, just pass
 				continue;
 			}
 
-			// now, rst is not empty
-			auto ipos = stationInSegment(mile_start, mile_end, seg.dir, *rst);
+			// now, rst is not empty; ipos is pre-computed by stationInSegment()
 			if (ipos < 0) {
 				// before range, nothing to do
 			}
@@ -125,8 +126,6 @@ void TrainAdapter::bindTrainByPath(std::shared_ptr<Train> train, const TrainPath
 			// 2024.03.20: for this case, restore tit_last_bind, since the previous bind is withdrawn
 			tit_last_bind = tit_last_bind_before_loop;
 		}
-
-		start_station = seg.end_station;
 	}
 
 	for (auto itr = adp_map.begin(); itr != adp_map.end(); ++itr) {
@@ -8,6 +8,7 @@
 class TrainCollection;
 struct Config;
 class TrainPath;
+class TrainPathBinding;
 
 /**
  * @brief 与线路数据相结合的列车信息
@@ -83,6 +84,13 @@ public:
      */
     static void bindTrainByPath(std::shared_ptr<Train> train, const TrainPath* path);
 
+    /**
+     * 2026.10.19  Same as above, but using the pre-resolved path (which should be valid).
+     * Only the train (and its adapters) is modified: trains sharing the same binding object
+     * could be bound in different threads. No issue is reported here.
+     */
+    static void bindTrainByPath(std::shared_ptr<Train> train, const TrainPathBinding& binding);
+
     /**
      * @brief listAdapterEvents 列出本次列车在本线的事件表
      * 逐段运行线计算。实际上只是个转发
@@ -159,6 +167,7 @@ public:
     int timetableInterpolationSimple();
 
 private:
+    friend class TrainPathBinding;
 
     /**
      * @brief autoLines
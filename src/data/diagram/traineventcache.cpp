@@ -0,0 +1,39 @@
+#include "traineventcache.h"
+#include "trainline.h"
+#include "data/train/train.h"
+
+const LineEventList& TrainEventCache::lineEvents(const std::shared_ptr<const TrainLine>& line,
+    const TrainCollection& coll)
+{
+    auto related = line->overlappingLines(coll);
+    auto& entry = _entries[line.get()];
+
+    bool valid = (entry.line.lock() == line && entry.version == line->train()->tempVersion()
+        && entry.related.size() == related.size());
+    for (size_t i = 0; valid && i < related.size(); i++) {
+        // lock()失败说明记录的运行线已销毁；即使新对象恰好占用了同一地址也能识别
+        valid = (entry.related[i].first.lock() == related[i]
+            && entry.related[i].second == related[i]->train()->tempVersion());
+    }
+    if (valid)
+        return entry.events;
+
+    entry.line = line;
+    entry.version = line->train()->tempVersion();
+    entry.related.clear();
+    entry.related.reserve(related.size());
+    for (const auto& r : related)
+        entry.related.emplace_back(r, r->train()->tempVersion());
+    entry.events = line->listLineEvents(related);
+    return entry.events;
+}
+
+void TrainEventCache::prune()
+{
+    for (auto itr = _entries.begin(); itr != _entries.end();) {
+        if (itr->second.line.expired())
+            itr = _entries.erase(itr);
+        else
+            ++itr;
+    }
+}
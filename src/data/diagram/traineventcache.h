@@ -0,0 +1,45 @@
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "trainevents.h"
+
+class TrainLine;
+class TrainCollection;
+
+/**
+ * 2026.10.19  运行线事件表的缓存，由Diagram::listTrainEvents()使用。
+ * 一条运行线的事件表只取决于其自身和与之时刻、里程相交的其他运行线（TrainLine::overlappingLines()）。
+ * 缓存项记录这些运行线的弱引用及其车次的Train::tempVersion()：查询时重新收集相交运行线，与记录逐一比对；
+ * 本线或任一相交运行线被替换、删除、新增，或其车次的时刻表被原地修改（如拖动时刻，
+ * 见TrainContext::onTrainStationTimeChanged()）后，才重新计算。
+ * 因此某车次更新后，只有与之相交的运行线需要重算，其余仍然命中。
+ * 非线程安全，只在主线程使用。
+ */
+class TrainEventCache
+{
+    struct Entry {
+        std::weak_ptr<const TrainLine> line;
+        unsigned version = 0;   // 本线车次的tempVersion
+        std::vector<std::pair<std::weak_ptr<const TrainLine>, unsigned>> related;
+        LineEventList events;
+    };
+    std::unordered_map<const TrainLine*, Entry> _entries;
+
+public:
+    /**
+     * 返回line的事件表，必要时重新计算。
+     */
+    const LineEventList& lineEvents(const std::shared_ptr<const TrainLine>& line,
+        const TrainCollection& coll);
+
+    /**
+     * 删除本线已失效的缓存项
+     */
+    void prune();
+
+    void clear() { _entries.clear(); }
+    auto size()const { return _entries.size(); }
+};
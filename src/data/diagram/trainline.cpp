@@ -131,6 +131,69 @@ LineEventList TrainLine::listLineEvents(const TrainCollection& coll) const
     return res;
 }
 
+LineEventList TrainLine::listLineEvents(const std::vector<std::shared_ptr<const TrainLine>>& related) const
+{
+    LineEventList res;
+    res.reserve(static_cast<int>(_stations.size()));
+    for (size_t i = 0; i < _stations.size(); i++) {
+        res.push_back(StationEventList());
+    }
+
+    listStationEvents(res);
+
+    for (const auto& line : related) {
+        if (line->dir() == dir()) {
+            eventsWithSameDir(res, *line, *line->train());
+        }
+        else {
+            eventsWithCounter(res, *line, *line->train());
+        }
+    }
+    return res;
+}
+
+std::vector<std::shared_ptr<const TrainLine>> TrainLine::overlappingLines(const TrainCollection& coll) const
+{
+    std::vector<std::shared_ptr<const TrainLine>> res;
+    for (auto t : coll.trains()) {
+        if (t == train())
+            continue;
+        for (auto adp : t->adapters()) {
+            if (_adapter.isInSameRailway(*adp)) {
+                for (auto line : adp->lines()) {
+                    if (overlapsWith(*line))
+                        res.emplace_back(line);
+                }
+            }
+        }
+    }
+    return res;
+}
+
+bool TrainLine::overlapsWith(const TrainLine& another) const
+{
+    if (isNull() || another.isNull())
+        return false;
+
+    // 里程
+    auto mile_range = [](const TrainLine& line) {
+        auto first = line.firstRailStation(), last = line.lastRailStation();
+        double m1 = first ? first->mile : 0, m2 = last ? last->mile : 0;
+        return std::make_pair(std::min(m1, m2), std::max(m1, m2));
+    };
+    auto [min1, max1] = mile_range(*this);
+    auto [min2, max2] = mile_range(another);
+    if (max1 < min2 || max2 < min1)
+        return false;
+
+    // 时刻，按周期边界考虑
+    const QTime& start1 = _stations.front().trainStation->arrive;
+    const QTime& start2 = another._stations.front().trainStation->arrive;
+    int len1 = qeutil::secsTo(start1, _stations.back().trainStation->depart);
+    int len2 = qeutil::secsTo(start2, another._stations.back().trainStation->depart);
+    return qeutil::secsTo(start1, start2) <= len1 || qeutil::secsTo(start2, start1) <= len2;
+}
+
 DiagnosisList TrainLine::diagnoseLine(const TrainCollection& coll, bool withIntMeet) const
 {
     Q_UNUSED(withIntMeet);
@@ -4,6 +4,7 @@
 #include <deque>
 #include <optional>
 #include <tuple>
+#include <vector>
 #include <cstdint>
 #include <QPair>
 #include <QList>
@@ -155,6 +156,27 @@ public:
      */
     LineEventList listLineEvents(const TrainCollection& coll)const;
 
+    /**
+     * 2026.10.19
+     * 仅以给定的相关运行线（通常由overlappingLines()给出）计算事件表。
+     * 与时刻、里程范围均不相交的运行线不产生事件，故结果与上一版本相同。
+     */
+    LineEventList listLineEvents(const std::vector<std::shared_ptr<const TrainLine>>& related)const;
+
+    /**
+     * 2026.10.19
+     * 本线路上其他车次中，与本运行线在时刻和里程范围上都相交的运行线，按车次表顺序。
+     * 这些运行线决定了本运行线的事件表。
+     */
+    std::vector<std::shared_ptr<const TrainLine>> overlappingLines(const TrainCollection& coll)const;
+
+    /**
+     * 2026.10.19
+     * 与another的时刻范围（考虑跨日）和里程范围是否都相交（含端点）。
+     * 保守判断：首站按到达、末站按出发时刻计。
+     */
+    bool overlapsWith(const TrainLine& another)const;
+
     /**
      * 列车运行情况诊断，判断可能存在的问题。
      * 采用和`listLineEvents`类似的框架。
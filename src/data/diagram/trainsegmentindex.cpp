@@ -0,0 +1,129 @@
+#include "trainsegmentindex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+std::uint64_t TrainSegmentIndex::cellKey(int cx, int cy)
+{
+    return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(cx)) << 32)
+        | static_cast<std::uint32_t>(cy);
+}
+
+int TrainSegmentIndex::cellOf(double v)
+{
+    return static_cast<int>(std::floor(v / CELL_SIZE));
+}
+
+template <typename Func>
+void TrainSegmentIndex::forEachCell(const QLineF& line, Func&& func)
+{
+    int x1 = cellOf(std::min(line.x1(), line.x2())), x2 = cellOf(std::max(line.x1(), line.x2()));
+    int y1 = cellOf(std::min(line.y1(), line.y2())), y2 = cellOf(std::max(line.y1(), line.y2()));
+    for (int cx = x1; cx <= x2; cx++) {
+        for (int cy = y1; cy <= y2; cy++) {
+            func(cellKey(cx, cy));
+        }
+    }
+}
+
+double TrainSegmentIndex::distanceTo(const QLineF& line, const QPointF& pos)
+{
+    const double dx = line.dx(), dy = line.dy();
+    const double len2 = dx * dx + dy * dy;
+    double t = 0;
+    if (len2 > 0) {
+        t = ((pos.x() - line.x1()) * dx + (pos.y() - line.y1()) * dy) / len2;
+        t = std::clamp(t, 0.0, 1.0);
+    }
+    const double px = line.x1() + t * dx - pos.x(), py = line.y1() + t * dy - pos.y();
+    return std::sqrt(px * px + py * py);
+}
+
+void TrainSegmentIndex::insert(TrainItem* item, const std::vector<QLineF>& segments, double radius)
+{
+    remove(item);
+    if (segments.empty())
+        return;
+    _maxRadius = std::max(_maxRadius, radius);
+    auto& ids = _items[item];
+    ids.reserve(segments.size());
+    for (const auto& line : segments) {
+        int id;
+        if (!_freeSlots.empty()) {
+            id = _freeSlots.back();
+            _freeSlots.pop_back();
+            _segments[id] = Segment{ line, item, radius };
+        }
+        else {
+            id = static_cast<int>(_segments.size());
+            _segments.push_back(Segment{ line, item, radius });
+        }
+        ids.push_back(id);
+        forEachCell(line, [this, id](std::uint64_t key) {
+            _cells[key].push_back(id);
+            });
+    }
+}
+
+void TrainSegmentIndex::remove(TrainItem* item)
+{
+    auto itr = _items.find(item);
+    if (itr == _items.end())
+        return;
+    for (int id : itr->second) {
+        forEachCell(_segments[id].line, [this, id](std::uint64_t key) {
+            auto cell = _cells.find(key);
+            if (cell == _cells.end())
+                return;
+            auto& v = cell->second;
+            auto pos = std::find(v.begin(), v.end(), id);
+            if (pos != v.end()) {
+                *pos = v.back();
+                v.pop_back();
+            }
+            if (v.empty())
+                _cells.erase(cell);
+            });
+        _segments[id].item = nullptr;
+        _freeSlots.push_back(id);
+    }
+    _items.erase(itr);
+}
+
+void TrainSegmentIndex::clear()
+{
+    _segments.clear();
+    _freeSlots.clear();
+    _cells.clear();
+    _items.clear();
+    _maxRadius = 0;
+}
+
+TrainItem* TrainSegmentIndex::nearest(const QPointF& pos,
+    const std::function<bool(TrainItem*)>& accept, double* dist) const
+{
+    const double radius = _maxRadius;
+    TrainItem* res = nullptr;
+    double best = std::numeric_limits<double>::max();
+    const int x1 = cellOf(pos.x() - radius), x2 = cellOf(pos.x() + radius);
+    const int y1 = cellOf(pos.y() - radius), y2 = cellOf(pos.y() + radius);
+    for (int cx = x1; cx <= x2; cx++) {
+        for (int cy = y1; cy <= y2; cy++) {
+            auto cell = _cells.find(cellKey(cx, cy));
+            if (cell == _cells.end())
+                continue;
+            for (int id : cell->second) {
+                const auto& seg = _segments[id];
+                double d = distanceTo(seg.line, pos);
+                if (d <= seg.radius && d < best && (!accept || accept(seg.item))) {
+                    best = d;
+                    res = seg.item;
+                }
+            }
+        }
+    }
+    if (dist && res)
+        *dist = best;
+    return res;
+}
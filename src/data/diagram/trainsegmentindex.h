@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+#include <QLineF>
+#include <QPointF>
+
+class TrainItem;
+
+/**
+ * 2026.10.19  运行线线段的空间索引（均匀网格），场景坐标。
+ * 每个DiagramPage一份，由TrainItem在生成、删除运行线图形时自行登记、注销，
+ * 因此总是与场景中实际存在的运行线一致。
+ * 用于鼠标悬停、点击时查找指定点附近最近的运行线，代替QGraphicsScene::itemAt()在大量子Item中的查找。
+ * 每条线段登记到其外包矩形覆盖的所有网格中；查询只检查以查询点为中心、半径范围内的网格。
+ * 每个item登记时给出选中半径（与该运行线可选中部分的半宽一致），查询时按各自的半径判断。
+ * 只索引运行线主体，不含车次标签等，查不到时调用方应另行处理。
+ */
+class TrainSegmentIndex
+{
+public:
+    /**
+     * 网格边长，像素
+     */
+    static constexpr double CELL_SIZE = 32;
+
+    /**
+     * 登记item的全部线段。若item已登记，先注销原有的。
+     * @param radius  选中半径，场景坐标。点到线段距离不超过此值视为命中。
+     */
+    void insert(TrainItem* item, const std::vector<QLineF>& segments, double radius);
+
+    /**
+     * 注销item的全部线段；未登记的item直接返回。
+     */
+    void remove(TrainItem* item);
+
+    void clear();
+
+    bool empty()const { return _items.empty(); }
+
+    /**
+     * 命中pos（距离不超过所属item登记的选中半径）的最近线段所属的item，没有则返回nullptr。
+     * @param accept  可选，返回false的item不参与比较（例如不可见的）
+     * @param dist  可选，输出最近距离
+     */
+    TrainItem* nearest(const QPointF& pos,
+        const std::function<bool(TrainItem*)>& accept = {}, double* dist = nullptr)const;
+
+private:
+    struct Segment {
+        QLineF line;
+        TrainItem* item = nullptr;   // nullptr表示空位
+        double radius = 0;
+    };
+    std::vector<Segment> _segments;
+    std::vector<int> _freeSlots;
+    std::unordered_map<std::uint64_t, std::vector<int>> _cells;
+    std::unordered_map<TrainItem*, std::vector<int>> _items;
+
+    /**
+     * 已登记过的最大选中半径，决定查询时检查的网格范围。只增不减，clear()时归零。
+     */
+    double _maxRadius = 0;
+
+    static std::uint64_t cellKey(int cx, int cy);
+    static int cellOf(double v);
+
+    /**
+     * 对线段外包矩形覆盖的每个网格执行func(key)
+     */
+    template <typename Func>
+    static void forEachCell(const QLineF& line, Func&& func);
+
+    static double distanceTo(const QLineF& line, const QPointF& pos);
+};
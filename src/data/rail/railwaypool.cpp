@@ -0,0 +1,87 @@
+#include "railwaypool.h"
+
+#include <QCryptographicHash>
+#include <QJsonDocument>
+
+#include "railway.h"
+#include "data/common/stationname.h"
+#include "data/train/train.h"
+#include "data/train/traincollection.h"
+
+std::shared_ptr<Railway> RailwayPool::railway(const QJsonObject& obj)
+{
+    // 紧凑格式的JSON文本与内容一一对应（键按字典序输出），以其摘要为键
+    const QByteArray key = QCryptographicHash::hash(
+        QJsonDocument(obj).toJson(QJsonDocument::Compact), QCryptographicHash::Sha1);
+    if (auto p = _railways.value(key).lock()) {
+        _railwayHits++;
+        return p;
+    }
+    auto rail = std::make_shared<Railway>();
+    rail->fromJson(obj);
+    _railways.insert(key, rail);
+    _railwayMisses++;
+    return rail;
+}
+
+void RailwayPool::intern(QString& s)
+{
+    if (s.isEmpty())
+        return;
+    auto p = _names.constFind(s);
+    if (p == _names.cend()) {
+        _names.insert(s);
+    }
+    else {
+        s = *p;
+    }
+}
+
+void RailwayPool::intern(StationName& name)
+{
+    QString station = name.station(), field = name.field();
+    intern(station);
+    intern(field);
+    name.setStation(station);
+    name.setField(field);
+}
+
+void RailwayPool::internNames(TrainCollection& coll)
+{
+    for (const auto& train : coll.trains()) {
+        auto& tn = train->trainName();
+        QString full = tn.full(), down = tn.down(), up = tn.up();
+        intern(full); intern(down); intern(up);
+        tn.setFull(full); tn.setDown(down); tn.setUp(up);
+        intern(train->startingRef());
+        intern(train->terminalRef());
+        for (auto& st : train->timetable()) {
+            intern(st.name);
+            intern(st.track);
+        }
+    }
+}
+
+void RailwayPool::purge()
+{
+    for (auto p = _railways.begin(); p != _railways.end();) {
+        if (p.value().expired())
+            p = _railways.erase(p);
+        else
+            ++p;
+    }
+}
+
+void RailwayPool::clearNames()
+{
+    _names.clear();
+}
+
+int RailwayPool::railwayCount() const
+{
+    int cnt = 0;
+    for (const auto& p : _railways) {
+        if (!p.expired()) cnt++;
+    }
+    return cnt;
+}
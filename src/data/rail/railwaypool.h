@@ -0,0 +1,77 @@
+#pragma once
+
+#include <memory>
+#include <QByteArray>
+#include <QHash>
+#include <QJsonObject>
+#include <QSet>
+#include <QString>
+
+class Railway;
+class TrainCollection;
+class StationName;
+
+/**
+ * 2026.10.19
+ * @brief The RailwayPool class
+ * 在多张同时读入的运行图（见DiagramWorkspace）之间共享线路数据和名称字符串。
+ *
+ * 线路：以线路JSON数据的摘要为键。读图时若池中已有内容完全相同的线路，
+ * 直接使用同一个Railway对象，不再解析；否则解析并登记。池中只保存弱引用，
+ * 使用该线路的运行图全部释放后，线路随之释放。
+ * 共享的线路由多张运行图共同持有，因此必须视为只读：要修改的，应当由JSON另行解析一份再替换。
+ *
+ * 名称：车次名、站名等字符串按值去重，相同内容的QString共享同一份存储（隐式共享）。
+ * 名称表持有其中每个字符串的一份引用，无法得知哪些已不再被运行图使用，
+ * 因此只能整体清空后重新登记仍在使用的运行图（见DiagramWorkspace::releaseUnused()）。
+ *
+ * 非线程安全，仅在主线程中使用。
+ */
+class RailwayPool
+{
+    QHash<QByteArray, std::weak_ptr<Railway>> _railways;
+    QSet<QString> _names;
+    int _railwayHits = 0, _railwayMisses = 0;
+
+public:
+    RailwayPool() = default;
+    RailwayPool(const RailwayPool&) = delete;
+    RailwayPool& operator=(const RailwayPool&) = delete;
+
+    /**
+     * 按JSON数据取得线路：池中已有相同内容的直接返回，否则解析后登记。
+     */
+    std::shared_ptr<Railway> railway(const QJsonObject& obj);
+
+    /**
+     * 将s替换为池中内容相同的字符串（共享存储）；池中没有的登记s。
+     */
+    void intern(QString& s);
+
+    void intern(StationName& name);
+
+    /**
+     * 对所有车次的车次名、始发终到站、时刻表站名、股道去重
+     */
+    void internNames(TrainCollection& coll);
+
+    /**
+     * 删除已释放的线路的登记项
+     */
+    void purge();
+
+    /**
+     * 清空登记的名称。已经读入的运行图不受影响，但之后读入的不再与之共享存储，
+     * 除非对其重新调用internNames()。
+     */
+    void clearNames();
+
+    int railwayCount()const;
+    int nameCount()const { return _names.size(); }
+
+    /**
+     * 读图时复用已有线路、新解析线路的次数
+     */
+    int railwayHits()const { return _railwayHits; }
+    int railwayMisses()const { return _railwayMisses; }
+};
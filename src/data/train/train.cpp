@@ -847,6 +847,7 @@ void Train::invalidateTempData()
     _locMile = std::nullopt;
     _locRunSecs = std::nullopt;
     _locStaySecs = std::nullopt;
+    ++_tempVersion;
 }
 
 bool Train::timetableSame(const Train& other)const
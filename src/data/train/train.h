@@ -81,6 +81,11 @@ class Train:
     std::optional<double> _locMile;
     std::optional<int> _locRunSecs, _locStaySecs;
 
+    /**
+     * 2026.10.19  每次invalidateTempData()加一，供外部缓存（TrainSummaryTable）判断上述数据是否已变
+     */
+    unsigned _tempVersion = 0;
+
     /**
      * 2023.05.28  experimental: on painting flag.
      * 用于标识正在进行标尺排图/贪心推线的车次。正常情况都是false。
@@ -489,6 +494,8 @@ public:
      */
     void invalidateTempData();
 
+    unsigned tempVersion()const { return _tempVersion; }
+
     inline QString startEndString()const {
         return _starting.toSingleLiteral() + "->" + _terminal.toSingleLiteral();
     }
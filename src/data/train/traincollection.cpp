@@ -7,6 +7,7 @@
 #include <QFile>
 #include <QJsonObject>
 #include <QJsonDocument>
+#include <algorithm>
 
 #include "predeftrainfiltercore.h"
 
@@ -123,13 +124,17 @@ QJsonObject TrainCollection::toLocalJson(std::shared_ptr<Railway> rail, bool loc
 void TrainCollection::appendTrain(std::shared_ptr<Train> train)
 {
 	_trains.append(train);
+	_indexMap[train.get()] = _trains.size() - 1;
 	addMapInfo(train);
 }
 
 void TrainCollection::removeTrain(std::shared_ptr<Train> train)
 {
 	removeMapInfo(train);
-	_trains.removeOne(train);
+	if (int idx = getTrainIndex(train); idx != -1) {
+		_trains.removeAt(idx);
+		rebuildTrainIndex();
+	}
 }
 
 bool TrainCollection::trainNameExisted(const TrainName& name) const
@@ -170,20 +175,42 @@ std::shared_ptr<Train> TrainCollection::findFirstSingleName(const QString& name)
 
 QList<std::shared_ptr<Train>> TrainCollection::multiSearchTrain(const QString& name)
 {
+	if (name.isEmpty())
+		return _trains;    // 与TrainName::contains的语义一致：空串总是匹配
+	auto matched = nameIndex.search(name);
+	// 按列车表顺序输出
+	std::vector<std::pair<int, std::shared_ptr<Train>>> ordered;
+	ordered.reserve(matched.size());
+	for (auto& t : matched) {
+		ordered.emplace_back(getTrainIndex(t), std::move(t));
+	}
+	std::sort(ordered.begin(), ordered.end(), [](const auto& a, const auto& b) {
+		return a.first < b.first;
+		});
 	QList<std::shared_ptr<Train>> res;
-	foreach (auto t , _trains) {
-		if (t->trainName().contains(name))
-			res.append(t);
+	res.reserve(static_cast<int>(ordered.size()));
+	for (auto& p : ordered) {
+		res.append(std::move(p.second));
 	}
 	return res;
 }
 
+std::vector<std::shared_ptr<Train>> TrainCollection::multiSearchTrainUnordered(const QString& name) const
+{
+	if (name.isEmpty())
+		return { _trains.begin(), _trains.end() };
+	return nameIndex.search(name);
+}
+
 void TrainCollection::clear(const TypeManager& defaultManager)
 {
 	_trains.clear();
 	_routings.clear();
 	fullNameMap.clear();
 	singleNameMap.clear();
+	nameIndex.clear();
+	_summary.clear();
+	rebuildTrainIndex();
 	_manager = defaultManager;
 	_manager.setTransparent(true);
 }
@@ -191,8 +218,11 @@ void TrainCollection::clear(const TypeManager& defaultManager)
 void TrainCollection::clearTrains()
 {
 	//这样操作是为了保证交路正确
-	while (!_trains.empty())
-		removeTrainAt(0);
+	QList<int> indexes;
+	indexes.reserve(_trains.size());
+	for (int i = 0; i < _trains.size(); i++)
+		indexes.append(i);
+	removeTrainsAt(indexes);
 }
 
 void TrainCollection::clearTrainsAndRoutings()
@@ -201,69 +231,128 @@ void TrainCollection::clearTrainsAndRoutings()
 	_routings.clear();
 	fullNameMap.clear();
 	singleNameMap.clear();
+	nameIndex.clear();
+	_summary.clear();
+	rebuildTrainIndex();
 }
 
 std::shared_ptr<Train> TrainCollection::takeTrainAt(int i)
 {
 	auto t = _trains.takeAt(i);
+	rebuildTrainIndex();
 	removeMapInfo(t);
-	if (t->hasRouting()) {
-		t->routingNode().value()->makeVirtual();
-	}
+	makeRoutingVirtual(t);
 	return t;
 }
 
 std::shared_ptr<Train> TrainCollection::takeLastTrain()
 {
 	auto t = _trains.takeLast();
+	_indexMap.erase(t.get());
 	removeMapInfo(t);
-	if (t->hasRouting()) {
-		t->routingNode().value()->makeVirtual();
-	}
+	makeRoutingVirtual(t);
 	return t;
 }
 
 void TrainCollection::removeTrainAt(int i)
 {
 	auto t = _trains.takeAt(i);
+	rebuildTrainIndex();
 	removeMapInfo(t);
-	if (t->hasRouting()) {
-		auto it = t->routingNode();
-		it.value()->makeVirtual();
-		it.reset();
-	}
+	makeRoutingVirtual(t);
 }
 
 void TrainCollection::insertTrainForUndo(int i, std::shared_ptr<Train> train)
 {
 	_trains.insert(i, train);
+	rebuildTrainIndex();
 	if (train->hasRouting()) {
 		train->routingNode().value()->setTrain(train);
 	}
 	addMapInfo(train);
 }
 
+QList<std::shared_ptr<Train>> TrainCollection::takeTrainsAt(const QList<int>& indexes)
+{
+	QList<std::shared_ptr<Train>> taken;
+	if (indexes.isEmpty())
+		return taken;
+	taken.reserve(indexes.size());
+	QList<std::shared_ptr<Train>> kept;
+	kept.reserve(_trains.size() - indexes.size());
+	auto idx = indexes.cbegin();
+	for (int i = 0; i < _trains.size(); i++) {
+		if (idx != indexes.cend() && *idx == i) {
+			taken.append(std::move(_trains[i]));
+			++idx;
+		}
+		else {
+			kept.append(std::move(_trains[i]));
+		}
+	}
+	_trains = std::move(kept);
+	rebuildTrainIndex();
+	for (const auto& t : taken) {
+		removeMapInfo(t);
+		makeRoutingVirtual(t);
+	}
+	return taken;
+}
+
+void TrainCollection::removeTrainsAt(const QList<int>& indexes)
+{
+	// 与takeTrainsAt()相同；被删除的车次由调用方丢弃
+	takeTrainsAt(indexes);
+}
+
+void TrainCollection::insertTrainsForUndo(const QList<int>& indexes,
+	const QList<std::shared_ptr<Train>>& trains)
+{
+	if (trains.isEmpty())
+		return;
+	const int n = _trains.size() + trains.size();
+	QList<std::shared_ptr<Train>> merged;
+	merged.reserve(n);
+	int j = 0, src = 0;
+	for (int pos = 0; pos < n; pos++) {
+		if (j < trains.size() && indexes.at(j) == pos) {
+			merged.append(trains.at(j++));
+		}
+		else {
+			merged.append(std::move(_trains[src++]));
+		}
+	}
+	_trains = std::move(merged);
+	rebuildTrainIndex();
+	for (const auto& train : trains) {
+		if (train->hasRouting()) {
+			train->routingNode().value()->setTrain(train);
+		}
+		addMapInfo(train);
+	}
+}
+
 void TrainCollection::removeUnboundTrains()
 {
-	//倒着遍历
-	for (int i = _trains.size() - 1; i >= 0; i--) {
-		auto t = _trains.at(i);
-		if (t->adapters().empty()) {
-			//删除  调用函数来正确处理交路
-			removeTrainAt(i);
+	QList<int> indexes;
+	for (int i = 0; i < _trains.size(); i++) {
+		if (_trains.at(i)->adapters().empty()) {
+			indexes.append(i);
 		}
 	}
+	//删除  调用函数来正确处理交路
+	removeTrainsAt(indexes);
 }
 
 void TrainCollection::removeNonLocal(const RailCategory& cat)
 {
-	//倒序遍历
-	for (int i = _trains.size() - 1; i >= 0; i--) {
-		auto t = _trains.at(i);
-		if (!t->isLocalTrain(cat)) {
-			removeTrainAt(i);
+	QList<int> indexes;
+	for (int i = 0; i < _trains.size(); i++) {
+		if (!_trains.at(i)->isLocalTrain(cat)) {
+			indexes.append(i);
 		}
 	}
+	removeTrainsAt(indexes);
 }
 
 bool TrainCollection::routingNameExisted(const QString& name,
@@ -296,11 +385,12 @@ std::shared_ptr<const Routing> TrainCollection::routingByName(const QString &nam
 
 int TrainCollection::getTrainIndex(std::shared_ptr<Train> train) const
 {
-	auto p = std::find(_trains.begin(), _trains.end(), train);
-	if (p == _trains.end())
-		return -1;
-	else
-        return std::distance(_trains.begin(), p);
+	if (auto p = _indexMap.find(train.get());
+		p != _indexMap.end() && p->second < _trains.size() && _trains.at(p->second) == train)
+		return p->second;
+	// 未命中或查找表过时（trains()被外部修改而未调用rebuildTrainIndex()，例如原位替换）：
+	// 退回顺序查找。此处不修改查找表，因此可以与其他只读操作并发调用
+	return _trains.indexOf(train);
 }
 
 int TrainCollection::getRoutingIndex(std::shared_ptr<const Routing> routing) const
@@ -349,6 +439,9 @@ void TrainCollection::updateTrainInfo(std::shared_ptr<Train> train, std::shared_
 	updateSingleNameMapItem(train, n1.full(), n2.full());
 	updateSingleNameMapItem(train, n1.down(), n2.down());
 	updateSingleNameMapItem(train, n1.up(), n2.up());
+	if (!(n1 == n2)) {
+		nameIndex.update(train);
+	}
 	//类型
 	if (train->type() != info->type()) {
 		--_typeCount[info->type()];
@@ -456,6 +549,8 @@ void TrainCollection::addMapInfo(const std::shared_ptr<Train>& t)
 	if (!n.up().isEmpty()) {
 		singleNameMap[n.up()].append(t);
 	}
+	nameIndex.insert(t);
+	_summary.insert(t);
 	if (!t->type()) {
 		t->setType(_manager.fromRegex(t->trainName()));
 	}
@@ -475,6 +570,8 @@ void TrainCollection::removeMapInfo(std::shared_ptr<Train> t)
 	if (!n.up().isEmpty()) {
 		singleNameMap[n.up()].removeAll(t);
 	}
+	nameIndex.remove(t);
+	_summary.remove(t.get());
 	--_typeCount[t->type()];
 }
 
@@ -492,10 +589,29 @@ void TrainCollection::updateSingleNameMapItem(std::shared_ptr<Train> train,
 }
 
 
+void TrainCollection::rebuildTrainIndex()
+{
+	_indexMap.clear();
+	_indexMap.reserve(_trains.size());
+	for (int i = 0; i < _trains.size(); i++) {
+		_indexMap.emplace(_trains.at(i).get(), i);
+	}
+}
+
+void TrainCollection::makeRoutingVirtual(const std::shared_ptr<Train>& t)
+{
+	if (t->hasRouting()) {
+		t->routingNode().value()->makeVirtual();
+	}
+}
+
 void TrainCollection::resetMapInfo()
 {
+	rebuildTrainIndex();
 	fullNameMap.clear();
 	singleNameMap.clear();
+	nameIndex.clear();
+	_summary.clear();
 	for (const auto& p : _trains) {
 		addMapInfo(p);
 	}
@@ -7,9 +7,12 @@
 #include <QMap>
 
 #include <deque>
+#include <unordered_map>
 
 #include "data/train/typemanager.h"
 #include "data/diagram/diadiff.h"
+#include "trainnameindex.h"
+#include "trainsummarytable.h"
 #include "predeftrainfiltercore.h"   // not sure: is this neccesary?
 
 //class PredefTrainFilterCore;
@@ -45,6 +48,23 @@ class TrainCollection
     QHash<QString, std::shared_ptr<Train>> fullNameMap;
     QHash<QString, QList<std::shared_ptr<Train>>> singleNameMap;
 
+    /**
+     * 2026.10.19  车次模糊查找索引，与上面两个查找表同步维护
+     */
+    TrainNameIndex nameIndex;
+
+    /**
+     * 2026.10.19  列车概要数据的列式缓存，与上面的查找表同步增删行
+     */
+    TrainSummaryTable _summary;
+
+    /**
+     * 2026.10.19  列车->下标的查找表。本类内部的增删操作负责维护或重建此表，
+     * getTrainIndex()只读不写。由于trains()对外开放修改（例如排序），
+     * 查找时总是校验结果，校验失败则退回顺序查找，因此外部修改后未调用rebuildTrainIndex()也不会出错，只是变慢。
+     */
+    std::unordered_map<const Train*, int> _indexMap;
+
     TypeManager _manager;
     QMap<std::shared_ptr<TrainType>, int> _typeCount;
 
@@ -93,6 +113,11 @@ public:
 #endif
     auto& filters(){return _filters;}
 
+    /**
+     * 2026.10.19  列车概要数据的列式缓存，用于列车表的排序、显示和批量筛选。使用前须refresh()。
+     */
+    auto& summaryTable() { return _summary; }
+
     /**
      * @brief appendTrain 添加车次
      * 同时更新查找表。如果车次冲突，引起未定义行为
@@ -143,10 +168,18 @@ public:
     /**
      * pyETRC.Graph.multiSearch()  模糊查找车次
      * 全车次或分方向车次包含目标串即可
+     * 2026.10.19: 通过nameIndex查找候选，结果仍按列车表的顺序排列
      */
     QList<std::shared_ptr<Train>>
         multiSearchTrain(const QString& name);
 
+    /**
+     * 2026.10.19  模糊查找车次，但不排序（按索引中的任意顺序）。
+     * 用于只需要判断是否匹配的场合，例如列车表的筛选。
+     */
+    std::vector<std::shared_ptr<Train>>
+        multiSearchTrainUnordered(const QString& name)const;
+
     auto& typeManager() { return _manager; }
     const auto& typeManager()const { return _manager; }
 
@@ -195,6 +228,24 @@ public:
      */
     void insertTrainForUndo(int i, std::shared_ptr<Train> train);
 
+    /**
+     * 2026.10.19  批量版本的takeTrainAt()。indexes须升序且不重复。
+     * 一次性压缩列车表，线性复杂度；返回按indexes顺序被删除的车次。
+     */
+    QList<std::shared_ptr<Train>> takeTrainsAt(const QList<int>& indexes);
+
+    /**
+     * 2026.10.19  批量版本的removeTrainAt()，不考虑撤销。indexes须升序且不重复。
+     */
+    void removeTrainsAt(const QList<int>& indexes);
+
+    /**
+     * 2026.10.19  批量版本的insertTrainForUndo()，是takeTrainsAt()的逆操作。
+     * indexes为插入后各车次的下标，须升序，与trains一一对应。一次性归并，线性复杂度。
+     */
+    void insertTrainsForUndo(const QList<int>& indexes,
+        const QList<std::shared_ptr<Train>>& trains);
+
     /**
      * 删除所有没有绑定到线路的车次。
      * 注意只能在绑定操作执行之后，否则相当于清空。
@@ -221,10 +272,16 @@ public:
 
     /**
      * 返回指定列车下标；如果找不到，返回-1.
-     * 线性查找
+     * 2026.10.19: 通过_indexMap查找，常数时间；查找表过时的退回顺序查找。
+     * 不修改任何数据，可以在多个线程中同时调用。
      */
     int getTrainIndex(std::shared_ptr<Train> train)const;
 
+    /**
+     * 2026.10.19  在外部直接修改trains()的顺序（例如排序）之后调用。
+     */
+    void rebuildTrainIndex();
+
     /**
      * 指定交路的序号，线性查找
      */
@@ -308,6 +365,11 @@ private:
      * @brief resetMapInfo 重置所有映射表信息
      */
     void resetMapInfo();
+
+    /**
+     * 删除车次后，处理交路信息：交路中对应结点设为虚拟。
+     */
+    static void makeRoutingVirtual(const std::shared_ptr<Train>& t);
 };
 
 
@@ -3,6 +3,8 @@
 #include "traintype.h"
 #include "routing.h"
 #include "train.h"
+#include "traincollection.h"
+#include "trainsummarytable.h"
 
 
 bool TrainFilterCore::checkType(std::shared_ptr<const Train> train) const
@@ -11,28 +13,27 @@ bool TrainFilterCore::checkType(std::shared_ptr<const Train> train) const
     return types.contains(train->type());
 }
 
-bool TrainFilterCore::checkInclude(std::shared_ptr<const Train> train) const
+bool TrainFilterCore::matchName(const QVector<QRegularExpression>& regs, const TrainName& n,
+    const QString& full)
 {
-    if (!useInclude) return false;   // 这个特殊
-    foreach (auto& p, includes){
-        const auto& n=train->trainName();
-        if (p.match(n.full()).hasMatch() || p.match(n.down()).hasMatch() || p.match(n.up()).hasMatch()){
+    foreach (auto& p, regs){
+        if (p.match(full).hasMatch() || p.match(n.down()).hasMatch() || p.match(n.up()).hasMatch()){
             return true;
         }
     }
     return false;
 }
 
+bool TrainFilterCore::checkInclude(std::shared_ptr<const Train> train) const
+{
+    if (!useInclude) return false;   // 这个特殊
+    return matchName(includes, train->trainName(), train->trainName().full());
+}
+
 bool TrainFilterCore::checkExclude(std::shared_ptr<const Train> train) const
 {
     if(!useExclude) return false;
-    foreach (auto& p, excludes){
-        const auto& n=train->trainName();
-        if (p.match(n.full()).hasMatch() || p.match(n.down()).hasMatch() || p.match(n.up()).hasMatch()) {
-            return true;
-        }
-    }
-    return false;
+    return matchName(excludes, train->trainName(), train->trainName().full());
 }
 
 bool TrainFilterCore::checkRouting(std::shared_ptr<const Train> train) const
@@ -97,3 +98,39 @@ bool TrainFilterCore::check(std::shared_ptr<const Train> train) const
     if (useInverse)return !res;
     return res;
 }
+
+bool TrainFilterCore::checkRow(const TrainSummaryTable& table, int row) const
+{
+    const auto flags = table.flags()[row];
+    bool passenger;
+    switch (passengerType)
+    {
+    case TrainPassenger::False: passenger = !(flags & TrainSummaryTable::FlagPassenger); break;
+    case TrainPassenger::Auto: passenger = true; break;
+    case TrainPassenger::True: passenger = (flags & TrainSummaryTable::FlagPassenger); break;
+    default: passenger = false; break;
+    }
+    // 先判断表中的列，不通过时不再访问Train
+    const bool byColumns = passenger && (!showOnly || (flags & TrainSummaryTable::FlagShow));
+    const auto& train = table.trains()[row];
+    const QString& full = table.names()[row];
+    bool res = (byColumns && checkType(train) && checkRouting(train)
+        && checkStarting(train) && checkTerminal(train)
+        && !(useExclude && matchName(excludes, train->trainName(), full)))
+        || (useInclude && matchName(includes, train->trainName(), full));
+    if (useInverse)return !res;
+    return res;
+}
+
+std::vector<bool> TrainFilterCore::checkAll(TrainCollection& coll) const
+{
+    auto& table = coll.summaryTable();
+    table.refresh(false);
+    std::vector<bool> res;
+    res.reserve(coll.size());
+    for (const auto& train : coll.trains()) {
+        int row = table.rowOf(train.get());
+        res.push_back(row >= 0 ? checkRow(table, row) : check(train));
+    }
+    return res;
+}
@@ -1,6 +1,7 @@
 ﻿#pragma once
 
 #include <memory>
+#include <vector>
 #include <QVector>
 #include <QSet>
 #include <QJsonObject>
@@ -13,6 +14,9 @@ class TrainType;
 
 class TrainFilter;
 class Diagram;
+class TrainCollection;
+class TrainSummaryTable;
+class TrainName;
 
 /**
  * 列车筛选器中，不带任何图形界面和SIGLAL/SLOT的数据部分。
@@ -53,7 +57,22 @@ public:
     TrainFilterCore& operator=(TrainFilterCore&&) = default;
 
     bool check(std::shared_ptr<const Train> train)const override;
+
+    /**
+     * 2026.10.19  批量筛选coll中的全部车次，结果与coll.trains()的顺序一致，与逐个check()相同。
+     * 先refresh(false)列车概要表（TrainSummaryTable），显示、客车标志和全车次直接读表中的列，
+     * 按列判断不通过的车次不再访问Train；其余条件仍读Train。
+     */
+    std::vector<bool> checkAll(TrainCollection& coll)const;
 private:
+    /**
+     * 概要表第row行的筛选结果。表须已经refresh()。
+     */
+    bool checkRow(const TrainSummaryTable& table, int row)const;
+
+    static bool matchName(const QVector<QRegularExpression>& regs, const TrainName& name,
+        const QString& full);
+
     bool checkType(std::shared_ptr<const Train> train)const;
     bool checkInclude(std::shared_ptr<const Train> train)const;
     bool checkExclude(std::shared_ptr<const Train> train)const;
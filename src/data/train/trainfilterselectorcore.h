@@ -11,9 +11,14 @@ class TrainFilterCore;
 class TrainFilterSelectorCore
 {
     friend class TrainFilterSelector;
-    const  TrainFilterCore* _core;
+    const  TrainFilterCore* _core = nullptr;
 public:
     TrainFilterSelectorCore()=default;
+
+    /**
+     * 2026.10.19  直接包装一个给定的筛选器，用于没有界面的场合（例如测速程序）
+     */
+    explicit TrainFilterSelectorCore(const TrainFilterCore* core): _core(core) {}
     auto* filter()const{return _core;}
 };
 
@@ -0,0 +1,99 @@
+#include "trainnameindex.h"
+#include "train.h"
+
+#include <algorithm>
+
+void TrainNameIndex::insert(const std::shared_ptr<Train>& train)
+{
+    remove(train);
+    auto& grams = _trainGrams[train];
+    const TrainName& n = train->trainName();
+    collectGrams(n.full(), grams);
+    collectGrams(n.down(), grams);
+    collectGrams(n.up(), grams);
+    std::sort(grams.begin(), grams.end());
+    grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+    for (auto g : grams) {
+        _postings[g].insert(train);
+    }
+}
+
+void TrainNameIndex::remove(const std::shared_ptr<Train>& train)
+{
+    auto itr = _trainGrams.find(train);
+    if (itr == _trainGrams.end())
+        return;
+    for (auto g : itr->second) {
+        if (auto p = _postings.find(g); p != _postings.end()) {
+            p->second.erase(train);
+            if (p->second.empty())
+                _postings.erase(p);
+        }
+    }
+    _trainGrams.erase(itr);
+}
+
+void TrainNameIndex::update(const std::shared_ptr<Train>& train)
+{
+    insert(train);
+}
+
+void TrainNameIndex::clear()
+{
+    _postings.clear();
+    _trainGrams.clear();
+}
+
+std::vector<std::shared_ptr<Train>> TrainNameIndex::search(const QString& name) const
+{
+    std::vector<std::shared_ptr<Train>> res{};
+    if (name.isEmpty())
+        return res;
+
+    std::vector<gram_t> grams;
+    if (name.size() == 1) {
+        grams.push_back(unigram(name.at(0)));
+    }
+    else {
+        for (int i = 0; i + 1 < name.size(); i++) {
+            grams.push_back(bigram(name.at(i), name.at(i + 1)));
+        }
+    }
+
+    // 取最短的倒排表作为候选；任一gram不存在则一定无结果
+    const TrainSet* cand = nullptr;
+    for (auto g : grams) {
+        auto p = _postings.find(g);
+        if (p == _postings.end())
+            return res;
+        if (!cand || p->second.size() < cand->size())
+            cand = &p->second;
+    }
+
+    for (const auto& t : *cand) {
+        if (name.size() <= 2 || t->trainName().contains(name))
+            res.push_back(t);
+    }
+    return res;
+}
+
+void TrainNameIndex::collectGrams(const QString& s, std::vector<gram_t>& grams)
+{
+    for (int i = 0; i < s.size(); i++) {
+        grams.push_back(unigram(s.at(i)));
+        if (i + 1 < s.size()) {
+            grams.push_back(bigram(s.at(i), s.at(i + 1)));
+        }
+    }
+}
+
+TrainNameIndex::gram_t TrainNameIndex::unigram(QChar c)
+{
+    // 高位标记，与bigram区分
+    return (gram_t(1) << 32) | c.unicode();
+}
+
+TrainNameIndex::gram_t TrainNameIndex::bigram(QChar c1, QChar c2)
+{
+    return (gram_t(c1.unicode()) << 16) | c2.unicode();
+}
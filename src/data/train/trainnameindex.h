@@ -0,0 +1,66 @@
+﻿#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <QString>
+
+class Train;
+class TrainName;
+
+/**
+ * @brief The TrainNameIndex class
+ * 2026.10.19  车次模糊查找的索引（TrainName::contains的加速）。
+ * 对全车次、下行车次、上行车次的所有单字和相邻二字（bigram）建立倒排表。
+ * 查找时取查询串中倒排表最短的那个gram，只对其中的车次做精确的contains判定，
+ * 因此结果与线性扫描完全一致。
+ * 由TrainCollection的映射表维护函数同步更新，不单独使用。
+ * 每个车次记录其注册过的gram，以便车次改名或删除时不依赖旧的车次信息。
+ */
+class TrainNameIndex
+{
+public:
+    using gram_t = quint64;
+
+private:
+    using TrainSet = std::unordered_set<std::shared_ptr<Train>>;
+    std::unordered_map<gram_t, TrainSet> _postings;
+    std::unordered_map<std::shared_ptr<Train>, std::vector<gram_t>> _trainGrams;
+
+public:
+    TrainNameIndex() = default;
+
+    /**
+     * 添加车次。如果已经存在，先删除旧的信息。
+     */
+    void insert(const std::shared_ptr<Train>& train);
+
+    /**
+     * 删除车次。如果不存在，不做任何事。
+     */
+    void remove(const std::shared_ptr<Train>& train);
+
+    /**
+     * 车次名称修改后调用，按当前名称重新建立索引。
+     */
+    void update(const std::shared_ptr<Train>& train);
+
+    void clear();
+
+    auto size()const { return _trainGrams.size(); }
+
+    /**
+     * 所有全车次或分方向车次包含name的车次，无序。
+     * name为空时返回空集合（由调用方处理“全部”的语义）。
+     */
+    std::vector<std::shared_ptr<Train>> search(const QString& name)const;
+
+private:
+    static void collectGrams(const QString& s, std::vector<gram_t>& grams);
+
+    static gram_t unigram(QChar c);
+
+    static gram_t bigram(QChar c1, QChar c2);
+};
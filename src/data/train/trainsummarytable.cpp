@@ -0,0 +1,212 @@
+#include "trainsummarytable.h"
+#include "train.h"
+#include "traintype.h"
+
+#include <algorithm>
+#include <numeric>
+
+void TrainSummaryTable::insert(const std::shared_ptr<Train>& train)
+{
+    if (auto itr = _rowOf.find(train.get()); itr != _rowOf.end()) {
+        _statValid[itr->second] = false;
+        return;
+    }
+    _rowOf.emplace(train.get(), size());
+    _trains.push_back(train);
+    _names.emplace_back();
+    _typeIds.push_back(0);
+    _flags.push_back(0);
+    _miles.push_back(0);
+    _travSpeeds.push_back(0);
+    _techSpeeds.push_back(0);
+    _runSecs.push_back(0);
+    _staySecs.push_back(0);
+    _versions.push_back(0);
+    _statValid.push_back(false);
+}
+
+void TrainSummaryTable::remove(const Train* train)
+{
+    auto itr = _rowOf.find(train);
+    if (itr == _rowOf.end())
+        return;
+    const int row = itr->second, last = size() - 1;
+    _rowOf.erase(itr);
+    if (row != last) {
+        _trains[row] = std::move(_trains[last]);
+        _names[row] = std::move(_names[last]);
+        _typeIds[row] = _typeIds[last];
+        _flags[row] = _flags[last];
+        _miles[row] = _miles[last];
+        _travSpeeds[row] = _travSpeeds[last];
+        _techSpeeds[row] = _techSpeeds[last];
+        _runSecs[row] = _runSecs[last];
+        _staySecs[row] = _staySecs[last];
+        _versions[row] = _versions[last];
+        _statValid[row] = _statValid[last];
+        _rowOf[_trains[row].get()] = row;
+    }
+    _trains.pop_back();
+    _names.pop_back();
+    _typeIds.pop_back();
+    _flags.pop_back();
+    _miles.pop_back();
+    _travSpeeds.pop_back();
+    _techSpeeds.pop_back();
+    _runSecs.pop_back();
+    _staySecs.pop_back();
+    _versions.pop_back();
+    _statValid.pop_back();
+}
+
+void TrainSummaryTable::clear()
+{
+    _trains.clear();
+    _names.clear();
+    _typeIds.clear();
+    _flags.clear();
+    _miles.clear();
+    _travSpeeds.clear();
+    _techSpeeds.clear();
+    _runSecs.clear();
+    _staySecs.clear();
+    _versions.clear();
+    _statValid.clear();
+    _rowOf.clear();
+}
+
+int TrainSummaryTable::rowOf(const Train* train) const
+{
+    auto itr = _rowOf.find(train);
+    return itr == _rowOf.end() ? -1 : itr->second;
+}
+
+void TrainSummaryTable::refresh(bool withStats)
+{
+    const int n = size();
+    for (int r = 0; r < n; r++) {
+        auto& t = _trains[r];
+        _names[r] = t->trainName().full();
+        std::uint8_t f = 0;
+        if (t->isShow()) f |= FlagShow;
+        if (!t->adapters().isEmpty()) f |= FlagBound;
+        if (t->getIsPassenger()) f |= FlagPassenger;
+        _flags[r] = f;
+
+        if (withStats)
+            refreshStats(r);
+    }
+    refreshTypeIds();
+}
+
+void TrainSummaryTable::refreshStats(int r)
+{
+    auto& t = _trains[r];
+    if (!_statValid[r] || _versions[r] != t->tempVersion()) {
+        _miles[r] = t->localMile();
+        auto rs = t->localRunStaySecs();
+        _runSecs[r] = rs.first;
+        _staySecs[r] = rs.second;
+        _travSpeeds[r] = t->localTraverseSpeed();
+        _techSpeeds[r] = t->localTechSpeed();
+        _versions[r] = t->tempVersion();
+        _statValid[r] = true;
+    }
+}
+
+int TrainSummaryTable::statRow(const std::shared_ptr<Train>& train)
+{
+    int r = rowOf(train.get());
+    if (r < 0) {
+        insert(train);
+        r = size() - 1;
+    }
+    refreshStats(r);
+    return r;
+}
+
+void TrainSummaryTable::refreshTypeIds()
+{
+    // 类型数量很少：先收集不重复的类型，按名称排序后得到名次
+    std::unordered_map<const TrainType*, int> ids;
+    std::vector<const TrainType*> types;
+    for (const auto& t : _trains) {
+        const TrainType* tp = t->type().get();
+        if (ids.emplace(tp, 0).second)
+            types.push_back(tp);
+    }
+    std::sort(types.begin(), types.end(), [](const TrainType* a, const TrainType* b) {
+        return a->name() < b->name();
+        });
+    int id = -1;
+    for (size_t i = 0; i < types.size(); i++) {
+        if (i == 0 || types[i - 1]->name() != types[i]->name())
+            id++;
+        ids[types[i]] = id;
+    }
+    for (int r = 0; r < size(); r++) {
+        _typeIds[r] = ids.at(_trains[r]->type().get());
+    }
+}
+
+namespace {
+    template <typename T>
+    void sortByColumn(std::vector<int>& perm, const std::vector<int>& rows,
+        const std::vector<T>& column, bool descending)
+    {
+        // 先按列表顺序取出连续的键，再排序
+        std::vector<T> keys;
+        keys.reserve(rows.size());
+        for (int r : rows)
+            keys.push_back(column[r]);
+        if (descending) {
+            std::stable_sort(perm.begin(), perm.end(), [&keys](int a, int b) {
+                return keys[a] > keys[b];
+                });
+        }
+        else {
+            std::stable_sort(perm.begin(), perm.end(), [&keys](int a, int b) {
+                return keys[a] < keys[b];
+                });
+        }
+    }
+}
+
+void TrainSummaryTable::sortTrains(QList<std::shared_ptr<Train>>& lst, Key key, bool descending)
+{
+    for (const auto& t : lst) {
+        if (!_rowOf.count(t.get()))
+            insert(t);
+    }
+    refresh();
+
+    std::vector<int> rows;
+    rows.reserve(lst.size());
+    for (const auto& t : lst)
+        rows.push_back(_rowOf.at(t.get()));
+    std::vector<int> perm(rows.size());
+    std::iota(perm.begin(), perm.end(), 0);
+
+    switch (key) {
+    case Key::Name: sortByColumn(perm, rows, _names, descending); break;
+    case Key::Type: sortByColumn(perm, rows, _typeIds, descending); break;
+    case Key::Show: {
+        std::vector<int> shows(_flags.size());
+        for (size_t r = 0; r < _flags.size(); r++)
+            shows[r] = (_flags[r] & FlagShow) ? 1 : 0;
+        sortByColumn(perm, rows, shows, descending);
+        break;
+    }
+    case Key::Mile: sortByColumn(perm, rows, _miles, descending); break;
+    case Key::TravSpeed: sortByColumn(perm, rows, _travSpeeds, descending); break;
+    case Key::TechSpeed: sortByColumn(perm, rows, _techSpeeds, descending); break;
+    case Key::RunSecs: sortByColumn(perm, rows, _runSecs, descending); break;
+    case Key::StaySecs: sortByColumn(perm, rows, _staySecs, descending); break;
+    }
+
+    QList<std::shared_ptr<Train>> res;
+    res.reserve(lst.size());
+    for (int p : perm)
+        res.push_back(lst.at(p));
+    std::swap(lst, res);
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <QList>
+#include <QString>
+
+class Train;
+
+/**
+ * @brief The TrainSummaryTable class
+ * 2026.10.19  列车概要数据的列式缓存，每个车次一行。
+ * 列：全车次、类型序号、显示等标志、本线里程、运行/停站秒数、旅速、技速，各列连续存放。
+ * 排序、筛选、统计时直接读连续的列，而不是在每次比较中经shared_ptr调用Train的接口、
+ * 检查并可能重新计算_locMile等临时数据。
+ * 使用者：TrainListModel（排序，里程、旅速、技速列），TrainFilterCore::checkAll()（批量筛选）。
+ *
+ * 行的增删由TrainCollection的映射表维护函数同步进行（与TrainNameIndex相同）。
+ * 里程和时分按行记录Train::tempVersion()，refresh()时只重新计算版本已变的行；
+ * 车次、类型、显示标志读取代价很小，refresh()时总是重新读取，因此不依赖各处修改接口的通知。
+ * 类型序号为refresh()时所有类型按名称排序的名次，同名类型序号相同，可直接比较。
+ */
+class TrainSummaryTable
+{
+public:
+    enum Flag : std::uint8_t {
+        FlagShow = 0x01,   // Train::isShow()
+        FlagBound = 0x02,  // 至少绑定到一条线路
+        FlagPassenger = 0x04,   // Train::getIsPassenger()
+    };
+
+    enum class Key {
+        Name,
+        Type,
+        Show,
+        Mile,
+        TravSpeed,
+        TechSpeed,
+        RunSecs,
+        StaySecs,
+    };
+
+private:
+    std::vector<std::shared_ptr<Train>> _trains;
+    std::vector<QString> _names;
+    std::vector<int> _typeIds;
+    std::vector<std::uint8_t> _flags;
+    std::vector<double> _miles, _travSpeeds, _techSpeeds;
+    std::vector<int> _runSecs, _staySecs;
+
+    /**
+     * 计算里程等数据时Train::tempVersion()的值；_statValid为false表示尚未计算
+     */
+    std::vector<unsigned> _versions;
+    std::vector<bool> _statValid;
+
+    std::unordered_map<const Train*, int> _rowOf;
+
+public:
+    TrainSummaryTable() = default;
+
+    /**
+     * 添加车次。已存在的，只将其数据标记为过期。
+     */
+    void insert(const std::shared_ptr<Train>& train);
+
+    /**
+     * 删除车次（与最后一行交换后删除）。不存在的，不做任何事。
+     */
+    void remove(const Train* train);
+
+    void clear();
+
+    int size()const { return static_cast<int>(_trains.size()); }
+
+    /**
+     * 车次所在的行，不存在返回-1。注意行号与列车表的顺序无关。
+     */
+    int rowOf(const Train* train)const;
+
+    /**
+     * 更新所有行：重新读取车次、类型、标志，重新计算版本已变的里程、时分数据。
+     * withStats为false时不计算里程、时分（筛选只用到车次、标志），这些列保持原状。
+     */
+    void refresh(bool withStats = true);
+
+    /**
+     * 车次所在的行，并保证这一行的里程、时分为最新（只检查这一行的版本）。
+     * 不在表中的先添加。用于逐行显示，不必每次refresh()整个表。
+     */
+    int statRow(const std::shared_ptr<Train>& train);
+
+    /**
+     * 按key对lst做稳定排序，与Train::ltXXX/gtXXX系列比较函数的结果一致。
+     * lst中不在本表中的车次先补充进来。
+     */
+    void sortTrains(QList<std::shared_ptr<Train>>& lst, Key key, bool descending);
+
+    /**
+     * 以下各列按行号访问，须先refresh()
+     */
+    const auto& trains()const { return _trains; }
+    const auto& names()const { return _names; }
+    const auto& typeIds()const { return _typeIds; }
+    const auto& flags()const { return _flags; }
+    const auto& miles()const { return _miles; }
+    const auto& runSecs()const { return _runSecs; }
+    const auto& staySecs()const { return _staySecs; }
+    const auto& travSpeeds()const { return _travSpeeds; }
+    const auto& techSpeeds()const { return _techSpeeds; }
+
+private:
+    void refreshTypeIds();
+
+    /**
+     * 版本已变（或尚未计算）时重新计算第r行的里程、时分
+     */
+    void refreshStats(int r);
+};
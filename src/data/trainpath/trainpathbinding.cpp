@@ -0,0 +1,92 @@
+#include "trainpathbinding.h"
+#include <unordered_map>
+
+#include "trainpath.h"
+#include "data/rail/railway.h"
+#include "data/rail/railstation.h"
+#include "data/train/train.h"
+#include "data/diagram/trainadapter.h"
+#include "log/IssueManager.h"
+#include "util/qeparallel.hpp"
+
+std::shared_ptr<RailStation> TrainPathBinding::Segment::stationByGeneralName(const StationName& name, int& pos) const
+{
+	// The rule of Railway::stationByGeneralName: exact match first, then the bare station
+	// (the field of the bare one contains any field).
+	auto itr = stations.find(name);
+	if (itr == stations.end() && !name.isBare()) {
+		itr = stations.find(StationName(name.station(), QString()));
+	}
+	if (itr == stations.end()) {
+		return nullptr;
+	}
+	pos = itr->second;
+	return itr->first;
+}
+
+TrainPathBinding::TrainPathBinding(const TrainPath* path) :
+	_path(path), _valid(path->valid())
+{
+	if (!_valid)
+		return;
+	_segments.reserve(path->segments().size());
+	StationName start_station = path->startStation();
+	for (const auto& seg : path->segments()) {
+		auto& res = _segments.emplace_back();
+		res.railway = seg.railway.lock();
+		res.dir = seg.dir;
+		res.end_station = seg.end_station;
+
+		auto rst_start = res.railway->stationByName(start_station);
+		auto rst_end = res.railway->stationByName(seg.end_station);
+		const double mile_start = rst_start->mile, mile_end = rst_end->mile;
+		res.stations.reserve(res.railway->stations().size());
+		for (const auto& rst : res.railway->stations()) {
+			res.stations.insert(rst->name, std::make_pair(rst,
+				TrainAdapter::stationInSegment(mile_start, mile_end, seg.dir, *rst)));
+		}
+		start_station = seg.end_station;
+	}
+}
+
+void TrainPathBinding::bindTrains(const std::vector<std::shared_ptr<Train>>& trains)
+{
+	// resolve each path once
+	std::vector<const TrainPath*> paths;
+	std::unordered_map<const TrainPath*, int> path_index;
+	for (const auto& train : trains) {
+		for (auto* p : train->paths()) {
+			if (path_index.emplace(p, static_cast<int>(paths.size())).second) {
+				paths.push_back(p);
+			}
+		}
+	}
+	std::vector<std::unique_ptr<TrainPathBinding>> bindings(paths.size());
+	qeutil::parallelFor(static_cast<int>(paths.size()), [&](int i) {
+		bindings[i] = std::make_unique<TrainPathBinding>(paths[i]);
+		});
+
+	// IssueManager is not thread-safe: report the issues here, in the same order as Train::bindWithPath()
+	for (const auto& train : trains) {
+		IssueManager::get()->clearIssuesForTrain(train.get());
+		for (auto* p : train->paths()) {
+			if (!p->valid()) {
+				qeIssueCritical(IssueInfo(IssueInfo::InvalidPath, train, {}, {}, QObject::tr("列车径路%1不可用，"
+					"此径路将被忽略").arg(p->name())));
+			}
+		}
+	}
+
+	// each thread writes only the adapters of its own trains
+	qeutil::parallelFor(static_cast<int>(trains.size()), [&](int i) {
+		const auto& train = trains[i];
+		train->adapters().clear();
+		for (auto* p : train->paths()) {
+			const auto& binding = *bindings[path_index.at(p)];
+			if (binding.valid()) {
+				TrainAdapter::bindTrainByPath(train, binding);
+			}
+		}
+		train->invalidateTempData();
+		}, 16);
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <memory>
+#include <utility>
+#include <vector>
+#include <QHash>
+
+#include "data/common/stationname.h"
+#include "data/common/direction.h"
+
+class Railway;
+class RailStation;
+class Train;
+class TrainPath;
+
+/**
+ * 2026.10.19  The pre-resolved form of a TrainPath, used for binding trains.
+ * Each TrainPathSeg is resolved once: the railway is locked, and every station of the railway
+ * is given its position relative to the mile range of the segment (before / inside / after).
+ * The binding of a train is then a sequence of hash lookups only, and one object is shared
+ * (read-only) by all the trains on the path, so that these trains can be bound in parallel.
+ * The object refers to the railways at construction time; do not keep it after railway changes.
+ */
+class TrainPathBinding {
+public:
+	struct Segment {
+		std::shared_ptr<Railway> railway;
+		Direction dir;
+		StationName end_station;
+
+		/**
+		 * Railway station and its position relative to the segment:
+		 * -1 before the range, 0 inside, 1 after the range.
+		 * Same as TrainAdapter::stationInSegment().
+		 */
+		QHash<StationName, std::pair<std::shared_ptr<RailStation>, int>> stations;
+
+		/**
+		 * Same as Railway::stationByGeneralName(), with the position written to pos.
+		 * Returns nullptr if not found.
+		 */
+		std::shared_ptr<RailStation> stationByGeneralName(const StationName& name, int& pos)const;
+	};
+
+private:
+	const TrainPath* _path;
+	bool _valid;
+	std::vector<Segment> _segments;
+
+public:
+	explicit TrainPathBinding(const TrainPath* path);
+
+	const TrainPath* path()const { return _path; }
+	bool valid()const { return _valid; }
+	const auto& segments()const { return _segments; }
+
+	/**
+	 * Rebind all the given trains with their paths (equivalent to Train::bindWithPath() for each).
+	 * Each distinct path is resolved once; the issues are reported serially, and then the trains
+	 * are bound in parallel. The trains should all be path-directed, and distinct.
+	 */
+	static void bindTrains(const std::vector<std::shared_ptr<Train>>& trains);
+};
@@ -140,13 +140,13 @@ void ChangeStationNameData::commit()
 void qecmd::ChangeStationNameGlobal::undo()
 {
     data.commit();
-    mw->refreshAll();
+    mw->commitChangeStationName(data);
 }
 
 void qecmd::ChangeStationNameGlobal::redo()
 {
     data.commit();
-    mw->refreshAll();
+    mw->commitChangeStationName(data);
 }
 
 #endif
@@ -4,6 +4,7 @@
 #include "util/utilfunc.h"
 #include "data/train/routing.h"
 #include "data/diagram/diagram.h"
+#include "data/diagram/diagramworkspace.h"
 #include "data/train/train.h"
 
 #include <QCheckBox>
@@ -94,8 +95,19 @@ void ImportTrainDialog::actView()
     );
 	if (filename.isEmpty())
 		return;
-	bool flag=other.fromJson(filename, diagram.trainCollection().typeManager());
-	if (!flag || other.isNull()) {
+	// 2026.10.19: 经由DiagramWorkspace读取（同一文件不重复解析，亦可读入trc、二进制格式）。
+	// 工作区中的运行图只读，而导入时车次对象将移交给本运行图，因此由其数据另建车次表。
+	// 只需车次表本身（车次、交路、筛选器）和类型设置，不必序列化线路等其他数据
+	auto dia = DiagramWorkspace::get()->open(filename);
+	if (dia) {
+		const auto& coll = dia->trainCollection();
+		QJsonObject obj = coll.toJson();
+		QJsonObject objconfig;
+		coll.typeManager().toJson(objconfig);
+		obj.insert("config", objconfig);
+		other.fromJson(obj, diagram.trainCollection().typeManager());
+	}
+	if (!dia || other.isNull()) {
 		QMessageBox::warning(this, tr("错误"), tr("文件错误或为空，请检查！"));
 		return;
 	}
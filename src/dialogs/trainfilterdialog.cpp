@@ -27,9 +27,10 @@ bool TrainFilterDialog::check(std::shared_ptr<const Train> train) const
 QList<std::shared_ptr<Train> > TrainFilterDialog::selectedTrains() const
 {
     QList<std::shared_ptr<Train>> res;
-    foreach(auto train, coll.trains()) {
-        if (check(train))
-            res.push_back(train);
+    const auto& sel = core.checkAll(coll);
+    for (int i = 0; i < coll.trains().size(); i++) {
+        if (sel[i])
+            res.push_back(coll.trains().at(i));
     }
     return res;
 }
@@ -27,7 +27,7 @@ public:
 
     /**
      * 返回当前筛选器状态下，被选中的车次列表。
-     * 线性算法，暂时不引入缓存机制。
+     * 2026.10.19  经TrainFilterCore::checkAll()按列车概要表批量筛选。
      */
     QList<std::shared_ptr<Train>> selectedTrains()const;
 
@@ -2,6 +2,7 @@
 
 #include <QWidget>
 #include <QUndoCommand>
+#include "data/diagram/diagramjournal.h"
 
 #include "model/train/routingcollectionmodel.h"
 
@@ -92,7 +93,7 @@ namespace qecmd {
      * 添加交路：要求能处理空的和非空的。
      * 实际的操作由RoutingWidget去完成；然后用SIGNAL通告重新铺画等操作。
      */
-    class AddRouting :public QUndoCommand {
+    class AddRouting :public QUndoCommand, public JournaledCommand {
         std::shared_ptr<Routing> routing;
         RoutingWidget*const rw;
     public:
@@ -100,9 +101,10 @@ namespace qecmd {
             QUndoCommand* parent = nullptr);
         virtual void undo()override;
         virtual void redo()override;
+        virtual void journalTouched(JournalTouch& touch)const override { touch.routings.push_back(routing); }
     };
 
-    class BatchAddRoutings :public QUndoCommand {
+    class BatchAddRoutings :public QUndoCommand, public JournaledCommand {
         QList<std::shared_ptr<Routing>> routings;
         RoutingWidget* const rw;
     public:
@@ -110,9 +112,12 @@ namespace qecmd {
             RoutingWidget* rw, QUndoCommand* parent = nullptr);
         virtual void undo()override;
         virtual void redo()override;
+        virtual void journalTouched(JournalTouch& touch)const override {
+            touch.routings.insert(touch.routings.end(), routings.begin(), routings.end());
+        }
     };
 
-    class RemoveRouting :public QUndoCommand {
+    class RemoveRouting :public QUndoCommand, public JournaledCommand {
         int row;
         std::shared_ptr<Routing> routing;
         RoutingWidget* const rw;
@@ -121,5 +126,6 @@ namespace qecmd {
             QUndoCommand* parent = nullptr);
         virtual void undo()override;
         virtual void redo()override;
+        virtual void journalTouched(JournalTouch& touch)const override { touch.routings.push_back(routing); }
     };
 }
\ No newline at end of file
@@ -127,6 +127,18 @@ void SystemJsonDialog::initUI()
     ckTransparentConfig->setToolTip(tr("对新创建的运行图的显示设置、类型管理默认使用透明模式。"));
     flay->addRow(tr("透明设置"), ckTransparentConfig);
 
+    ckJournal = new QCheckBox(tr("启用"));
+    ckJournal->setToolTip(tr("将未保存的修改记录到运行图文件旁的编辑日志（*.journal）中，"
+        "用于异常退出后的恢复。\n对新打开的运行图生效。"));
+    flay->addRow(tr("编辑日志"), ckJournal);
+
+    ckIncrementalSave = new QCheckBox(tr("启用"));
+    ckIncrementalSave->setToolTip(tr("保存时只将修改追加到运行图文件旁的编辑日志（*.journal）中，"
+        "日志过大时才完整写入运行图文件。需要启用编辑日志。\n"
+        "启用后，运行图文件须与日志一起复制、使用；其他程序读取的运行图文件可能不是最新的。"));
+    flay->addRow(tr("增量保存"), ckIncrementalSave);
+    connect(ckJournal, &QCheckBox::toggled, ckIncrementalSave, &QCheckBox::setEnabled);
+
     vlay->addLayout(flay);
 
     auto* g=new ButtonGroup<3>({"确定","还原", "关闭"});
@@ -171,6 +183,9 @@ void SystemJsonDialog::setData()
     cbSysStyle->setCurrentText(t.app_style);
     ckDrag->setChecked(t.drag_time);
     ckTransparentConfig->setChecked(t.transparent_config);
+    ckJournal->setChecked(t.journal_enabled);
+    ckIncrementalSave->setChecked(t.journal_incremental_save);
+    ckIncrementalSave->setEnabled(t.journal_enabled);
     setLanguageCombo();
 }
 
@@ -195,6 +210,8 @@ void SystemJsonDialog::actApply()
     t.show_start_page = ckStartup->isChecked();
     t.drag_time = ckDrag->isChecked();
     t.transparent_config = ckTransparentConfig->isChecked();
+    t.journal_enabled = ckJournal->isChecked();
+    t.journal_incremental_save = ckIncrementalSave->isChecked();
 }
 
 #endif
@@ -121,9 +121,10 @@ void TrainListWidget::searchTrain()
 		clearFilter();
 		return;
 	}
+	auto matched = coll.multiSearchTrainUnordered(s);
+	std::unordered_set<std::shared_ptr<Train>> matchedSet(matched.begin(), matched.end());
 	for (int i = 0; i < coll.trainCount(); i++) {
-		const auto& t = coll.trainAt(i);
-		table->setRowHidden(i, !t->trainName().contains(s));
+		table->setRowHidden(i, !matchedSet.count(coll.trainAt(i)));
 	}
 }
 
@@ -33,11 +33,13 @@
 #include "data/rail/forbid.h"
 #include "dragtimeinfowidget.h"
 #include "paintstationpointitem.h"
+#include "util/qetrace.h"
 #include "paintstationinfowidget.h"
 #include "util/qeprogressthread.h"
 
 
-DiagramWidget::DiagramWidget(Diagram& diagram, std::shared_ptr<DiagramPage> page, QWidget* parent):
+DiagramWidget::DiagramWidget(Diagram& diagram, std::shared_ptr<DiagramPage> page, QWidget* parent,
+    bool paintNow):
     QGraphicsView(parent), _page(page),_diagram(diagram),startTime(page->config().start_hour,0,0)
 {
     QScroller::grabGesture(this, QScroller::TouchGesture);
@@ -45,7 +47,8 @@ DiagramWidget::DiagramWidget(Diagram& diagram, std::shared_ptr<DiagramPage> page
     setAlignment(Qt::AlignTop | Qt::AlignLeft);
 
     setScene(new QGraphicsScene(this));
-    paintGraph();
+    if (paintNow)
+        paintGraph();
 
     setMouseTracking(true);
     setAttribute(Qt::WA_AcceptTouchEvents);
@@ -68,6 +71,7 @@ void DiagramWidget::autoPaintGraph()
 
 void DiagramWidget::paintGraph()
 {
+    QE_TRACE_SCOPE("DiagramWidget::paintGraph");
     auto clock_start = std::chrono::system_clock::now();
     updating = true;
     clearGraph();
@@ -104,6 +108,7 @@ void DiagramWidget::paintGraph()
     QList<QGraphicsItem*> leftItems, rightItems;
 
     _page->startYs().clear();
+    _page->updatePaintedRailIndex();
     for (int i = 0;i<_page->railwayCount();i++) {
         auto p = _page->railways().at(i);
         _page->startYs().append(ystart);
@@ -170,6 +175,7 @@ bool DiagramWidget::toPdf(const QString& filename, const QString& title, const Q
             "无法使用导出PDF功能。请考虑使用导出PNG功能。"));
     return false;
 #else
+    QE_TRACE_SCOPE("DiagramWidget::toPdf");
     using namespace std::chrono_literals;
     auto start = std::chrono::system_clock::now();
     QPrinter printer(QPrinter::HighResolution);
@@ -552,6 +558,7 @@ void DiagramWidget::showPaintingInfoWidget(const QPointF& pos, TrainItem* item,
 
 bool DiagramWidget::toPng(const QString& filename, const QString& title, const QString& note)
 {
+    QE_TRACE_SCOPE("DiagramWidget::toPng");
     using namespace std::chrono_literals;
     auto start = std::chrono::system_clock::now();
     constexpr int note_apdx = 80;
@@ -600,8 +607,60 @@ void DiagramWidget::removeTrain(QVector<std::shared_ptr<TrainAdapter>>&& adps)
 void DiagramWidget::updateTrain(std::shared_ptr<Train> train, 
     QVector<std::shared_ptr<TrainAdapter>>&& adps)
 {
-    removeTrain(std::move(adps));
-    paintTrain(train);
+    // 2026.10.19  新旧运行线按线路配对：同一线路上原有的Item按顺序沿用（resetLine），
+    // 多余的删除，不足的新建。原有Item所登记的标签信息按旧TrainLine清除，因此adps须保持有效。
+    QHash<const Railway*, QList<TrainItem*>> pool;
+    for (auto adp : adps) {
+        auto rail = adp->railway();
+        for (auto p : adp->lines()) {
+            if (auto* item = _page->takeTrainItem(p.get())) {
+                pool[rail.get()].append(item);
+            }
+        }
+    }
+
+    QHash<const Railway*, int> needed;
+    if (train->isShow()) {
+        for (auto adp : train->adapters()) {
+            for (auto line : adp->lines()) {
+                if (!line->isNull() && line->show())
+                    needed[adp->railway().get()]++;
+            }
+        }
+    }
+    // 先删除多余的，避免其标签信息影响新运行线的标签位置
+    for (auto itr = pool.begin(); itr != pool.end(); ++itr) {
+        auto& items = itr.value();
+        const int keep = itr.key() ? needed.value(itr.key(), 0) : 0;
+        while (items.size() > keep) {
+            auto* item = items.takeLast();
+            scene()->removeItem(item);
+            delete item;
+        }
+    }
+
+    if (train->isShow()) {
+        for (auto adp : train->adapters()) {
+            auto rail = adp->railway();
+            int idx = rail ? _page->paintedRailwayIndex(*rail) : -1;
+            if (idx < 0)
+                continue;
+            auto& reuse = pool[rail.get()];
+            for (auto line : adp->lines()) {
+                if (line->isNull() || !line->show())
+                    continue;
+                if (!reuse.isEmpty()) {
+                    auto* item = reuse.takeFirst();
+                    item->resetLine(line);
+                    _page->addItemMap(line.get(), item);
+                }
+                else {
+                    addTrainItem(line, *rail, _page->startYs().at(idx));
+                }
+            }
+        }
+    }
+
     if (_selectedTrain == train)
         highlightTrain(train);
 }
@@ -609,8 +668,33 @@ void DiagramWidget::updateTrain(std::shared_ptr<Train> train,
 void DiagramWidget::repaintTrain(std::shared_ptr<Train> train)
 {
     bool isSel = (train == _selectedTrain);
-    removeTrain(*train);
-    paintTrain(train);
+    if (!train->isShow()) {
+        removeTrain(*train);
+    }
+    else {
+        // 2026.10.19  未重新绑定，TrainLine不变：已有的Item就地更新几何图形，不再删除重建
+        for (auto adp : train->adapters()) {
+            auto rail = adp->railway();
+            int idx = rail ? _page->paintedRailwayIndex(*rail) : -1;
+            if (idx < 0)
+                continue;
+            for (auto line : adp->lines()) {
+                auto* item = _page->getTrainItem(line.get());
+                const bool visible = !line->isNull() && line->show();
+                if (item && visible) {
+                    item->resetLine();
+                }
+                else if (item) {
+                    _page->takeTrainItem(line.get());
+                    scene()->removeItem(item);
+                    delete item;
+                }
+                else if (visible) {
+                    addTrainItem(line, *rail, _page->startYs().at(idx));
+                }
+            }
+        }
+    }
     if (isSel) {
         _selectedTrain = train;
         highlightTrain(train);
@@ -1305,29 +1389,33 @@ void DiagramWidget::paintTrain(Train& train)
         return;
 
     for (auto adp : train.adapters()) {
-        //暂时按照暴力平方遍历的方法去找符合条件的Railway
-        for (int i = 0; i < _page->railwayCount(); i++) {
-            auto r = _page->railways().at(i);
-            if ((adp->railway()) == r) {
-                for (auto line : adp->lines()) {
-                    if (line->isNull()) {
-                        //这个是不应该的
-                        qDebug() << "DiagramWidget::paintTrain: WARNING: " <<
-                            "Unexpected null TrainLine! " << train.trainName().full() << Qt::endl;
-                    }
-                    else if(line->show()) {
-                        auto* item = new TrainItem(_diagram, line, *adp->railway(), *_page,
-                            _page->startYs().at(i));
-                        _page->addItemMap(line.get(), item);
-                        item->setZValue(5);
-                        scene()->addItem(item);
-                    }
-                }
+        // 2026.10.19  按页面的线路序号表查找，代替原来的平方遍历
+        auto rail = adp->railway();
+        int i = rail ? _page->paintedRailwayIndex(*rail) : -1;
+        if (i < 0)
+            continue;
+        for (auto line : adp->lines()) {
+            if (line->isNull()) {
+                //这个是不应该的
+                qDebug() << "DiagramWidget::paintTrain: WARNING: " <<
+                    "Unexpected null TrainLine! " << train.trainName().full() << Qt::endl;
+            }
+            else if(line->show()) {
+                addTrainItem(line, *rail, _page->startYs().at(i));
             }
         }
     }
 }
 
+TrainItem* DiagramWidget::addTrainItem(const std::shared_ptr<TrainLine>& line, Railway& railway, double startY)
+{
+    auto* item = new TrainItem(_diagram, line, railway, *_page, startY);
+    _page->addItemMap(line.get(), item);
+    item->setZValue(5);
+    scene()->addItem(item);
+    return item;
+}
+
 void DiagramWidget::paintTrainTmp(std::shared_ptr<Train> train)
 {
     if (train->isOnPainting()) {
@@ -1671,6 +1759,14 @@ double DiagramWidget::calXFromStart(const QTime& time) const
 
 TrainItem* DiagramWidget::posTrainItem(const QPointF& pos)
 {
+    // 2026.10.19  优先查线段索引：只检查pos附近网格内的线段，不遍历场景中的全部子Item。
+    // 索引只含运行线主体，查不到时（例如pos在车次标签上）仍按itemAt()查找。
+    const auto& index = _page->segmentIndex();
+    if (!index.empty()) {
+        if (auto* res = index.nearest(pos, [](TrainItem* it) { return it->isVisible(); }))
+            return res;
+    }
+
     auto* item = scene()->itemAt(pos, transform());
     if (!item)
         return nullptr;
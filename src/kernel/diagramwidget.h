@@ -100,7 +100,11 @@ public:
         SharedActions(const SharedActions&) = delete;
     };
 
-    DiagramWidget(Diagram& daigram, std::shared_ptr<DiagramPage> page, QWidget* parent = nullptr);
+    /**
+     * 2026.10.19: paintNow=false时不在构造时铺画，由调用方稍后调用paintGraph()（逐个页面打开）
+     */
+    DiagramWidget(Diagram& daigram, std::shared_ptr<DiagramPage> page, QWidget* parent = nullptr,
+        bool paintNow = true);
     ~DiagramWidget()noexcept;
 
     /**
@@ -166,7 +170,7 @@ public:
 
     /**
      * 当指定列车时刻更新时调用。
-     * 暂定为先删除再重新铺画
+     * 2026.10.19  新旧运行线按线路配对，原有Item尽量沿用并就地更新，不再全部删除重建
      * adps作为旧运行线的索引,xvalue语义
      */
     void updateTrain(std::shared_ptr<Train>, QVector<std::shared_ptr<TrainAdapter>>&& adps);
@@ -231,6 +235,11 @@ private:
      */
     void paintTrain(std::shared_ptr<Railway> railway, std::shared_ptr<Train> train);
 
+    /**
+     * 2026.10.19  为一段运行线新建Item并登记到页面
+     */
+    TrainItem* addTrainItem(const std::shared_ptr<TrainLine>& line, Railway& railway, double startY);
+
     /**
      * pyETRC.GraphicsWidget._addLeftTableText(self, text: str, 
      *           textFont, textColor, start_x, start_y, width, height)
@@ -19,18 +19,23 @@ TrainItem::TrainItem(Diagram& diagram, std::shared_ptr<TrainLine> line,
     _line(line),_diagram(diagram),_page(page),_railway(railway),
     startTime(page.config().start_hour,0,0),
     start_x(page.config().totalLeftMargin()),start_y(startY)
+{
+    initLineState();
+
+    // 如果这里报QtGui.dll的错误，考虑trainType()是不是空！
+    setLine();
+}
+
+void TrainItem::initLineState()
 {
     _startAtThis = train()->isStartingStation(_line->firstStationName());
     _endAtThis = train()->isTerminalStation(_line->lastStationName());
     startLabelInfo = _page.startingNullLabel(_line->firstRailStation().get(),_line->dir());
     endLabelInfo = _page.terminalNullLabel(_line->lastRailStation().get(), _line->dir());
-    pen = line->train()->pen();
+    pen = _line->train()->pen();
     if (config().inverse_color) {
         pen.setColor(qeutil::inversedColor(pen.color()));
     }
-
-    // 如果这里报QtGui.dll的错误，考虑trainType()是不是空！
-    setLine();
 }
 
 QRectF TrainItem::boundingRect() const
@@ -295,8 +300,43 @@ void TrainItem::repaintLinkLine()
     hasLinkLine = addLinkLine(labelTrainName());
 }
 
+void TrainItem::resetLine(std::shared_ptr<TrainLine> line)
+{
+    unhighlightWithLink();
+    // 标签、连线的占位信息按原来的TrainLine登记，须在替换_line之前清除
+    clearLabelInfo();
+    clearLinkInfo();
+    deleteSubItems();
+    if (line) {
+        _line = std::move(line);
+    }
+
+    _isHighlighted = _linkHighlighted = false;
+    linkLayer = startLayer = endLayer = LinkLayerInfo{};
+    hasLinkLine = true;
+    startInRange = endInRange = true;
+    spanItemWidth = spanItemHeight = -1;
+    startLabelHeight = endLabelHeight = -1;
+    _bounding = QRectF();
+    _onDragging = false;
+    _draggedStation = nullptr;
+    _dragPoint = StationPoint::NotValid;
+
+    initLineState();
+    setLine();
+}
+
 TrainItem::~TrainItem() noexcept
 {
+    deleteSubItems();
+    clearLabelInfo();
+    clearLinkInfo();
+}
+
+void TrainItem::deleteSubItems()
+{
+    if (pathItem)
+        _page.segmentIndex().remove(this);
     DELETE_SUB(pathItem);
     DELETE_SUB(expandItem);
     DELETE_SUB(startLabelItem);
@@ -319,8 +359,25 @@ TrainItem::~TrainItem() noexcept
         delete p;
     markLabels.clear();  
 
-    clearLabelInfo();
-    clearLinkInfo();
+    for (auto p : stationMarks)
+        delete p;
+    stationMarks.clear();
+}
+
+void TrainItem::registerSegments(const QPainterPath& path)
+{
+    std::vector<QLineF> segments;
+    segments.reserve(path.elementCount());
+    for (int i = 1; i < path.elementCount(); i++) {
+        const auto& ele = path.elementAt(i);
+        if (ele.isLineTo()) {
+            const auto& prev = path.elementAt(i - 1);
+            segments.emplace_back(QPointF(prev.x, prev.y), QPointF(ele.x, ele.y));
+        }
+    }
+    // 与expandItem（或未设置有效选择宽度时的pathItem）的描边半宽一致
+    const double radius = std::max(trainPen().widthF(), 1.0) * std::max(config().valid_width, 1) / 2;
+    _page.segmentIndex().insert(this, segments, radius);
 }
 
 void TrainItem::clearLabelInfo()
@@ -717,6 +774,7 @@ void TrainItem::setPathItem(const QString& trainName)
 
     pathItem = new QGraphicsPathItem(path.path(), this);
     pathItem->setPen(pen);
+    registerSegments(pathItem->path());
     if (config().valid_width > 1) {
         QPen expen(Qt::transparent, pen.width() * config().valid_width);
         expandItem = new QGraphicsPathItem(path.path(), this);
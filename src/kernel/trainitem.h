@@ -157,6 +157,13 @@ public:
      */
     void repaintLinkLine();
 
+    /**
+     * 2026.10.19  就地重新计算运行线的几何图形，不重新创建本对象（不增删场景中的Item）。
+     * line非空时改为绘制line（须属于同一线路），用于重新绑定后沿用原有的Item。
+     * 调用前后高亮状态被清除，由调用方重新设置。
+     */
+    void resetLine(std::shared_ptr<TrainLine> line = nullptr);
+
     ~TrainItem()noexcept;
 
     /**
@@ -210,6 +217,16 @@ private:
 
     void setLine();
 
+    /**
+     * 2026.10.19  由_line初始化始发终到、标签位置、画笔等状态，构造和resetLine()共用
+     */
+    void initLineState();
+
+    /**
+     * 2026.10.19  删除全部子Item，析构和resetLine()共用
+     */
+    void deleteSubItems();
+
     /**
      * @brief setPathItem
      * 绘制运行线主体部分  完全重写
@@ -217,6 +234,12 @@ private:
      */
     void setPathItem(const QString& trainName);
 
+    /**
+     * 2026.10.19  将运行线主体的各直线段登记到本页的线段索引中，供鼠标位置查找使用。
+     * 对应的注销在deleteSubItems()中。
+     */
+    void registerSegments(const QPainterPath& path);
+
     // 2024.02.26 split from setLine: 
     // returns the text to be shown in train name label
     QString labelTrainName()const;
@@ -1,5 +1,6 @@
 #include "GlobalLogger.h"
 #include <QTextBrowser>
+#include <QThread>
 #include <iostream>
 #include "util/utilfunc.h"
 
@@ -19,7 +20,14 @@ void GlobalLogger::handleLog(QtMsgType type, const QMessageLogContext& context,
 {
 	auto txt = formatMsg(type, context, msg);
 	if (text_out) {
-		text_out->append(txt);
+		// 2026.10.19: 工作线程（如批量计算）中的日志，转到界面线程输出
+		if (QThread::currentThread() == text_out->thread()) {
+			text_out->append(txt);
+		}
+		else {
+			QMetaObject::invokeMethod(text_out, "append", Qt::QueuedConnection,
+				Q_ARG(QString, txt));
+		}
 	}
 	else {
 #ifdef _DEBUG
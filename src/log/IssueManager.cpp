@@ -1,9 +1,14 @@
 ﻿#include "IssueManager.h"
 
+#include <algorithm>
+#include <iterator>
+
 #include "data/train/train.h"
 #include "data/rail/railway.h"
 
 std::unique_ptr<IssueManager> IssueManager::_instance;
+std::atomic_bool IssueManager::_recording{ true };
+thread_local IssueManager::Buffer* IssueManager::_threadBuffer = nullptr;
 
 IssueManager* IssueManager::get()
 {
@@ -72,6 +77,13 @@ QVariant IssueManager::headerData(int section, Qt::Orientation orientation, int
 
 void IssueManager::clear()
 {
+	if (!_recording)
+		return;
+	if (_threadBuffer) {
+		_threadBuffer->cleared = true;
+		_threadBuffer->issues.clear();
+		return;
+	}
 	beginResetModel();
 	_issues.clear();
 	endResetModel();
@@ -79,8 +91,12 @@ void IssueManager::clear()
 
 void IssueManager::emplaceIssue(PaintIssue&& issue)
 {
-	if (issue.level == QtDebugMsg)
+	if (issue.level == QtDebugMsg || !_recording)
 		return;
+	if (_threadBuffer) {
+		_threadBuffer->issues.emplace_back(std::move(issue));
+		return;
+	}
 	beginInsertRows({}, _issues.size(), _issues.size());
 	_issues.emplace_back(std::move(issue));
 	endInsertRows();
@@ -93,6 +109,14 @@ void IssueManager::emplaceIssue(QtMsgType type, const IssueInfo& info)
 
 void IssueManager::clearIssuesForTrain(const Train* train)
 {
+	if (!_recording)
+		return;
+	if (_threadBuffer) {
+		auto& lst = _threadBuffer->issues;
+		lst.erase(std::remove_if(lst.begin(), lst.end(),
+			[train](const PaintIssue& iss) { return iss.info.train.get() == train; }), lst.end());
+		return;
+	}
 	for (int i = _issues.size() - 1; i >= 0; --i) {
 		if (_issues.at(i).info.train.get() == train) {
 			removeIssueAt(i);
@@ -100,6 +124,39 @@ void IssueManager::clearIssuesForTrain(const Train* train)
 	}
 }
 
+void IssueManager::setRecording(bool on)
+{
+	_recording = on;
+}
+
+bool IssueManager::isRecording()
+{
+	return _recording;
+}
+
+IssueManager::BufferScope::BufferScope(Buffer& buf) :
+	_prev(_threadBuffer)
+{
+	_threadBuffer = &buf;
+}
+
+IssueManager::BufferScope::~BufferScope()
+{
+	_threadBuffer = _prev;
+}
+
+void IssueManager::replay(Buffer& buf)
+{
+	if (buf.cleared)
+		clear();
+	if (!buf.issues.empty()) {
+		beginInsertRows({}, _issues.size(), _issues.size() + buf.issues.size() - 1);
+		std::move(buf.issues.begin(), buf.issues.end(), std::back_inserter(_issues));
+		endInsertRows();
+	}
+	buf = Buffer{};
+}
+
 void IssueManager::removeIssueAt(int index)
 {
 	beginRemoveRows({}, index, index);
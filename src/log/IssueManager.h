@@ -1,4 +1,5 @@
 ﻿#pragma once
+#include <atomic>
 #include <deque>
 
 #include <QAbstractTableModel>
@@ -44,9 +45,48 @@ public:
 
 	void clearIssuesForTrain(const Train* train);
 
+	/**
+	 * 2026.10.19  是否记录问题（默认记录）。关闭后clear/emplaceIssue/clearIssuesForTrain都不做任何操作。
+	 * 本类不是线程安全的；无界面的批处理（qetrc-cli）在多个线程中同时读图，
+	 * 因此在启动工作线程前关闭，诊断结果另由Diagram::diagnoseAllTrains()获得。
+	 */
+	static void setRecording(bool on);
+	static bool isRecording();
+
+	/**
+	 * 2026.10.19  工作线程中暂存的问题。
+	 * 模型属于GUI线程，工作线程（如后台读图、绑定）不能直接修改。在该线程中以BufferScope
+	 * 设置缓冲区后，clear/emplaceIssue/clearIssuesForTrain都只作用于缓冲区；
+	 * 完成后由GUI线程调用replay()写入模型。
+	 * 缓冲区用于尚未交给界面的数据（如新读入的运行图），clearIssuesForTrain只清除缓冲区中的问题。
+	 */
+	struct Buffer {
+		bool cleared = false;   // 期间调用过clear()：replay时先清空模型
+		std::deque<PaintIssue> issues;
+	};
+
+	/**
+	 * 在当前线程的生存期内，把问题记录到buf
+	 */
+	class BufferScope {
+		Buffer* _prev;
+	public:
+		explicit BufferScope(Buffer& buf);
+		~BufferScope();
+		BufferScope(const BufferScope&) = delete;
+		BufferScope& operator=(const BufferScope&) = delete;
+	};
+
+	/**
+	 * 将缓冲区的内容写入模型，并清空缓冲区。仅在GUI线程调用。
+	 */
+	void replay(Buffer& buf);
+
 private:
 	IssueManager() = default;
 	static std::unique_ptr<IssueManager> _instance;
+	static std::atomic_bool _recording;
+	static thread_local Buffer* _threadBuffer;
 
 	void removeIssueAt(int index);
 };
@@ -1,8 +1,10 @@
 ﻿#include "mainwindow/mainwindow.h"
 #include "mobile/amainwindow.h"
 #include "data/common/qesystem.h"
+#include "util/qetrace.h"
 
 #include <QApplication>
+#include <QDebug>
 #include <QStyleFactory>
 #include <chrono>
 #include <QStandardPaths>
@@ -14,6 +16,11 @@ int main(int argc, char *argv[])
 {
     {
     QApplication a(argc, argv);
+
+    // 2026.10.19: --trace <file>  从启动开始性能记录，退出时写出Chrome trace文件
+    const QString traceFile = qetrace::traceFileFromArgs(a.arguments());
+    if (!traceFile.isEmpty())
+        qetrace::setEnabled(true);
     //    qDebug()<<QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation)
     //           <<Qt::endl;
 
@@ -47,7 +54,11 @@ int main(int argc, char *argv[])
     MainWindow w;
     w.showMaximized();
 #endif
-    return a.exec();
+    int ret = a.exec();
+    if (!traceFile.isEmpty() && !qetrace::dumpChromeTrace(traceFile)) {
+        qWarning() << "write trace file failed: " << traceFile;
+    }
+    return ret;
     }
 }
 
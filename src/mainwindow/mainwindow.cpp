@@ -13,7 +13,20 @@
 #include <QStatusBar>
 #include <QLabel>
 #include <QStyleFactory>
+#include <QThread>
+#include <QLocale>
+#include <QUuid>
+#include <QTimer>
+#include <QPointer>
+#include <QProgressDialog>
+#include <atomic>
+#include <QFileInfo>
+#include <typeinfo>
+#include <functional>
+#include <utility>
 #include <chrono>
+#include <algorithm>
+#include <map>
 #include <SARibbonActionsManager.h>
 #include <SARibbonCustomizeDialog.h>
 #include <QXmlStreamWriter>
@@ -21,6 +34,8 @@
 #include <QTextBrowser>
 
 #include "model/train/trainlistmodel.h"
+#include "data/diagram/diagramdirty.h"
+#include "data/diagram/trainadapter.h"
 #include "editors/trainlistwidget.h"
 #include "model/diagram/diagramnavimodel.h"
 #include "data/common/qesystem.h"
@@ -42,6 +57,7 @@
 #include "model/train/timetablequickmodel.h"
 
 #include "traincontext.h"
+#include "util/qeprogressthread.h"
 #include "railcontext.h"
 #include "viewcategory.h"
 #include "pagecontext.h"
@@ -81,6 +97,7 @@
 #include "editors/train/predeftrainfiltermanager.h"
 #include "viewers/stats/trainintervalstatdialog.h"
 #include "log/GlobalLogger.h"
+#include "util/qetrace.h"
 #include "log/IssueWidget.h"
 #include "editors/trainpath/pathlistwidget.h"
 #include "model/trainpath/pathlistmodel.h"
@@ -104,12 +121,20 @@ MainWindow::MainWindow(QWidget* parent)
 	_diagram.readDefaultConfigs();
 	undoStack->setUndoLimit(200);
 	connect(undoStack, SIGNAL(indexChanged(int)), this, SLOT(markChanged()));
+	connect(undoStack, &QUndoStack::indexChanged, this, &MainWindow::onUndoIndexChanged);
 
 	initUI();
 
+	// 2026.10.19: 跳过 --trace <file> 参数，取第一个其他参数作为文件名
 	QString cmdFile;
-	if (QCoreApplication::arguments().size() > 1) {
-		cmdFile = QCoreApplication::arguments().at(1);
+	const auto args = QCoreApplication::arguments();
+	for (int i = 1; i < args.size(); i++) {
+		if (args.at(i) == QLatin1String("--trace")) {
+			i++;
+			continue;
+		}
+		cmdFile = args.at(i);
+		break;
 	}
 
 	loadInitDiagram(cmdFile);
@@ -173,10 +198,11 @@ void MainWindow::undoRemoveTrain(std::shared_ptr<Train> train)
 
 void MainWindow::onStationTableChanged(std::shared_ptr<Railway> rail, [[maybe_unused]] bool equiv)
 {
-	_diagram.updateRailway(rail);
-	trainListWidget->getModel()->updateAllMileSpeed();
-	pathListWidget->model()->updateAllValidity();
-	updateRailwayDiagrams(rail);
+	// 径路车次由qecmd::RebindTrainsByPaths负责重新绑定（可撤销）
+	DiagramDirty dirty;
+	dirty.railways.insert(rail);
+	dirty.rebindPathTrains = false;
+	refreshDirty(dirty);
 	//2022.06.02：如果非equiv变化，贪心推线的要更新！
 	//2022.11.19：删除!equiv条件；单双线变化现在似乎不被认为是non-equiv，但它确实影响推线。
 	if (greedyWidget) {
@@ -208,6 +234,55 @@ void MainWindow::updateAllDiagrams()
 		p->paintGraph();
 }
 
+void MainWindow::refreshDirty(DiagramDirty& dirty)
+{
+	if (dirty.empty())
+		return;
+	auto start = std::chrono::steady_clock::now();
+	_diagram.refreshDirty(dirty);
+
+	std::map<std::shared_ptr<Train>, QVector<std::shared_ptr<TrainAdapter>>*> replaced;
+	for (auto& [train, adps] : dirty.replaced) {
+		replaced.emplace(train, &adps);
+	}
+	int fullPages = 0;
+	for (int i = 0; i < _diagram.pages().size(); i++) {
+		auto page = _diagram.pages().at(i);
+		auto* w = diagramWidgets.at(i);
+		bool full = std::any_of(dirty.railways.begin(), dirty.railways.end(),
+			[&page](const auto& r) { return page->containsRailway(r); });
+		if (full) {
+			w->paintGraph();
+			fullPages++;
+			continue;
+		}
+		for (const auto& t : dirty.trains) {
+			if (auto itr = replaced.find(t); itr != replaced.end()) {
+				auto adps = *(itr->second);    // copy: shared by the pages
+				w->updateTrain(t, std::move(adps));
+			}
+			else {
+				w->repaintTrain(t);
+			}
+		}
+	}
+
+	if (dirty.rebind) {
+		trainListWidget->getModel()->updateAllMileSpeed();
+	}
+	if (!dirty.paths.empty()) {
+		pathListWidget->model()->updateAllValidity();
+	}
+	for (auto p : railStationWidgets) {
+		if (dirty.railways.count(p->getRailway())) {
+			p->refreshData();
+		}
+	}
+	showStatus(tr("增量刷新：%1条线路，%2个车次，整页重绘%3个运行图  用时 %4 毫秒")
+		.arg(dirty.railways.size()).arg(dirty.trains.size()).arg(fullPages)
+		.arg((std::chrono::steady_clock::now() - start) / std::chrono::milliseconds(1)));
+}
+
 void MainWindow::updatePageDiagram(std::shared_ptr<DiagramPage> pg)
 {
 	foreach(auto w, diagramWidgets) {
@@ -226,6 +301,7 @@ void MainWindow::onTrainsImported()
 	trainListWidget->refreshData();   //这个自动调用naviTree的更新操作！
 	naviModel->refreshRoutings();
 	undoStack->clear();  //不支持撤销
+	journal.recordFull();
 	markChanged();
 	showStatus(tr("导入列车完成"));
 }
@@ -388,6 +464,35 @@ void MainWindow::showAboutDialog()
 	QMessageBox::about(this, tr("关于"), text);
 }
 
+void MainWindow::actToggleTrace(bool on)
+{
+	if (on && !qetrace::isEnabled())
+		qetrace::clear();
+	qetrace::setEnabled(on);
+	showStatus(on ? tr("开始性能记录") : tr("停止性能记录"));
+}
+
+void MainWindow::actExportTrace()
+{
+	QString res = QFileDialog::getSaveFileName(this, tr("导出性能记录"), {},
+		tr("Chrome trace (*.json)\n所有文件 (*)"));
+	if (res.isEmpty())
+		return;
+	if (qetrace::dumpChromeTrace(res)) {
+		showStatus(tr("导出性能记录成功：%1").arg(res));
+	}
+	else {
+		QMessageBox::warning(this, tr("错误"), tr("写入文件%1失败").arg(res));
+	}
+}
+
+void MainWindow::actTraceSummary()
+{
+	qetrace::logSummary();
+	if (!logDock->isVisible())
+		logDock->toggleView(true);
+}
+
 #if 0
 void MainWindow::useWpsStyle()
 {
@@ -749,7 +854,7 @@ void MainWindow::initDockWidgets()
 		autoHideArea = manager->addAutoHideDockWidget(ads::SideBarBottom, dock);
 		autoHideArea->setSize(200);
 
-		connect(IssueManager::get(), &IssueManager::rowsInserted,
+		connect(IssueManager::get(), &IssueManager::rowsInserted, this,
 			[autoHideArea]() {if (!autoHideArea->isVisible()) autoHideArea->toggleCollapseState(); });
 	}
 }
@@ -939,6 +1044,21 @@ void MainWindow::initToolbar()
 		act->setMenu(menu);
         panel->addLargeAction(act, QToolButton::MenuButtonPopup);
 
+		act = makeAction(QEICN_text_out_widget, tr("性能记录"));
+		act->setToolTip(tr("性能记录\n"
+			"记录读取、绑定、诊断、推线、铺画、导出等主要步骤的耗时，"
+			"可导出为Chrome trace文件（chrome://tracing 或 ui.perfetto.dev 查看），"
+			"或在输出窗口显示各步骤的汇总。"));
+		act->setCheckable(true);
+		act->setChecked(qetrace::isEnabled());
+		act->setEnabled(qetrace::compiledIn());
+		connect(act, &QAction::toggled, this, &MainWindow::actToggleTrace);
+		menu = new SARibbonMenu(this);
+		menu->addAction(tr("导出记录..."), this, &MainWindow::actExportTrace);
+		menu->addAction(tr("输出汇总"), this, &MainWindow::actTraceSummary);
+		act->setMenu(menu);
+		panel->addLargeAction(act, QToolButton::MenuButtonPopup);
+
 		act = makeAction(QEICN_exit_app, tr("退出"));
 		connect(act, SIGNAL(triggered()), this, SLOT(close()));
 		panel->addLargeAction(act);
@@ -1576,6 +1696,10 @@ bool MainWindow::clearDiagram()
 
 void MainWindow::clearDiagramUnchecked()
 {
+	waitForPendingSave();
+	// 到这里时，修改已经保存或者用户选择放弃
+	journal.discardUncommitted();
+
 	//删除打开的所有运行图面板
 	pageMenu->clear();
 	for (auto p : diagramDocks) {
@@ -1607,6 +1731,7 @@ void MainWindow::clearDiagramUnchecked()
 
 	undoStack->clear();
 	undoStack->resetClean();
+	journalUndoIndex = 0;
 
 	// 2022.05.19 新增
 	focusOutRuler();
@@ -1637,9 +1762,9 @@ void MainWindow::actNewGraph()
 	showStatus(tr("新建空白运行图"));
 }
 
-void MainWindow::endResetGraph()
+void MainWindow::endResetGraph(bool progressive)
 {
-	resetDiagramPages();
+	resetDiagramPages(progressive);
 
 	//导航窗口
 	naviModel->resetModel();
@@ -1659,44 +1784,238 @@ void MainWindow::endResetGraph()
 	updateWindowTitle();
 }
 
-void MainWindow::resetDiagramPages()
+void MainWindow::resetDiagramPages(bool progressive)
 {
 	if (_diagram.pages().empty() && !_diagram.isNull())
 		_diagram.createDefaultPage();
 	for (auto p : _diagram.pages()) {
-		addPageWidget(p);
+		addPageWidget(p, !progressive);
+	}
+	if (progressive) {
+		// 2026.10.19: 窗口先全部建立（列表等立即可用），再逐个铺画，每个页面之间让出事件循环
+		QList<QPointer<DiagramWidget>> widgets;
+		for (auto* w : diagramWidgets)
+			widgets.append(w);
+		paintPagesProgressively(std::move(widgets));
 	}
 }
 
+void MainWindow::paintPagesProgressively(QList<QPointer<DiagramWidget>> widgets)
+{
+	if (widgets.isEmpty())
+		return;
+	QTimer::singleShot(0, this, [this, widgets = std::move(widgets)]() mutable {
+		using namespace std::chrono_literals;
+		auto w = widgets.takeFirst();
+		if (w) {
+			auto start = std::chrono::steady_clock::now();
+			w->paintGraph();
+			auto end = std::chrono::steady_clock::now();
+			qInfo() << "Open: stage paint page " << w->page()->name() << " " << (end - start) / 1ms << " ms";
+		}
+		paintPagesProgressively(std::move(widgets));
+		});
+}
+
+struct MainWindow::OpenResult {
+	QString filename;
+	Diagram dia;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::atomic_bool cancel{ false };
+	bool ok = false;
+	bool journaled = false, recovered = false;
+	bool reopen = false;   // 重新打开当前文件：日志中未保存的部分是本次的修改，已经选择放弃，不再询问
+	DiagramJournal::ReplayResult rep;
+	IssueManager::Buffer issues;   // 读图、绑定期间产生的问题，由applyLoadedGraph写入问题列表
+};
+
 bool MainWindow::openGraph(const QString& filename)
 {
 	// 2022.09.11: 把打开的计时和提示都放到这里来。
-	using namespace std::chrono_literals;
-	auto start = std::chrono::system_clock::now();
+	// 2026.10.19: 拆分为loadGraphFile（可在工作线程执行）和applyLoadedGraph两步；这里是同步版本
 	qInfo() << "Opening diagram file " << filename;
+	waitForPendingSave();
 
-	clearDiagramUnchecked();
+	OpenResult res;
+	res.filename = filename;
+	res.reopen = (QFileInfo(filename) == QFileInfo(_diagram.filename()));
+	res.dia.readDefaultConfigs();   //暂定这里读取一次默认配置，防止move时丢失数据
+	loadGraphFile(res, [this, filename](int count) {
+		return askRecoverJournal(filename, count);
+		}, {});
+	return applyLoadedGraph(res, false);
+}
 
-	Diagram dia;
-	dia.readDefaultConfigs();   //暂定这里读取一次默认配置，防止move时丢失数据
-	bool flag = dia.fromJson(filename);
-
-	if (flag && !dia.isNull()) {
-		beforeResetGraph();
-		_diagram = std::move(dia);   //move assign
-		endResetGraph();
-		addRecentFile(filename);
-		auto end = std::chrono::system_clock::now();
-		showStatus(tr("打开运行图文件%1成功  用时%2毫秒").arg(filename)
-			.arg((end - start) / 1ms));
-		// 这里面可能有输出提示的
-		checkOpenFile();
-		return true;
+void MainWindow::openGraphAsync(const QString& filename)
+{
+	if (openingGraph)
+		return;
+	qInfo() << "Opening diagram file (async) " << filename;
+	// 当前运行图在applyLoadedGraph()之前保持不变，取消时不受影响；这里只等待写文件完成
+	waitForPendingSave();
+
+	auto res = std::make_shared<OpenResult>();
+	res->filename = filename;
+	res->reopen = (QFileInfo(filename) == QFileInfo(_diagram.filename()));
+	res->dia.readDefaultConfigs();
+	openingGraph = true;
+
+	auto* task = new QEProgressThread([this, res](QEProgressThread* th)->int {
+		bool flag = loadGraphFile(*res, [this, res](int count) {
+			bool ans = false;
+			QMetaObject::invokeMethod(this, [this, res, count, &ans]() {
+				ans = askRecoverJournal(res->filename, count);
+				}, Qt::BlockingQueuedConnection);
+			return ans;
+			}, [th](const QString& label, int value) {
+				th->setLabelText(label);
+				th->setValue(value);
+			});
+		return flag ? 0 : 1;
+		}, this);
+
+	auto* dlg = task->progressDialog();
+	dlg->setWindowTitle(tr("打开运行图"));
+	dlg->setLabelText(tr("正在读取文件"));
+	// 立即显示并阻塞所有窗口（包括浮动的停靠面板）：读取期间的编辑会被applyLoadedGraph()丢弃
+	dlg->setWindowModality(Qt::ApplicationModal);
+	dlg->setMinimumDuration(0);
+	dlg->setRange(0, 100);
+	dlg->setValue(0);
+	dlg->show();
+	connect(dlg, &QProgressDialog::canceled, this, [res]() {
+		res->cancel = true;
+		});
+
+	connect(task, &QThread::finished, this, [this, task, res]() {
+		openingGraph = false;
+		task->deleteLater();
+		if (res->cancel) {
+			qInfo() << "Opening cancelled: " << res->filename;
+			showStatus(tr("已取消打开运行图文件%1").arg(res->filename));
+			return;
+		}
+		if (!applyLoadedGraph(*res, true)) {
+			QMessageBox::warning(this, QObject::tr("错误"), QObject::tr("文件错误，请检查!"));
+			return;
+		}
+		markUnchanged();
+		resetRecentActions();
+		updateWindowTitle();
+		});
+	task->start();
+}
+
+bool MainWindow::loadGraphFile(OpenResult& res, const std::function<bool(int)>& askRecover,
+	const std::function<void(const QString&, int)>& stage)
+{
+	QE_TRACE_SCOPE("MainWindow::loadGraphFile");
+	using namespace std::chrono_literals;
+	// 问题列表属于GUI线程，这里可能在工作线程中，先记录到res.issues
+	IssueManager::BufferScope issueScope(res.issues);
+	auto lap = std::chrono::steady_clock::now();
+	auto logStage = [&](const char* name) {
+		auto now = std::chrono::steady_clock::now();
+		qInfo() << "Open " << res.filename << ": stage " << name << " " << (now - lap) / 1ms << " ms";
+		lap = now;
+	};
+	auto report = [&](const QString& label, int value) {
+		if (stage) stage(label, value);
+	};
+
+	// 1. 读取文件；存在匹配的编辑日志时，以基准文件+日志为准
+	report(tr("正在读取文件"), 0);
+	QJsonObject obj;
+	if (QFile::exists(DiagramJournal::journalFileName(res.filename))) {
+		const QJsonObject& base = DiagramJournal::readBaseJson(res.filename);
+		res.rep = DiagramJournal::replay(res.filename, base);
+		res.journaled = res.rep.valid;
+		if (res.journaled && res.rep.uncommitted > 0 && askRecover && !res.reopen)
+			res.recovered = askRecover(res.rep.uncommitted);
+		if (res.journaled)
+			obj = res.recovered ? res.rep.allData : res.rep.committedData;
+		else
+			obj = base;
 	}
 	else {
-		qWarning() << "open failed: " << filename;
+		obj = DiagramJournal::readBaseJson(res.filename);
+	}
+	logStage("read");
+	if (res.cancel)
+		return false;
+
+	// 2. 构造数据
+	report(tr("正在解析数据"), 10);
+	if (res.dia.fromJsonUnbound(obj)) {
+		res.dia.setFilename(res.filename);
+		logStage("parse");
+	}
+	else {
+		// 其他格式（trc）：按原来的方式读取，其中已经完成绑定
+		res.journaled = res.recovered = false;
+		res.ok = res.dia.fromJson(res.filename) && !res.dia.isNull();
+		logStage("parse (fallback)");
+		return res.ok;
+	}
+	if (res.cancel)
+		return false;
+
+	// 3. 绑定列车
+	report(tr("正在绑定列车"), 20);
+	if (!res.dia.bindAllTrains(&res.cancel, [&](int done, int total) {
+		report(tr("正在绑定列车 (%1/%2)").arg(done).arg(total), 20 + 80 * done / std::max(total, 1));
+		})) {
+		return false;
+	}
+	logStage("bind");
+	res.ok = !res.dia.isNull();
+	return res.ok;
+}
+
+bool MainWindow::applyLoadedGraph(OpenResult& res, bool progressive)
+{
+	QE_TRACE_SCOPE("MainWindow::applyLoadedGraph");
+	using namespace std::chrono_literals;
+	if (!res.ok) {
+		qWarning() << "open failed: " << res.filename;
 		return false;
 	}
+	auto applyStart = std::chrono::steady_clock::now();
+	clearDiagramUnchecked();
+	beforeResetGraph();
+	_diagram = std::move(res.dia);   //move assign
+	endResetGraph(progressive);
+	IssueManager::get()->replay(res.issues);
+	addRecentFile(res.filename);
+
+	if (res.journaled) {
+		journal.resume(res.recovered ? res.rep.totalSize : res.rep.committedSize, res.rep.committedSize,
+			res.rep.hasCommit, res.rep.committed + (res.recovered ? res.rep.uncommitted : 0));
+		if (res.recovered) {
+			// 调用方在打开之后会标记为未修改，这里排在其后
+			QMetaObject::invokeMethod(this, "markChanged", Qt::QueuedConnection);
+		}
+	}
+	else if (SystemJson::instance.journal_enabled &&
+		QFileInfo(res.filename).suffix().compare("trc", Qt::CaseInsensitive) != 0) {
+		journal.restart({});
+	}
+
+	auto end = std::chrono::steady_clock::now();
+	qInfo() << "Open " << res.filename << ": stage apply " << (end - applyStart) / 1ms << " ms";
+	showStatus(tr("打开运行图文件%1成功  用时%2毫秒").arg(res.filename)
+		.arg((end - res.start) / 1ms));
+	// 这里面可能有输出提示的
+	checkOpenFile();
+	return true;
+}
+
+bool MainWindow::askRecoverJournal(const QString& filename, int count)
+{
+	auto btn = QMessageBox::question(this, tr("恢复未保存的修改"),
+		tr("运行图文件[%1]有%2条未保存的修改记录，可能是上次程序异常退出所致。\n"
+			"是否恢复这些修改？选择否将丢弃这些记录。").arg(filename).arg(count));
+	return btn == QMessageBox::Yes;
 }
 
 void MainWindow::addTrainLine(Train& train)
@@ -1964,7 +2283,8 @@ bool MainWindow::saveQuestion()
 		QMessageBox::Yes | QMessageBox::No | QMessageBox::Cancel, QMessageBox::Cancel);
 	if (flag == QMessageBox::Yes) {
 		actSaveGraph();
-		return true;
+		// 2026.10.19: 接下来往往是关闭或清理运行图，须等待后台保存完成；保存失败则不继续
+		return waitForPendingSave();
 	}
 	else if (flag == QMessageBox::No) {
 		return true;
@@ -2069,8 +2389,11 @@ void MainWindow::closeEvent(QCloseEvent* e)
 
 	if (changed && !saveQuestion())
 		e->ignore();
-	else
+	else {
+		waitForPendingSave();
+		journal.discardUncommitted();
 		e->accept();
+	}
 }
 
 void MainWindow::dragEnterEvent(QDragEnterEvent* e)
@@ -2115,6 +2438,7 @@ void MainWindow::dropEvent(QDropEvent* e)
 void MainWindow::informPageListChanged()
 {
 	naviModel->resetModel();
+	journal.recordFull();   // 不经过撤销栈
 	markChanged();
 }
 
@@ -2155,9 +2479,13 @@ void MainWindow::actOpenRailStationWidget(std::shared_ptr<Railway> rail)
 void MainWindow::commitPassedStationChange(int n)
 {
 	_diagram.config().max_passed_stations = n;
-	_diagram.rebindAllTrains();
-	trainListWidget->getModel()->updateAllMileSpeed();
-	updateAllDiagrams();
+	// 2026.10.19  只影响非径路车次与线路的绑定，径路车次不必重新绑定
+	DiagramDirty dirty;
+	foreach(auto r, _diagram.railways()) {
+		dirty.railways.insert(r);
+	}
+	dirty.rebindPathTrains = false;
+	refreshDirty(dirty);
 }
 
 void MainWindow::refreshAll()
@@ -2212,6 +2540,26 @@ void MainWindow::applyChangeStationName(const ChangeStationNameData& data)
 	undoStack->push(new qecmd::ChangeStationNameGlobal(data, this));
 }
 
+void MainWindow::commitChangeStationName(const ChangeStationNameData& data)
+{
+	DiagramDirty dirty;
+	dirty.rebind = false;
+	for (const auto& p : data.railStations) {
+		dirty.railways.insert(std::get<0>(p));
+	}
+	refreshDirty(dirty);
+
+	if (!data.startings.isEmpty() || !data.terminals.isEmpty()) {
+		trainListWidget->getModel()->updateAllTrainStartingTerminal();
+	}
+	pathListWidget->refreshData();
+	contextTrain->refreshAllData();
+	if (!dirty.railways.empty()) {
+		contextRail->refreshAllData();
+		contextRuler->refreshAllData();
+	}
+}
+
 void MainWindow::setRoutingHighlight(std::shared_ptr<Routing> routing, bool on)
 {
 	if (on) {
@@ -2266,30 +2614,18 @@ void MainWindow::actOpenGraph()
 	if (changed && !saveQuestion())
 		return;
 	QString res = QFileDialog::getOpenFileName(this, QObject::tr("打开"), QString(),
-		QObject::tr("pyETRC运行图文件(*.pyetgr;*.json)\nETRC运行图文件(*.trc)\n所有文件(*.*)"));
+		QObject::tr("pyETRC运行图文件(*.pyetgr;*.json)\nqETRC二进制运行图文件(*.pyetgrb)\nETRC运行图文件(*.trc)\n所有文件(*.*)"));
 	if (res.isNull())
 		return;
 	
-	bool flag = openGraph(res);
-	if (!flag)
-		QMessageBox::warning(this, QObject::tr("错误"), QObject::tr("文件错误，请检查!"));
-	else {
-		markUnchanged();
-	}
+	openGraphAsync(res);
 }
 
 
 void MainWindow::openFileChecked(const QString& filename)
 {
 	if (!changed || saveQuestion()) {
-		bool flag = openGraph(filename);
-		if (!flag)
-			QMessageBox::warning(this, QObject::tr("错误"), QObject::tr("文件错误，请检查!"));
-		else {
-			markUnchanged();
-			resetRecentActions();
-			updateWindowTitle();
-		}
+		openGraphAsync(filename);
 	}
 }
 
@@ -2297,34 +2633,126 @@ void MainWindow::actSaveGraph()
 {
 	if (_diagram.filename().isEmpty())
 		actSaveGraphAs();
+	else if (SystemJson::instance.journal_enabled && SystemJson::instance.journal_incremental_save &&
+		journal.isActive() && !journal.needsCompaction()) {
+		saveGraphIncremental();
+	}
 	else {
-		using namespace std::chrono_literals;
-		auto start = std::chrono::system_clock::now();
-		_diagram.save();
-		markUnchanged();
-		undoStack->setClean();
-		auto end = std::chrono::system_clock::now();
-		showStatus(tr("保存成功  用时%1毫秒").arg((end - start) / 1ms));
+		saveGraphInBackground();
 	}
 }
 
 void MainWindow::actSaveGraphAs()
 {
 	QString res = QFileDialog::getSaveFileName(this, QObject::tr("另存为"), "",
-		tr("pyETRC运行图文件(*.pyetgr;*.json)\nETRC运行图文件(*.trc)\n所有文件(*.*)"));
+		tr("pyETRC运行图文件(*.pyetgr;*.json)\nqETRC二进制运行图文件(*.pyetgrb)\nETRC运行图文件(*.trc)\n所有文件(*.*)"));
 	if (res.isNull())
 		return;
-	auto start = std::chrono::system_clock::now();
-	bool flag = _diagram.saveAs(res);
-	if (flag) {
-		using namespace std::chrono_literals;
-		markUnchanged();
-		undoStack->setClean();
-		addRecentFile(res);
+	saveGraphInBackground(res);
+}
+
+struct MainWindow::PendingSave {
+	QThread* thread;
+	QString filename;
+	int undoIndex;
+	bool saveAs;        // 另存为：成功后才改用filename
+	bool dropJournal;   // 未启用编辑日志：保存成功后删除接续的旧日志
+	QString baseId;     // 另存为时，新日志的基准标识
+	std::chrono::steady_clock::time_point start;
+	qint64 bytes = -1;
+	QString error;
+};
+
+void MainWindow::saveGraphInBackground(const QString& saveAsName)
+{
+	// 上一次保存尚未完成时先等它完成，保证文件按顺序更新
+	waitForPendingSave();
+
+	auto start = std::chrono::steady_clock::now();
+	auto snap = std::make_shared<Diagram::SaveSnapshot>(_diagram.saveSnapshot(saveAsName));
+	auto ps = std::make_shared<PendingSave>();
+	ps->saveAs = !saveAsName.isEmpty();
+	ps->dropJournal = !SystemJson::instance.journal_enabled;
+	if (!ps->dropJournal) {
+		// 2026.10.19: 写入成功后，日志改为相对于本次写入的文件重新开始。
+		// 写入完成之前原日志保持不变，继续记录编辑，写入中途崩溃时仍可从原日志恢复
+		ps->baseId = QUuid::createUuid().toString(QUuid::WithoutBraces);
+		snap->data.insert(DiagramJournal::baseIdKey, ps->baseId);
+	}
+	ps->filename = snap->filename;
+	ps->undoIndex = undoStack->index();
+	ps->start = start;
+	// 工作线程只访问snap和ps中的结果字段
+	ps->thread = QThread::create([snap, ps]() {
+		ps->bytes = Diagram::writeSnapshot(*snap, &ps->error);
+		});
+	QThread* th = ps->thread;
+	connect(th, &QThread::finished, this, [this, th]() {
+		if (pendingSave && pendingSave->thread == th)
+			finishBackgroundSave();
+		});
+	pendingSave = ps;
+	showStatus(tr("正在保存%1").arg(ps->filename));
+	th->start();
+}
+
+bool MainWindow::waitForPendingSave()
+{
+	if (!pendingSave)
+		return true;
+	return finishBackgroundSave();
+}
+
+bool MainWindow::finishBackgroundSave()
+{
+	using namespace std::chrono_literals;
+	auto ps = std::move(pendingSave);
+	if (!ps)
+		return true;
+	ps->thread->wait();
+	ps->thread->deleteLater();
+	auto end = std::chrono::steady_clock::now();
+
+	if (ps->bytes < 0) {
+		qWarning() << "save failed: " << ps->filename << " " << ps->error;
+		QMessageBox::warning(this, tr("错误"), tr("保存运行图文件%1失败，原文件未改动。\n%2")
+			.arg(ps->filename, ps->error));
+		// 原日志没有改动，仍然对应原文件
+		return false;
+	}
+	if (ps->saveAs) {
+		// 原文件的日志中，已确认的部分仍然属于原文件
+		journal.discardUncommitted();
+		_diagram.setFilename(ps->filename);
+		addRecentFile(ps->filename);
 		updateWindowTitle();
-		auto end = std::chrono::system_clock::now();
-		showStatus(tr("保存成功  用时%1毫秒").arg((end - start) / 1ms));
+		if (!ps->dropJournal) {
+			journal.restart(ps->baseId);
+			// 保存期间的编辑不在新文件中
+			if (undoStack->index() != ps->undoIndex)
+				journal.recordFull();
+		}
+	}
+	else if (_diagram.filename() == ps->filename) {
+		if (ps->dropJournal) {
+			// 旧日志中的修改已经写入文件
+			journal.remove();
+		}
+		else {
+			// 文件已经写成，日志改为相对于新文件
+			journal.restart(ps->baseId);
+			if (undoStack->index() != ps->undoIndex)
+				journal.recordFull();
+		}
 	}
+	// 保存期间有新的编辑，则保持已修改状态
+	if (undoStack->index() == ps->undoIndex && _diagram.filename() == ps->filename) {
+		undoStack->setClean();
+		markUnchanged();
+	}
+	showStatus(tr("保存成功  用时%1毫秒  %2").arg((end - ps->start) / 1ms)
+		.arg(QLocale().formattedDataSize(ps->bytes)));
+	return true;
 }
 
 void MainWindow::actPopupAppButton()
@@ -2333,6 +2761,24 @@ void MainWindow::actPopupAppButton()
 	appMenu->popup(btn->mapToGlobal(QPoint(0, btn->height())));
 }
 
+void MainWindow::saveGraphIncremental()
+{
+	using namespace std::chrono_literals;
+	waitForPendingSave();
+	auto start = std::chrono::steady_clock::now();
+	int count = journal.pendingCount();
+	if (!journal.commit()) {
+		qWarning() << "incremental save failed, fall back to full save: " << _diagram.filename();
+		saveGraphInBackground();
+		return;
+	}
+	undoStack->setClean();
+	markUnchanged();
+	auto end = std::chrono::steady_clock::now();
+	showStatus(tr("增量保存成功  %1条修改  用时%2毫秒  日志%3").arg(count)
+		.arg((end - start) / 1ms).arg(QLocale().formattedDataSize(journal.size())));
+}
+
 void MainWindow::addRecentFile(const QString& filename)
 {
 	SystemJson::instance.addHistoryFile(filename);
@@ -2367,17 +2813,17 @@ void MainWindow::openRecentFile()
 }
 
 
-void MainWindow::addPageWidget(std::shared_ptr<DiagramPage> page)
+void MainWindow::addPageWidget(std::shared_ptr<DiagramPage> page, bool paintNow)
 {
 	int idx = diagramDocks.size();
-	insertPageWidget(page, idx);
+	insertPageWidget(page, idx, paintNow);
 }
 
-void MainWindow::insertPageWidget(std::shared_ptr<DiagramPage> page, int index)
+void MainWindow::insertPageWidget(std::shared_ptr<DiagramPage> page, int index, bool paintNow)
 {
 	using namespace std::chrono_literals;
 	auto start = std::chrono::system_clock::now();
-	DiagramWidget* dw = new DiagramWidget(_diagram, page);
+	DiagramWidget* dw = new DiagramWidget(_diagram, page, nullptr, paintNow);
 	auto* dock = new ads::CDockWidget(page->name());
 	dock->setIcon(QEICN_diagram_page_title);
 	dock->setWidget(dw);
@@ -2453,6 +2899,41 @@ void MainWindow::markUnchanged()
 	}
 }
 
+void MainWindow::onUndoIndexChanged(int index)
+{
+	int last = std::exchange(journalUndoIndex, index);
+	if (!journal.isActive())
+		return;
+
+	JournalTouch touch;
+	// 宏命令（QUndoStack::beginMacro）本身是普通的QUndoCommand，按子命令处理
+	std::function<void(const QUndoCommand*)> collect = [&](const QUndoCommand* cmd) {
+		if (!cmd || touch.full)
+			return;
+		if (auto* jc = dynamic_cast<const qecmd::JournaledCommand*>(cmd)) {
+			jc->journalTouched(touch);
+		}
+		else if (typeid(*cmd) == typeid(QUndoCommand) && cmd->childCount() > 0) {
+			for (int i = 0; i < cmd->childCount(); i++)
+				collect(cmd->child(i));
+		}
+		else {
+			touch.full = true;
+		}
+	};
+
+	if (index == last) {
+		// 合并（mergeWith）或者达到撤销上限：最后一条命令被更新
+		if (index > 0)
+			collect(undoStack->command(index - 1));
+	}
+	else {
+		for (int i = std::min(index, last); i < std::max(index, last); i++)
+			collect(undoStack->command(i));
+	}
+	journal.record(touch);
+}
+
 void MainWindow::focusInPage(std::shared_ptr<DiagramPage> page)
 {
 	contextPage->setPage(page);
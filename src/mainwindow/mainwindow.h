@@ -2,10 +2,13 @@
 
 #ifndef QETRC_MOBILE_2
 #include <QList>
+#include <QPointer>
+#include <functional>
 
 #include "kernel/diagramwidget.h"
 #include "SARibbonMainWindow.h"
 #include "data/diagram/diagram.h"
+#include "data/diagram/diagramjournal.h"
 #include "data/common/qeglobal.h"  // for shared_ptr<Railway> meta-decl
 
 class SARibbonMenu;
@@ -29,6 +32,7 @@ class RailStationWidget;
 class RoutingWidget;
 class PathListWidget;
 struct ChangeStationNameData;
+struct DiagramDirty;
 class LocateDialog;
 class RailDBContext;
 namespace ads{
@@ -49,6 +53,13 @@ class MainWindow : public SARibbonMainWindow
 {
     Q_OBJECT
     Diagram _diagram;
+
+    /**
+     * 2026.10.19  编辑日志；journalUndoIndex为日志已经记录到的撤销栈位置
+     */
+    DiagramJournal journal{ _diagram };
+    int journalUndoIndex = 0;
+
     ads::CDockManager* manager;
     QUndoStack* undoStack;
     QUndoView* undoView;
@@ -89,6 +100,12 @@ class MainWindow : public SARibbonMainWindow
     LocateDialog* locateDialog = nullptr;
     GreedyPaintWizard* greedyWidget = nullptr;
 
+    /**
+     * 2026.10.19  进行中的后台保存（至多一个），见saveGraphInBackground()
+     */
+    struct PendingSave;
+    std::shared_ptr<PendingSave> pendingSave;
+
     /**
      * 可能在多个地方使用到的action，包装一下
      */
@@ -130,13 +147,13 @@ public:
     /**
      * 调用前，应当已经把Page加入到Diagram中
      */
-    void addPageWidget(std::shared_ptr<DiagramPage> page);
+    void addPageWidget(std::shared_ptr<DiagramPage> page, bool paintNow = true);
 
     /**
      * 插入操作，用来撤销删除。
      * 注意dock与diagram的顺序应当完全一致！！
      */
-    void insertPageWidget(std::shared_ptr<DiagramPage> page, int index);
+    void insertPageWidget(std::shared_ptr<DiagramPage> page, int index, bool paintNow = true);
 
     auto* getManager() { return manager; }
 
@@ -211,20 +228,78 @@ private:
 
     /**
      * 重置操作之后调用
+     * 2026.10.19: progressive见resetDiagramPages
      */
-    void endResetGraph();
+    void endResetGraph(bool progressive = false);
 
     /**
      * 打开新运行图时的操作
      * 每个Page添加一个窗口
      */
-    void resetDiagramPages();
+    void resetDiagramPages(bool progressive = false);
+
+    /**
+     * 2026.10.19  依次铺画所给的运行图窗口，每次一个，之间让出事件循环。已经关闭的窗口跳过。
+     */
+    void paintPagesProgressively(QList<QPointer<DiagramWidget>> widgets);
 
     /**
      * 打开运行图 返回是否成功
+     * 2026.10.19: 同步版本，用于启动时；用户操作使用openGraphAsync
      */
     bool openGraph(const QString& filename);
 
+    /**
+     * 2026.10.19  打开运行图的中间结果。
+     * loadGraphFile()可以在工作线程中执行（读取、解析、绑定，可以取消），
+     * 结果由applyLoadedGraph()在GUI线程中接管（move进_diagram）。
+     */
+    struct OpenResult;
+    bool openingGraph = false;
+
+    /**
+     * 2026.10.19  异步打开：读取、解析、绑定在工作线程中进行，进度对话框可以取消，
+     * 取消时当前运行图不受影响。各阶段用时输出到日志。
+     * 接管数据后，列表等立即可用，运行图页面逐个铺画。
+     */
+    void openGraphAsync(const QString& filename);
+
+    /**
+     * askRecover(n)：是否恢复日志中n条未保存的修改；stage(label, value)：进度（0-100）
+     */
+    static bool loadGraphFile(OpenResult& res, const std::function<bool(int)>& askRecover,
+        const std::function<void(const QString&, int)>& stage);
+
+    bool applyLoadedGraph(OpenResult& res, bool progressive);
+
+    bool askRecoverJournal(const QString& filename, int count);
+
+    /**
+     * 2026.10.19  后台保存到当前文件名，或另存为saveAsName。
+     * 在GUI线程生成快照（Diagram::saveSnapshot），序列化和写文件在工作线程中进行，
+     * 期间可以继续编辑。完成后在状态栏显示用时和文件大小；
+     * 仅当撤销栈在保存期间没有变化时，才标记为未修改。
+     * 另存为时，写入成功后才改用新文件名（最近文件、标题、日志随之更新）。
+     * 编辑日志同样在写入成功后才重新开始，写入中途崩溃时仍可从原日志恢复。
+     */
+    void saveGraphInBackground(const QString& saveAsName = {});
+
+    /**
+     * 2026.10.19  阻塞等待进行中的后台保存完成并处理结果。
+     * 关闭窗口、清理运行图前调用。没有失败（包括没有进行中的保存）时返回true。
+     */
+    bool waitForPendingSave();
+
+    /**
+     * 处理后台保存的结果。由waitForPendingSave()或工作线程结束时调用。
+     */
+    bool finishBackgroundSave();
+
+    /**
+     * 2026.10.19  增量保存：只在编辑日志中确认此前的修改（见SystemJson::journal_incremental_save）
+     */
+    void saveGraphIncremental();
+
     
 
     void updateWindowTitle();
@@ -296,6 +371,12 @@ private slots:
 
     void markUnchanged();
 
+    /**
+     * 2026.10.19  撤销栈变化时，将涉及的命令记入编辑日志。
+     * 实现了qecmd::JournaledCommand的命令按对象增量记录，其他命令记录完整快照。
+     */
+    void onUndoIndexChanged(int index);
+
     /**
      * 引起contextMenu展示或者隐藏的操作
      */
@@ -331,6 +412,12 @@ private slots:
      */
     void updateAllDiagrams();
 
+    /**
+     * 2026.10.19  增量刷新：由Diagram::refreshDirty()重新绑定受影响的车次，
+     * 整页重绘包含脏线路的页面，其余页面只重绘受影响车次的运行线，并更新相关面板。
+     */
+    void refreshDirty(DiagramDirty& dirty);
+
     void updatePageDiagram(std::shared_ptr<DiagramPage> pg);
 
     /**
@@ -385,6 +472,13 @@ private slots:
 
     void showAboutDialog();
 
+    /**
+     * 2026.10.19  性能记录（qetrace）：开始/停止、导出为Chrome trace、在输出窗口汇总
+     */
+    void actToggleTrace(bool on);
+    void actExportTrace();
+    void actTraceSummary();
+
 #if 0
     // 2024.03.28: For switching Ribbon style, use SystemJsonDialog
     void useWpsStyle();
@@ -545,6 +639,12 @@ public slots:
      */
     void applyChangeStationName(const ChangeStationNameData& data);
 
+    /**
+     * 2026.10.19  全局站名修改执行（undo/redo）之后：只重绘涉及的线路所在的页面，
+     * 不再全部刷新（refreshAll）。站名修改不影响绑定，不重新绑定。
+     */
+    void commitChangeStationName(const ChangeStationNameData& data);
+
     void setRoutingHighlight(std::shared_ptr<Routing> routing, bool on);
 
     /**
@@ -1068,6 +1068,11 @@ void qecmd::UpdateForbidData::redo()
 	cont->commitForbidChange(forbid);
 }
 
+void qecmd::UpdateForbidData::journalTouched(JournalTouch& touch) const
+{
+	touch.railways.push_back(forbid->railway());
+}
+
 qecmd::ToggleForbidShow::ToggleForbidShow(std::shared_ptr<Forbid> forbid_,
 	Direction dir_, RailContext* context, QUndoCommand* parent):
 	QUndoCommand(parent),forbid(forbid_),dir(dir_),cont(context)
@@ -1088,6 +1093,11 @@ void qecmd::ToggleForbidShow::redo()
 	cont->commitToggleForbidShow(forbid, dir);
 }
 
+void qecmd::ToggleForbidShow::journalTouched(JournalTouch& touch) const
+{
+	touch.railways.push_back(forbid->railway());
+}
+
 qecmd::UpdateRailNote::UpdateRailNote(std::shared_ptr<Railway> railway, 
 	const RailInfoNote& data, QUndoCommand* parent):
 	QUndoCommand(QObject::tr("更新线路备注: %1").arg(railway->name()),parent),
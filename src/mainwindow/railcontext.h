@@ -4,6 +4,7 @@
 #include <QUndoCommand>
 #include <QList>
 #include <memory>
+#include "data/diagram/diagramjournal.h"
 
 #include "data/common/direction.h"
 #include "data/rail/railinfonote.h"
@@ -330,7 +331,7 @@ namespace qecmd {
     };
 
 
-    class UpdateRailStations :public QUndoCommand {
+    class UpdateRailStations :public QUndoCommand, public JournaledCommand {
         RailContext* const cont;
         std::shared_ptr<Railway> railold, railnew;
         bool equiv;
@@ -341,10 +342,12 @@ namespace qecmd {
             QUndoCommand* parent = nullptr);
         virtual void undo()override;
         virtual void redo()override;
+        // 子命令RebindTrainsByPaths只改变绑定，不影响保存的数据
+        virtual void journalTouched(JournalTouch& touch)const override { touch.railways.push_back(railold); }
     };
 
 
-    class UpdateForbidData :public QUndoCommand {
+    class UpdateForbidData :public QUndoCommand, public JournaledCommand {
         std::shared_ptr<Forbid> forbid;
         std::shared_ptr<Railway> data;
         RailContext* const cont;
@@ -353,9 +356,10 @@ namespace qecmd {
             RailContext* context, QUndoCommand* parent=nullptr);
         virtual void undo()override;
         virtual void redo()override;
+        virtual void journalTouched(JournalTouch& touch)const override;
     };
 
-    class ToggleForbidShow :public QUndoCommand {
+    class ToggleForbidShow :public QUndoCommand, public JournaledCommand {
         std::shared_ptr<Forbid> forbid;
         Direction dir;
         RailContext* const cont;
@@ -364,10 +368,11 @@ namespace qecmd {
             QUndoCommand* parent = nullptr);
         virtual void undo()override;
         virtual void redo()override;
+        virtual void journalTouched(JournalTouch& touch)const override;
     };
 
 
-    class ChangeOrdinate :public QUndoCommand {
+    class ChangeOrdinate :public QUndoCommand, public JournaledCommand {
         RailContext* const cont;
         std::shared_ptr<Railway> rail;
         int index;
@@ -378,12 +383,13 @@ namespace qecmd {
 
         virtual void undo()override;
         virtual void redo()override;
+        virtual void journalTouched(JournalTouch& touch)const override { touch.railways.push_back(rail); }
     };
 
     /**
      * 添加空白标尺。注意只能处理空白标尺的情况，直接调用Railway添加空白标尺的方法。
      */
-    class AddNewRuler :public QUndoCommand {
+    class AddNewRuler :public QUndoCommand, public JournaledCommand {
         RailContext* const cont;
         QString name;
         std::shared_ptr<Railway> railway;
@@ -394,9 +400,10 @@ namespace qecmd {
             QUndoCommand(parent),cont(context),name(name_),  railway(railway_){}
         virtual void undo()override;
         virtual void redo()override;
+        virtual void journalTouched(JournalTouch& touch)const override { touch.railways.push_back(railway); }
     };
 
-    class UpdateRailNote : public QUndoCommand {
+    class UpdateRailNote : public QUndoCommand, public JournaledCommand {
         std::shared_ptr<Railway> railway;
         RailInfoNote data;
     public :
@@ -404,9 +411,10 @@ namespace qecmd {
             QUndoCommand* parent = nullptr);
         void undo()override;
         void redo()override;
+        void journalTouched(JournalTouch& touch)const override { touch.railways.push_back(railway); }
     };
 
-    class SaveTrackOrder : public QUndoCommand
+    class SaveTrackOrder : public QUndoCommand, public JournaledCommand
     {
         std::shared_ptr<Railway> railway;
         std::shared_ptr<RailStation> station;
@@ -416,6 +424,7 @@ namespace qecmd {
             const QList<QString>& order, QUndoCommand* parent = nullptr);
         void undo()override;
         void redo()override;
+        void journalTouched(JournalTouch& touch)const override { touch.railways.push_back(railway); }
     };
 
     class SaveTrackToTimetable :public QUndoCommand {
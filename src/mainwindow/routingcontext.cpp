@@ -581,6 +581,13 @@ void qecmd::BatchChangeRoutings::redo()
     cont->commitBatchRoutingUpdate(indexes, routings);
 }
 
+void qecmd::BatchChangeRoutings::journalTouched(JournalTouch& touch) const
+{
+    auto& coll = cont->diagram().trainCollection();
+    for (int index : indexes)
+        touch.routings.push_back(coll.routingAt(index));
+}
+
 #endif
 
 qecmd::SplitRouting::SplitRouting(std::shared_ptr<Routing> routing, std::vector<SplitRoutingData>&& data_, 
@@ -615,4 +622,12 @@ qecmd::SplitRouting::SplitRouting(std::shared_ptr<Routing> routing, std::vector<
     }
 }
 
-
+void qecmd::SplitRouting::journalTouched(JournalTouch& touch) const
+{
+    for (int i = 0; i < childCount(); i++) {
+        if (auto* jc = dynamic_cast<const JournaledCommand*>(child(i)))
+            jc->journalTouched(touch);
+        else
+            touch.full = true;
+    }
+}
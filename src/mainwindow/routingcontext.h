@@ -9,6 +9,7 @@
 #include <QList>
 #include <memory>
 #include <vector>
+#include "data/diagram/diagramjournal.h"
 #include "editors/routing/routingedit.h"
 
 class Routing;
@@ -41,6 +42,7 @@ public:
     explicit RoutingContext(Diagram& diagram, SARibbonContextCategory* context, MainWindow* mw_);
     auto routing(){return _routing;}
     auto* context(){return cont;}
+    auto& diagram(){return _diagram;}
 private:
     void initUI();
     int getRoutingWidgetIndex(std::shared_ptr<Routing> routing);
@@ -142,7 +144,7 @@ public slots:
 };
 
 namespace qecmd {
-    class ChangeRoutingInfo :public QUndoCommand
+    class ChangeRoutingInfo :public QUndoCommand, public JournaledCommand
     {
         std::shared_ptr<Routing> routing, info;
         RoutingContext* const cont;
@@ -151,9 +153,10 @@ namespace qecmd {
             RoutingContext* context, QUndoCommand* parent = nullptr);
         virtual void undo()override;
         virtual void redo()override;
+        virtual void journalTouched(JournalTouch& touch)const override { touch.routings.push_back(routing); }
     };
 
-    class ChangeRoutingOrder :public QUndoCommand
+    class ChangeRoutingOrder :public QUndoCommand, public JournaledCommand
     {
         std::shared_ptr<Routing> routing, data;
         RoutingContext* const cont;
@@ -162,11 +165,12 @@ namespace qecmd {
             RoutingContext* context, QUndoCommand* parent = nullptr);
         virtual void undo()override;
         virtual void redo()override;
+        virtual void journalTouched(JournalTouch& touch)const override { touch.routings.push_back(routing); }
     private:
         void commit();
     };
 
-    class BatchChangeRoutings :public QUndoCommand
+    class BatchChangeRoutings :public QUndoCommand, public JournaledCommand
     {
         QVector<int> indexes;
         QVector<std::shared_ptr<Routing>> routings;
@@ -179,10 +183,11 @@ namespace qecmd {
             indexes(indexes_),routings(routings_),cont(context){}
         virtual void undo()override;
         virtual void redo()override;
+        virtual void journalTouched(JournalTouch& touch)const override;
     };
 
 
-    class SplitRouting : public QUndoCommand
+    class SplitRouting : public QUndoCommand, public JournaledCommand
     {
         std::shared_ptr<Routing> routing;
         std::vector<SplitRoutingData> data;
@@ -190,6 +195,8 @@ namespace qecmd {
     public:
         SplitRouting(std::shared_ptr<Routing> routing, std::vector<SplitRoutingData>&& data,
             RoutingContext* cont, RoutingWidget* rw, QUndoCommand* parent = nullptr);
+        // 子命令（ChangeRoutingOrder、AddRouting）都可以增量记录
+        virtual void journalTouched(JournalTouch& touch)const override;
     };
 
 }
@@ -391,6 +391,11 @@ void qecmd::UpdateRuler::redo()
     cont->commitRulerChange(ruler);
 }
 
+void qecmd::UpdateRuler::journalTouched(JournalTouch& touch) const
+{
+    touch.railways.push_back(ruler->railway());
+}
+
 void qecmd::ChangeRulerName::undo()
 {
     std::swap(ruler->nameRef(), name);
@@ -403,6 +408,11 @@ void qecmd::ChangeRulerName::redo()
     cont->commitChangeRulerName(ruler);
 }
 
+void qecmd::ChangeRulerName::journalTouched(JournalTouch& touch) const
+{
+    touch.railways.push_back(ruler->railway());
+}
+
 qecmd::RemoveRuler::RemoveRuler(std::shared_ptr<Ruler> ruler_, std::shared_ptr<Railway> data_,
                       bool ordinate, RulerContext *context, QUndoCommand *parent):
     QUndoCommand(QObject::tr("删除标尺: ")+ruler_->name(),parent),
@@ -424,4 +434,9 @@ void qecmd::RemoveRuler::redo()
     cont->commitRemoveRuler(ruler, isOrd);
 }
 
+void qecmd::RemoveRuler::journalTouched(JournalTouch& touch) const
+{
+    touch.railways.push_back(ruler->railway());
+}
+
 #endif
@@ -6,6 +6,7 @@
 #include <QString>
 #include <SARibbonContextCategory.h>
 #include <QLineEdit>
+#include "data/diagram/diagramjournal.h"
 
 class Railway;
 class Diagram;
@@ -126,7 +127,7 @@ private slots:
 
 
 namespace qecmd {
-    class UpdateRuler :public QUndoCommand {
+    class UpdateRuler :public QUndoCommand, public JournaledCommand {
         std::shared_ptr<Ruler> ruler;
         std::shared_ptr<Railway> nr;
         RulerContext* cont;
@@ -135,9 +136,10 @@ namespace qecmd {
             RulerContext* context, QUndoCommand* parent=nullptr);
         virtual void undo()override;
         virtual void redo()override;
+        virtual void journalTouched(JournalTouch& touch)const override;
     };
 
-    class ChangeRulerName :public QUndoCommand {
+    class ChangeRulerName :public QUndoCommand, public JournaledCommand {
         std::shared_ptr<Ruler> ruler;
         QString name;
         RulerContext*const cont;
@@ -148,9 +150,11 @@ namespace qecmd {
             ruler(ruler_),name(name_),cont(context){}
         virtual void undo()override;
         virtual void redo()override;
+        // 标尺名只在所属线路的数据中引用（排图标尺）
+        virtual void journalTouched(JournalTouch& touch)const override;
     };
 
-    class RemoveRuler :public QUndoCommand {
+    class RemoveRuler :public QUndoCommand, public JournaledCommand {
         std::shared_ptr<Ruler> ruler;    //这只是个头结点
         std::shared_ptr<Railway> data;
         bool isOrd;
@@ -161,7 +165,7 @@ namespace qecmd {
             bool ordinate, RulerContext* context,QUndoCommand* parent=nullptr);
         virtual void undo()override;
         virtual void redo()override;
-
+        virtual void journalTouched(JournalTouch& touch)const override;
     };
 }
 
@@ -20,6 +20,7 @@
 #include "railcontext.h"
 #include "routingcontext.h"
 #include "data/diagram/trainadapter.h"
+#include "data/trainpath/trainpathbinding.h"
 
 #include <DockManager.h>
 
@@ -547,6 +548,8 @@ void TrainContext::commitTimetableChange(std::shared_ptr<Train> train, std::shar
 
 void TrainContext::onTrainStationTimeChanged(std::shared_ptr<Train> train, bool repaint)
 {
+	// 2026.10.19: 时刻表被原地修改（运行线对象不变），依赖tempVersion的缓存据此失效
+	train->invalidateTempData();
 	updateTrainWidget(train);
 	if (repaint) {
 		mw->repaintTrainLines(train);
@@ -803,47 +806,62 @@ void TrainContext::actAutoCorrectionAll()
 
 void TrainContext::actAutoCorrectionBat(const QList<std::shared_ptr<Train>>& trainRange)
 {
-	auto res = QMessageBox::question(mw, tr("自动批量更正"),
+	QMessageBox box(QMessageBox::Question, tr("自动批量更正"),
 		tr("此功能以内置算法，尝试自动更正时刻表中可能的顺序错误问题。\n"
 			"请注意此功能未经过充分测试，不一定能解决问题。建议做好数据保存和备份。\n"
-			"是否继续？"));
-	if (res != QMessageBox::Yes)
+			"选择[仅统计]时只统计可更正的车次和修正数量，不修改数据；"
+			"各车次的修正数量输出到日志。\n"
+			"是否继续？"), QMessageBox::Cancel, mw);
+	auto* btApply = box.addButton(tr("更正"), QMessageBox::AcceptRole);
+	auto* btDry = box.addButton(tr("仅统计"), QMessageBox::ActionRole);
+	box.exec();
+	if (box.clickedButton() != btApply && box.clickedButton() != btDry)
 		return;
-	QVector<std::shared_ptr<Train>> modified, data;
+	bool dryRun = (box.clickedButton() == btDry);
 
 	auto clk_beg = std::chrono::system_clock::now();
 
-	foreach(auto train, trainRange) {
-		auto t = std::make_shared<Train>(*train);
-		bool flag = TimetableCorrector::autoCorrectSafe(t);
-		if (flag) {
-			//qDebug() << "Auto correct " << train->trainName().full()<<" "<< train.get() << Qt::endl;
-			//qDebug() << "Data at: " << t.get();
-			//train->show();
-
-			modified.push_back(train);
-			data.push_back(t);
-		}
-		else {
-			// 析构掉
-			t.reset();
-		}
-	}
-
+	// 2026.10.19: 在工作线程上并行更正副本，主线程只负责汇总和压栈
+	auto items = TimetableCorrector::batchCorrect(trainRange, dryRun);
 
 	auto clk_end = std::chrono::system_clock::now();
 
 	using namespace std::chrono_literals;
 	mw->showStatus(QObject::tr("自动时刻表更正  用时 %1 毫秒").arg((clk_end - clk_beg) / 1ms));
 
-	if (modified.empty()) {
+	QVector<std::shared_ptr<Train>> modified, data;
+	int totalFixes = 0, failedCount = 0;
+	for (auto& item : items) {
+		totalFixes += item.fixCount;
+		if (item.failed) {
+			failedCount++;
+			qWarning() << tr("自动更正 %1: 更正过程出错，已修正%2处").arg(
+				item.train->trainName().full()).arg(item.fixCount);
+		}
+		else {
+			qInfo() << tr("自动更正 %1: %2处").arg(
+				item.train->trainName().full()).arg(item.fixCount);
+		}
+		if (item.corrected) {
+			modified.push_back(item.train);
+			data.push_back(std::move(item.corrected));
+		}
+	}
+
+	if (dryRun) {
+		QMessageBox::information(mw, tr("提示"), tr("统计完成，共%1个车次可更正，合计%2处修正；"
+			"其中%3个车次更正过程出错。未修改数据。").arg(static_cast<int>(items.size()) - failedCount)
+			.arg(totalFixes).arg(failedCount));
+	}
+	else if (modified.empty()) {
 		QMessageBox::information(mw, tr("提示"), tr("应用完成，没有更改被执行"));
 	}
 	else {
 		int sz = modified.size();
 		mw->getUndoStack()->push(new qecmd::BatchAutoCorrection(std::move(modified), std::move(data),
 			this));
-		QMessageBox::information(mw, tr("提示"), tr("应用完成，共%1个车次受到影响。").arg(sz));
+		QMessageBox::information(mw, tr("提示"), tr("应用完成，共%1个车次受到影响，合计%2处修正。")
+			.arg(sz).arg(totalFixes));
 	}
 }
 
@@ -2102,16 +2120,23 @@ void qecmd::RemoveTrainsSimple::redo()
 qecmd::RemoveTrains::RemoveTrains(const QList<std::shared_ptr<Train>>& trains,
 	const QList<int>& indexes, TrainCollection& coll_, TrainListModel* model_,
 	TrainContext* cont, QUndoCommand* parent) :
-	QUndoCommand(QObject::tr("删除%1个车次").arg(trains.size()), parent)
+	QUndoCommand(QObject::tr("删除%1个车次").arg(trains.size()), parent), _trains(trains)
 {
 	foreach(auto train, trains) {
 		if (!train->paths().empty()) {
 			new ClearPathsFromTrain(train, cont, this);
+			_withPaths = true;
 		}
 	}
 	new RemoveTrainsSimple(trains, indexes, coll_, model_, this);
 }
 
+void qecmd::RemoveTrains::journalTouched(JournalTouch& touch) const
+{
+	touch.trains.insert(touch.trains.end(), _trains.begin(), _trains.end());
+	touch.full = touch.full || _withPaths;
+}
+
 
 qecmd::RemoveSingleTrainSimple::RemoveSingleTrainSimple(DiagramNaviModel* navi_,
 	std::shared_ptr<Train> train_, int index_, QUndoCommand* parent) :
@@ -2130,7 +2155,7 @@ void qecmd::RemoveSingleTrainSimple::redo()
 
 qecmd::RemoveSingleTrain::RemoveSingleTrain(TrainContext* cont, DiagramNaviModel* navi_, 
 	std::shared_ptr<Train> train_, int index_, QUndoCommand* parent):
-	QUndoCommand(QObject::tr("删除列车: ") + train_->trainName().full(), parent)
+	QUndoCommand(QObject::tr("删除列车: ") + train_->trainName().full(), parent), _train(train_)
 {
 	if (!train_->paths().empty()) {
 		new ClearPathsFromTrain(train_, cont, this);
@@ -2138,6 +2163,12 @@ qecmd::RemoveSingleTrain::RemoveSingleTrain(TrainContext* cont, DiagramNaviModel
 	new RemoveSingleTrainSimple(navi_, train_, index_, this);
 }
 
+void qecmd::RemoveSingleTrain::journalTouched(JournalTouch& touch) const
+{
+	touch.trains.push_back(_train);
+	touch.full = touch.full || (childCount() > 1);   // 带有ClearPathsFromTrain
+}
+
 qecmd::RebindTrainsByPaths::RebindTrainsByPaths(std::vector<std::shared_ptr<Train>>&& trains_, 
 	TrainContext* cont, QUndoCommand* parent):
 	QUndoCommand(QObject::tr("重新铺画%1列车").arg(trains_.size()), parent),
@@ -2164,8 +2195,9 @@ void qecmd::RebindTrainsByPaths::redo()
 		for (auto train : trains) {
 			assert(!train->paths().empty());
 			adapters.emplace_back(std::move(train->adapters()));
-			train->bindWithPath();
 		}
+		// 2026.10.19  each path is resolved once, and the trains are bound in parallel
+		TrainPathBinding::bindTrains(trains);
 
 		first = false;
 	}
@@ -9,6 +9,7 @@
 #include <QSet>
 
 #include <data/train/train.h>
+#include "data/diagram/diagramjournal.h"
 
 class SARibbonContextCategory;
 class SARibbonLineEdit;
@@ -38,7 +39,7 @@ class CDockWidget;
 class TrainContext;
 
 namespace qecmd {
-    class AutoTrainType :public QUndoCommand {
+    class AutoTrainType :public QUndoCommand, public JournaledCommand {
     public:
         using data_t = std::deque<std::pair<std::shared_ptr<Train>, std::shared_ptr<TrainType>>>;
         AutoTrainType(data_t&& d, TrainContext* context, QUndoCommand* parent = nullptr) :
@@ -46,13 +47,17 @@ namespace qecmd {
             cont(context) {}
         virtual void undo()override;
         virtual void redo()override;
+        virtual void journalTouched(JournalTouch& touch)const override {
+            for (const auto& p : data)
+                touch.trains.push_back(p.first);
+        }
     private:
         data_t data;
         TrainContext* const cont;
         void commit();
     };
 
-    class AutoTrainPen : public QUndoCommand {
+    class AutoTrainPen : public QUndoCommand, public JournaledCommand {
         std::deque<std::shared_ptr<Train>> _trains;
         std::deque<QPen> _pens;
         TrainContext* const cont;
@@ -61,6 +66,9 @@ namespace qecmd {
             TrainContext* context, QUndoCommand* parent = nullptr);
         virtual void undo()override;
         virtual void redo()override;
+        virtual void journalTouched(JournalTouch& touch)const override {
+            touch.trains.insert(touch.trains.end(), _trains.begin(), _trains.end());
+        }
     };
 }
 
@@ -457,7 +465,7 @@ private slots:
 
 namespace qecmd {
     class ChangeTimetable :
-        public QUndoCommand
+        public QUndoCommand, public JournaledCommand
     {
         std::shared_ptr<Train> train, table;
         TrainContext* const cont;
@@ -466,10 +474,11 @@ namespace qecmd {
             TrainContext* context, QUndoCommand* parent = nullptr);
         virtual void undo()override;
         virtual void redo()override;
+        virtual void journalTouched(JournalTouch& touch)const override { touch.trains.push_back(train); }
     };
 
     class UpdateTrainInfo :
-        public QUndoCommand
+        public QUndoCommand, public JournaledCommand
     {
         std::shared_ptr<Train> train, info;
         TrainContext* const cont;
@@ -484,10 +493,20 @@ namespace qecmd {
         virtual void redo()override {
             cont->commitTraininfoChange(train, info);
         }
+        /**
+         * 径路、交路、筛选器按车次名引用车次，改名时只记录本车次会使它们失去该车次，
+         * 因此改名记为完整快照。执行后info保存的是另一侧的信息，两者车次名不同即为改名。
+         */
+        virtual void journalTouched(JournalTouch& touch)const override {
+            if (train->trainName().full() != info->trainName().full())
+                touch.full = true;
+            else
+                touch.trains.push_back(train);
+        }
     };
 
     class ExchangeTrainInterval :
-        public QUndoCommand {
+        public QUndoCommand, public JournaledCommand {
         std::shared_ptr<Train> train1, train2;
         Train::StationPtr start1, end1, start2, end2;
         bool includeStart, includeEnd;
@@ -506,6 +525,10 @@ namespace qecmd {
 
         virtual void undo()override;
         virtual void redo()override;
+        virtual void journalTouched(JournalTouch& touch)const override {
+            touch.trains.push_back(train1);
+            touch.trains.push_back(train2);
+        }
 
     private:
         void commit();
@@ -517,7 +540,7 @@ namespace qecmd {
         void commit();
     };
 
-    class AutoStartingTerminal :public QUndoCommand {
+    class AutoStartingTerminal :public QUndoCommand, public JournaledCommand {
         StartingTerminalData data;
         TrainContext* const cont;
     public:
@@ -527,13 +550,19 @@ namespace qecmd {
             data(data_),cont(context){}
         virtual void undo()override { commit(); }
         virtual void redo()override { commit(); }
+        virtual void journalTouched(JournalTouch& touch)const override {
+            for (const auto& p : data.startings)
+                touch.trains.push_back(p.first);
+            for (const auto& p : data.terminals)
+                touch.trains.push_back(p.first);
+        }
     private :
         void commit();
     };
 
 
 
-    class TimetableInterpolation :public QUndoCommand {
+    class TimetableInterpolation :public QUndoCommand, public JournaledCommand {
         QVector<std::shared_ptr<Train>> trains, data;
         TrainContext* const cont;
     public:
@@ -544,12 +573,15 @@ namespace qecmd {
             trains(trains),data(data),cont(context){}
         virtual void undo()override;
         virtual void redo()override;
+        virtual void journalTouched(JournalTouch& touch)const override {
+            touch.trains.insert(touch.trains.end(), trains.begin(), trains.end());
+        }
     };
 
     /**
      * 撤销所有推定结果：所有备注为“推定”的站直接删除
      */
-    class RemoveInterpolation :public QUndoCommand {
+    class RemoveInterpolation :public QUndoCommand, public JournaledCommand {
         QVector<std::shared_ptr<Train>> trains, data;
         TrainContext* const cont;
     public:
@@ -560,9 +592,12 @@ namespace qecmd {
             cont(cont){}
         void undo()override;
         void redo()override;
+        void journalTouched(JournalTouch& touch)const override {
+            touch.trains.insert(touch.trains.end(), trains.begin(), trains.end());
+        }
     };
 
-    class AutoBusiness :public QUndoCommand {
+    class AutoBusiness :public QUndoCommand, public JournaledCommand {
         QVector<std::shared_ptr<Train>> trains, data;
         TrainContext* const cont;
     public:
@@ -575,11 +610,14 @@ namespace qecmd {
 
         void undo()override;
         void redo()override;
+        void journalTouched(JournalTouch& touch)const override {
+            touch.trains.insert(touch.trains.end(), trains.begin(), trains.end());
+        }
     private:
         void commit();
     };
 
-    class BatchAutoCorrection :public QUndoCommand {
+    class BatchAutoCorrection :public QUndoCommand, public JournaledCommand {
         QVector<std::shared_ptr<Train>> trains, data;
         TrainContext* const cont;
     public:
@@ -592,6 +630,9 @@ namespace qecmd {
 
         void undo()override;
         void redo()override;
+        void journalTouched(JournalTouch& touch)const override {
+            touch.trains.insert(touch.trains.end(), trains.begin(), trains.end());
+        }
     private:
         void commit();
     };
@@ -612,7 +653,7 @@ namespace qecmd {
     * but called by dragging. 
     * The actual operation should be done inside this class.
      */
-    class DragTrainStationTime : public QUndoCommand
+    class DragTrainStationTime : public QUndoCommand, public JournaledCommand
     {
         std::shared_ptr<Train> train;
         int station_id;
@@ -630,6 +671,7 @@ namespace qecmd {
         virtual void redo()override;
         virtual int id()const override { return ID; }
         virtual bool mergeWith(const QUndoCommand* other)override;
+        virtual void journalTouched(JournalTouch& touch)const override { touch.trains.push_back(train); }
     private:
         void commit();
     };
@@ -638,7 +680,7 @@ namespace qecmd {
      * 2024.03.26: non-local dragging of timetable. 
      * This is different from ChangeTimetable, since the ADDRESSES of the stations should not change
      */
-    class DragNonLocalTime: public QUndoCommand
+    class DragNonLocalTime: public QUndoCommand, public JournaledCommand
     {
         std::shared_ptr<Train> train, data;
         int station_id;
@@ -655,6 +697,7 @@ namespace qecmd {
         virtual void redo()override;
         virtual int id()const override { return ID; }
         virtual bool mergeWith(const QUndoCommand* other)override;
+        virtual void journalTouched(JournalTouch& touch)const override { touch.trains.push_back(train); }
     };
 
     /**
@@ -719,20 +762,28 @@ namespace qecmd {
      * 2023.08.16  remove the trains. See also RemoveTrainsSimple (previous RemoveTrains)
      * Moved from TrainListModel.h/cpp
      */
-    class RemoveTrains : public QUndoCommand
+    class RemoveTrains : public QUndoCommand, public JournaledCommand
     {
+        QList<std::shared_ptr<Train>> _trains;
+        bool _withPaths = false;
     public:
         RemoveTrains(const QList<std::shared_ptr<Train>>& trains,
             const QList<int>& indexes, TrainCollection& coll_,
             TrainListModel* model_, TrainContext* cont,
             QUndoCommand* parent = nullptr);
+        /**
+         * 2026.10.19  涉及径路时（ClearPathsFromTrain）需要完整快照
+         */
+        virtual void journalTouched(JournalTouch& touch)const override;
     };
 
-    class RemoveSingleTrain : public QUndoCommand
+    class RemoveSingleTrain : public QUndoCommand, public JournaledCommand
     {
+        std::shared_ptr<Train> _train;
     public:
         RemoveSingleTrain(TrainContext* cont, DiagramNaviModel* navi_,
             std::shared_ptr<Train> train_, int index_, QUndoCommand* parent = nullptr);
+        virtual void journalTouched(JournalTouch& touch)const override;
     };
 
     /**
@@ -740,7 +791,7 @@ namespace qecmd {
      * On railway or path changed, re-bind all trains, and repaint their train lines.
      * Currently, the adapters are reserved, only calculated at the first time (ctor).
      */
-    class RebindTrainsByPaths : public QUndoCommand
+    class RebindTrainsByPaths : public QUndoCommand, public JournaledCommand
     {
         std::vector<std::shared_ptr<Train>> trains;
         std::vector<QVector<std::shared_ptr<TrainAdapter>>> adapters;
@@ -752,6 +803,8 @@ namespace qecmd {
 
         virtual void undo()override;
         virtual void redo()override;
+        // 只改变绑定，不影响保存的数据
+        virtual void journalTouched(JournalTouch&)const override {}
     };
 }
 
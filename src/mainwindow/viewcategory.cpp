@@ -493,8 +493,11 @@ void ViewCategory::actSaveConfigAsDefault()
 void ViewCategory::trainFilterApplied()
 {
     QVector<std::shared_ptr<TrainLine>> lines;
-    foreach(auto train, diagram.trainCollection().trains()) {
-        bool show = filter->check(train);
+    auto& coll = diagram.trainCollection();
+    const auto& shows = filter->getCore().checkAll(coll);
+    for (int i = 0; i < coll.trains().size(); i++) {
+        const auto& train = coll.trains().at(i);
+        bool show = shows[i];
         //qDebug() << train->trainName().full() << ", " << show;
         foreach(auto adp, train->adapters()) {
             foreach(auto line, adp->lines()) {
@@ -511,8 +514,11 @@ void ViewCategory::trainFilterApplied()
 void ViewCategory::predefTrainFilterApplied(const PredefTrainFilterCore* core)
 {
     QVector<std::shared_ptr<TrainLine>> lines;
-    foreach(auto train, diagram.trainCollection().trains()) {
-        bool show = core->check(train);
+    auto& coll = diagram.trainCollection();
+    const auto& shows = core->checkAll(coll);
+    for (int i = 0; i < coll.trains().size(); i++) {
+        const auto& train = coll.trains().at(i);
+        bool show = shows[i];
         //qDebug() << train->trainName().full() << ", " << show;
         foreach(auto adp, train->adapters()) {
             foreach(auto line, adp->lines()) {
@@ -8,6 +8,7 @@
 #include <map>
 #include "data/train/trainstation.h"
 #include "data/diagram/stationbinding.h"
+#include "data/diagram/diagramjournal.h"
 
 class Train;
 
@@ -146,7 +147,7 @@ namespace qecmd {
      * 注意如果此操作前面发生了时刻表提交更改操作，则TrainStation的地址不能保证不变。
      * 但在相同的状态下，行号是一定不变的。因此保存行号。保证行号为偶数。
      */
-    class AdjustTrainStationTime : public QUndoCommand
+    class AdjustTrainStationTime : public QUndoCommand, public JournaledCommand
     {
         std::shared_ptr<Train> train;
         int row;
@@ -163,6 +164,7 @@ namespace qecmd {
         virtual void redo()override;
         virtual int id()const override { return ID; }
         virtual bool mergeWith(const QUndoCommand* other)override;
+        virtual void journalTouched(JournalTouch& touch)const override { touch.trains.push_back(train); }
     };
 }
 
@@ -34,9 +34,19 @@ QVariant TrainListModel::data(const QModelIndex& index, int role) const
 		case ColStarting:return t->starting().toSingleLiteral();
 		case ColTerminal:return t->terminal().toSingleLiteral();
 		case ColType:return t->type()->name();
-		case ColMile:return QString::number(t->localMile(), 'f', 3);
-		case ColSpeed:return QString::number(t->localTraverseSpeed(), 'f', 3);
-		case ColTechSpeed: return QString::number(t->localTechSpeed(), 'f', 3);
+		//2026.10.19: 里程、速度从列式缓存读取，只检查本行是否过期
+		case ColMile: {
+			auto& summary = coll.summaryTable();
+			return QString::number(summary.miles()[summary.statRow(t)], 'f', 3);
+		}
+		case ColSpeed: {
+			auto& summary = coll.summaryTable();
+			return QString::number(summary.travSpeeds()[summary.statRow(t)], 'f', 3);
+		}
+		case ColTechSpeed: {
+			auto& summary = coll.summaryTable();
+			return QString::number(summary.techSpeeds()[summary.statRow(t)], 'f', 3);
+		}
 		}
 	}
 	else if (role == Qt::CheckStateRole) {
@@ -78,33 +88,23 @@ void TrainListModel::sort(int column, Qt::SortOrder order)
 	QList<std::shared_ptr<Train>> oldList(coll.trains());   //copy construct!!
 	beginResetModel();
 	auto& lst = coll.trains();
-	if (order == Qt::AscendingOrder) {
-		switch (column) {
-        case ColTrainName:std::stable_sort(lst.begin(), lst.end(), &Train::ltName); break;
-        case ColStarting:std::stable_sort(lst.begin(), lst.end(), &Train::ltStarting); break;
-        case ColTerminal:std::stable_sort(lst.begin(), lst.end(), &Train::ltTerminal); break;
-        case ColType:std::stable_sort(lst.begin(), lst.end(), &Train::ltType); break;
-        case ColShow:std::stable_sort(lst.begin(), lst.end(), &Train::ltShow); break;
-        case ColMile:std::stable_sort(lst.begin(), lst.end(), &Train::ltMile); break;
-        case ColSpeed:std::stable_sort(lst.begin(), lst.end(), &Train::ltTravSpeed); break;
-        case ColTechSpeed:std::stable_sort(lst.begin(), lst.end(), &Train::ltTechSpeed); break;
-		default:break;
-		}
-	}
-	else {
-		switch (column) {
-        case ColTrainName:std::stable_sort(lst.begin(), lst.end(), &Train::gtName); break;
-        case ColStarting:std::stable_sort(lst.begin(), lst.end(), &Train::gtStarting); break;
-        case ColTerminal:std::stable_sort(lst.begin(), lst.end(), &Train::gtTerminal); break;
-        case ColType:std::stable_sort(lst.begin(), lst.end(), &Train::gtType); break;
-        case ColShow:std::stable_sort(lst.begin(), lst.end(), &Train::gtShow); break;
-        case ColMile:std::stable_sort(lst.begin(), lst.end(), &Train::gtMile); break;
-        case ColSpeed:std::stable_sort(lst.begin(), lst.end(), &Train::gtTravSpeed); break;
-        case ColTechSpeed:std::stable_sort(lst.begin(), lst.end(), &Train::gtTechSpeed); break;
-		default:break;
-		}
+	const bool desc = (order == Qt::DescendingOrder);
+	//2026.10.19: 除始发、终到站外，都按列式缓存中的连续数据排序
+	auto& summary = coll.summaryTable();
+	switch (column) {
+	case ColTrainName:summary.sortTrains(lst, TrainSummaryTable::Key::Name, desc); break;
+	case ColType:summary.sortTrains(lst, TrainSummaryTable::Key::Type, desc); break;
+	case ColShow:summary.sortTrains(lst, TrainSummaryTable::Key::Show, desc); break;
+	case ColMile:summary.sortTrains(lst, TrainSummaryTable::Key::Mile, desc); break;
+	case ColSpeed:summary.sortTrains(lst, TrainSummaryTable::Key::TravSpeed, desc); break;
+	case ColTechSpeed:summary.sortTrains(lst, TrainSummaryTable::Key::TechSpeed, desc); break;
+	case ColStarting:std::stable_sort(lst.begin(), lst.end(),
+		desc ? &Train::gtStarting : &Train::ltStarting); break;
+	case ColTerminal:std::stable_sort(lst.begin(), lst.end(),
+		desc ? &Train::gtTerminal : &Train::ltTerminal); break;
+	default:break;
 	}
-	
+	coll.rebuildTrainIndex();
 	endResetModel();
 
 	if (oldList != lst) {
@@ -136,6 +136,7 @@ void TrainListModel::undoRedoSort(QList<std::shared_ptr<Train>>& lst)
 {
 	beginResetModel();
 	std::swap(coll.trains(), lst);
+	coll.rebuildTrainIndex();
 	endResetModel();
 }
 
@@ -143,10 +144,8 @@ void TrainListModel::redoRemoveTrains(const QList<std::shared_ptr<Train>>& train
 	const QList<int>& indexes)
 {
 	beginResetModel();
-	//注意：倒序遍历
-	for (auto p = indexes.rbegin(); p != indexes.rend(); ++p) {
-		std::shared_ptr<Train> train(coll.takeTrainAt(*p));   //move 
-	}
+	//2026.10.19: 批量删除，一次压缩
+	coll.takeTrainsAt(indexes);
 	endResetModel();
 	emit trainsRemovedRedone(trains);
 }
@@ -155,9 +154,7 @@ void TrainListModel::undoRemoveTrains(const QList<std::shared_ptr<Train>>& train
 	const QList<int>& indexes)
 {
 	beginResetModel();
-	for (int i = 0; i < trains.size(); i++) {
-		coll.insertTrainForUndo(indexes.at(i), trains.at(i));
-	}
+	coll.insertTrainsForUndo(indexes, trains);
 	endResetModel();
 	emit trainsRemovedUndone(trains);
 }
@@ -258,3 +255,9 @@ void qecmd::BatchChangeType::commit()
     }
     model->commitBatchChangeType(indexes);
 }
+
+void qecmd::BatchChangeType::journalTouched(JournalTouch& touch) const
+{
+    for (int index : indexes)
+        touch.trains.push_back(coll.trainAt(index));
+}
@@ -4,6 +4,7 @@
 #include <QAbstractTableModel>
 #include <QUndoCommand>
 #include <memory>
+#include "data/diagram/diagramjournal.h"
 
 class Train;
 class TrainCollection;
@@ -155,7 +156,7 @@ namespace qecmd {
         virtual bool mergeWith(const QUndoCommand* another)override;
     };
 
-    class BatchChangeType :public QUndoCommand {
+    class BatchChangeType :public QUndoCommand, public JournaledCommand {
         TrainCollection& coll;
         QVector<int> indexes;
         QVector<std::shared_ptr<TrainType>> types;
@@ -165,6 +166,7 @@ namespace qecmd {
             TrainListModel* model_, QUndoCommand* parent = nullptr);
         virtual void undo()override { commit(); }
         virtual void redo()override { commit(); }
+        virtual void journalTouched(JournalTouch& touch)const override;
     private:
         void commit();
     };
@@ -4,6 +4,7 @@
 
 #include <QUndoCommand>
 #include <QWidget>
+#include "data/diagram/diagramjournal.h"
 
 class Forbid;
 class Routing;
@@ -256,7 +257,7 @@ namespace qecmd {
      * 添加列车。并不限制是空白的。
      * 构造本类之前，应当先完成绑定操作。
      */
-    class AddNewTrain :public QUndoCommand {
+    class AddNewTrain :public QUndoCommand, public JournaledCommand {
         DiagramNaviModel* const navi;
         std::shared_ptr<Train> train;
     public:
@@ -264,9 +265,10 @@ namespace qecmd {
             QUndoCommand* parent=nullptr);
         virtual void undo()override;
         virtual void redo()override;
+        virtual void journalTouched(JournalTouch& touch)const override { touch.trains.push_back(train); }
     };
 
-    class BatchAddTrain : public QUndoCommand {
+    class BatchAddTrain : public QUndoCommand, public JournaledCommand {
         DiagramNaviModel* const navi;
         QVector<std::shared_ptr<Train>> trains;
     public:
@@ -277,6 +279,9 @@ namespace qecmd {
 
         virtual void undo()override;
         virtual void redo()override;
+        virtual void journalTouched(JournalTouch& touch)const override {
+            touch.trains.insert(touch.trains.end(), trains.begin(), trains.end());
+        }
     };
     
 
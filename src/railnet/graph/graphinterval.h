@@ -16,6 +16,7 @@ class ForbidNode;
  */
 struct GraphForbidNode{
     QTime beginTime,endTime;
+    GraphForbidNode()=default;
     GraphForbidNode(const ForbidNode& node);
     void exportToNode(ForbidNode& node)const;
 };
@@ -23,6 +24,7 @@ struct GraphForbidNode{
 struct GraphRulerNode{
     QString name;
     int interval,start,stop;
+    GraphRulerNode()=default;
     GraphRulerNode(const RulerNode& node);
     void exportToNode(RulerNode& node)const;
 };
@@ -0,0 +1,226 @@
+#include "kshortestpaths.h"
+
+#include <algorithm>
+#include <limits>
+#include <queue>
+#include <unordered_map>
+
+namespace {
+    constexpr double INF = std::numeric_limits<double>::infinity();
+
+    using queue_item_t = std::pair<double, int>;
+    using min_queue_t = std::priority_queue<queue_item_t, std::vector<queue_item_t>,
+        std::greater<queue_item_t>>;
+
+    int vertexIndex(const std::unordered_map<const RailNet::vertex*, int>& ids,
+        const std::shared_ptr<const RailNet::vertex>& v)
+    {
+        if (!v) return -1;
+        auto itr = ids.find(v.get());
+        return itr == ids.end() ? -1 : itr->second;
+    }
+}
+
+KShortestPaths::KShortestPaths(const RailNet& net, const std::shared_ptr<const vertex>& from,
+    const std::shared_ptr<const vertex>& to)
+{
+    const int n = static_cast<int>(net.size());
+    std::unordered_map<const vertex*, int> ids;
+    verts.reserve(n);
+    for (const auto& [_, v] : net.vertices()) {
+        ids.emplace(v.get(), static_cast<int>(verts.size()));
+        verts.emplace_back(v);
+    }
+    source = vertexIndex(ids, from);
+    target = vertexIndex(ids, to);
+    if (source < 0 || target < 0 || source == target)
+        return;
+
+    outBegin.assign(n + 1, 0);
+    std::vector<int> inBegin(n + 1, 0);
+    for (int u = 0; u < n; u++) {
+        for (auto e = verts[u]->out_edge; e; e = e->next_out) {
+            int v = vertexIndex(ids, e->to.lock());
+            if (v < 0 || v == u) continue;
+            outBegin[u + 1]++;
+            inBegin[v + 1]++;
+        }
+    }
+    for (int u = 0; u < n; u++) {
+        outBegin[u + 1] += outBegin[u];
+        inBegin[u + 1] += inBegin[u];
+    }
+    outFrom.resize(outBegin[n]);
+    outTo.resize(outBegin[n]);
+    outWeight.resize(outBegin[n]);
+    outEdge.resize(outBegin[n]);
+    std::vector<int> inFrom(inBegin[n]);
+    std::vector<double> inWeight(inBegin[n]);
+    std::vector<int> inPos(inBegin.begin(), inBegin.end() - 1);
+    for (int u = 0, pos = 0; u < n; u++) {
+        for (auto e = verts[u]->out_edge; e; e = e->next_out) {
+            int v = vertexIndex(ids, e->to.lock());
+            if (v < 0 || v == u) continue;
+            outFrom[pos] = u;
+            outTo[pos] = v;
+            outWeight[pos] = e->data.mile;
+            outEdge[pos] = e;
+            pos++;
+            inFrom[inPos[v]] = u;
+            inWeight[inPos[v]++] = e->data.mile;
+        }
+    }
+
+    // 反向Dijkstra：各点到终点的最短距离，作为A*的启发值
+    heuristic.assign(n, INF);
+    heuristic[target] = 0;
+    min_queue_t q;
+    q.emplace(0, target);
+    while (!q.empty()) {
+        auto [d, v] = q.top();
+        q.pop();
+        if (d > heuristic[v]) continue;
+        for (int i = inBegin[v]; i < inBegin[v + 1]; i++) {
+            int u = inFrom[i];
+            double nd = d + inWeight[i];
+            if (nd < heuristic[u]) {
+                heuristic[u] = nd;
+                q.emplace(nd, u);
+            }
+        }
+    }
+
+    dist.assign(n, INF);
+    parentArc.assign(n, -1);
+    distStamp.assign(n, 0);
+    bannedStamp.assign(n, 0);
+
+    // 第一条径路：没有禁止的结点
+    ++banStamp;
+    Found first;
+    if (heuristic[source] < INF &&
+        spurSearch(source, {}, first.verts, first.path, first.mile)) {
+        first.deviation = 0;
+        seen.insert(first.verts);
+        found.emplace_back(std::move(first));
+    }
+}
+
+int KShortestPaths::ensure(int k)
+{
+    while (size() < k && searchNext());
+    return std::min(size(), k);
+}
+
+bool KShortestPaths::exhausted() const
+{
+    return found.empty() || (candidates.empty() && found.back().deviation < 0);
+}
+
+bool KShortestPaths::searchNext()
+{
+    if (found.empty())
+        return false;
+
+    // 由最后找到的径路派生候选项（每条径路只派生一次，派生后deviation标记为-1）
+    auto& last = found.back();
+    if (last.deviation >= 0) {
+        const std::vector<int> lastVerts = last.verts;
+        const path_t lastPath = last.path;
+        const int deviation = last.deviation;
+        last.deviation = -1;
+
+        double rootMile = 0;
+        for (int i = 0; i < deviation; i++)
+            rootMile += lastPath[i]->data.mile;
+        for (int i = deviation; i + 1 < static_cast<int>(lastVerts.size()); i++) {
+            const int spur = lastVerts[i];
+            // 根路径上的结点不能再经过（无环）
+            ++banStamp;
+            for (int j = 0; j < i; j++)
+                bannedStamp[lastVerts[j]] = banStamp;
+            // 与已有径路共用根路径时，不能沿这些径路的下一步走
+            std::vector<int> bannedNext;
+            for (const auto& f : found) {
+                if (static_cast<int>(f.verts.size()) > i + 1 &&
+                    std::equal(f.verts.begin(), f.verts.begin() + i + 1, lastVerts.begin()))
+                    bannedNext.push_back(f.verts[i + 1]);
+            }
+
+            Found cand;
+            double spurMile;
+            path_t spurPath;
+            std::vector<int> spurVerts;
+            if (spurSearch(spur, bannedNext, spurVerts, spurPath, spurMile)) {
+                cand.verts.assign(lastVerts.begin(), lastVerts.begin() + i);
+                cand.verts.insert(cand.verts.end(), spurVerts.begin(), spurVerts.end());
+                if (seen.insert(cand.verts).second) {
+                    cand.path.assign(lastPath.begin(), lastPath.begin() + i);
+                    cand.path.insert(cand.path.end(), spurPath.begin(), spurPath.end());
+                    cand.mile = rootMile + spurMile;
+                    cand.deviation = i;
+                    candidates.insert(std::move(cand));
+                }
+            }
+            rootMile += lastPath[i]->data.mile;
+        }
+    }
+
+    if (candidates.empty())
+        return false;
+    found.push_back(std::move(candidates.extract(candidates.begin()).value()));
+    return true;
+}
+
+bool KShortestPaths::spurSearch(int spur, const std::vector<int>& bannedNext,
+    std::vector<int>& pathVerts, path_t& path, double& mile)
+{
+    const int distMark = ++searchStamp;
+    auto isBanned = [this](int v) { return bannedStamp[v] == banStamp; };
+    auto getDist = [&](int v) { return distStamp[v] == distMark ? dist[v] : INF; };
+
+    min_queue_t q;
+    dist[spur] = 0;
+    distStamp[spur] = distMark;
+    parentArc[spur] = -1;
+    q.emplace(heuristic[spur], spur);
+    bool reached = false;
+    while (!q.empty()) {
+        auto [f, u] = q.top();
+        q.pop();
+        const double d = getDist(u);
+        if (f > d + heuristic[u]) continue;
+        if (u == target) {
+            reached = true;
+            break;
+        }
+        for (int i = outBegin[u]; i < outBegin[u + 1]; i++) {
+            int v = outTo[i];
+            if (heuristic[v] == INF || isBanned(v)) continue;
+            if (u == spur && std::find(bannedNext.begin(), bannedNext.end(), v) != bannedNext.end())
+                continue;
+            double nd = d + outWeight[i];
+            if (nd < getDist(v)) {
+                dist[v] = nd;
+                distStamp[v] = distMark;
+                parentArc[v] = i;
+                q.emplace(nd + heuristic[v], v);
+            }
+        }
+    }
+    if (!reached)
+        return false;
+
+    pathVerts.clear();
+    path.clear();
+    mile = dist[target];
+    for (int v = target; v != spur;) {
+        int a = parentArc[v];
+        path.emplace_front(outEdge[a]);
+        pathVerts.push_back(v);
+        v = outFrom[a];
+    }
+    pathVerts.push_back(spur);
+    std::reverse(pathVerts.begin(), pathVerts.end());
+    return true;
+}
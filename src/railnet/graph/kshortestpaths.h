@@ -0,0 +1,79 @@
+#pragma once
+
+#include "railnet.h"
+
+#include <set>
+#include <vector>
+
+/**
+ * 2026.10.19  两点间前K短的无环径路（Yen算法），按里程从小到大逐条生成。
+ * 结点序列相同的径路视为同一条（平行边取最短者）。
+ * 偏离路径的搜索用A*：启发值为不加限制时到终点的最短距离（反向Dijkstra一次求得），
+ * 因此每次搜索基本只沿最短路树走，不会扩展整个线网。
+ * 径路按需计算：ensure(k)只在已有径路不足k条时继续生成。
+ * 对象引用net中的结点和边，使用期间net不能改动。
+ */
+class KShortestPaths
+{
+public:
+    using vertex = RailNet::vertex;
+    using edge = RailNet::edge;
+    using path_t = RailNet::path_t;
+
+private:
+    struct Found {
+        double mile;
+        std::vector<int> verts;    // 结点序号序列
+        path_t path;
+        int deviation;             // 与派生它的径路开始不同的位置；此前的偏离已经搜索过
+        bool operator<(const Found& other)const {
+            return mile < other.mile || (mile == other.mile && verts < other.verts);
+        }
+    };
+
+    int source = -1, target = -1;
+
+    // 线网的紧凑表示（CSR）
+    std::vector<std::shared_ptr<const vertex>> verts;
+    std::vector<int> outBegin, outFrom, outTo;
+    std::vector<double> outWeight;
+    std::vector<std::shared_ptr<const edge>> outEdge;
+    std::vector<double> heuristic;
+
+    std::vector<Found> found;
+    std::set<Found> candidates;
+    std::set<std::vector<int>> seen;
+
+    // A*搜索的临时数据，用stamp标记有效性，避免每次清空
+    std::vector<double> dist;
+    std::vector<int> parentArc, distStamp, bannedStamp;
+    int searchStamp = 0, banStamp = 0;
+
+public:
+    KShortestPaths(const RailNet& net, const std::shared_ptr<const vertex>& from,
+        const std::shared_ptr<const vertex>& to);
+
+    /**
+     * 保证至少计算出k条径路（如果存在），返回实际可得的条数（不超过k时即全部）。
+     */
+    int ensure(int k);
+
+    int size()const { return static_cast<int>(found.size()); }
+    const path_t& path(int i)const { return found.at(i).path; }
+    double mile(int i)const { return found.at(i).mile; }
+
+    /**
+     * 已经没有更多径路
+     */
+    bool exhausted()const;
+
+private:
+    bool searchNext();
+
+    /**
+     * 从spur到终点的A*搜索，不经过当前banStamp标记的结点，spur不直接走向bannedNext中的结点。
+     * 成功时返回true，结果写入verts/path/mile。
+     */
+    bool spurSearch(int spur, const std::vector<int>& bannedNext,
+        std::vector<int>& pathVerts, path_t& path, double& mile);
+};
@@ -3,6 +3,11 @@
 #include "data/rail/railcategory.h"
 #include "data/rail/forbid.h"
 #include "railnet/path/pathoperation.h"
+#include "railnetindex.h"
+
+#include <chrono>
+#include <cmath>
+#include <random>
 
 void RailNet::fromRailCategory(const RailCategory* cat)
 {
@@ -14,6 +19,64 @@ void RailNet::fromRailCategory(const RailCategory* cat)
     }
 }
 
+void RailNet::clear()
+{
+    di_graph::clear();
+    invalidateIndex();
+}
+
+void RailNet::buildIndex()
+{
+    _index = RailNetIndex::build(*this);
+}
+
+void RailNet::invalidateIndex()
+{
+    _index.reset();
+}
+
+RailNet::bench_ret_t RailNet::benchmarkIndex(int queries, unsigned seed) const
+{
+    bench_ret_t res;
+    if (!_index || empty())
+        return res;
+    std::vector<std::shared_ptr<const vertex>> verts;
+    verts.reserve(size());
+    for (const auto& [_, v] : vertices())
+        verts.emplace_back(v);
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<size_t> dist(0, verts.size() - 1);
+
+    using clock = std::chrono::steady_clock;
+    for (int i = 0; i < queries; i++) {
+        const auto& from = verts.at(dist(gen));
+        const auto& to = verts.at(dist(gen));
+        auto t0 = clock::now();
+        auto ret = sssp(from, &GraphInterval::getMile);
+        auto p1 = dump_path(from, to, ret);
+        auto t1 = clock::now();
+        auto p2 = _index->query(from, to);
+        auto t2 = clock::now();
+        res.ssspMicros += std::chrono::duration<double, std::micro>(t1 - t0).count();
+        res.indexMicros += std::chrono::duration<double, std::micro>(t2 - t1).count();
+        if (!p2 || std::abs(pathMile(p1) - pathMile(*p2)) > 1e-6)
+            res.mismatches++;
+        res.queries++;
+    }
+    return res;
+}
+
+RailNet::path_t RailNet::pointToPointPath(const std::shared_ptr<const vertex>& from,
+    const std::shared_ptr<const vertex>& to) const
+{
+    if (_index) {
+        if (auto path = _index->query(from, to))
+            return std::move(*path);
+    }
+    auto ret = sssp(from, &GraphInterval::getMile);
+    return dump_path(from, to, ret);
+}
+
 std::shared_ptr<RailNet::vertex> RailNet::stationByGeneralName(const StationName &name)
 {
     auto v=find_vertex(name);
@@ -157,8 +220,7 @@ RailNet::path_t RailNet::shortestPath(
         report->append(QObject::tr("出发站和到达站相同"));
         return {};
     }
-    auto ret=sssp(from, &GraphInterval::getMile);
-    auto t=dump_path(from,vert,ret);
+    auto t=pointToPointPath(from,vert);
     if (t.empty()){
         report->append(QObject::tr("目标站不可达"));
         return {};
@@ -175,6 +237,19 @@ double RailNet::pathMile(const path_t &path)
     return mile;
 }
 
+QVector<QString> RailNet::pathPoints(const path_t& path)
+{
+    QVector<QString> res;
+    if (path.empty())
+        return res;
+    res.reserve(static_cast<int>(path.size()) + 1);
+    res.push_back(path.front()->from.lock()->data.name.toSingleLiteral());
+    for (const auto& e : path) {
+        res.push_back(e->to.lock()->data.name.toSingleLiteral());
+    }
+    return res;
+}
+
 RailNet::path_t RailNet::railPathFrom(const std::shared_ptr<const edge> &start) const
 {
     path_t res;
@@ -249,8 +324,7 @@ RailNet::singleRailFromPath(const QVector<QString>& points,
 			report->append(QObject::tr("径路中间站%1不在图中").arg(*p));
 			return { nullptr,{} };
 		}
-		auto ret = sssp(prst, &GraphInterval::getMile);
-		auto subpath = dump_path(prst, curst, ret);
+		auto subpath = pointToPointPath(prst, curst);
 		path.insert(path.end(), subpath.begin(), subpath.end());
 
 		if (subpath.empty()) {
@@ -352,6 +426,7 @@ QString RailNet::intervalPathToString(std::shared_ptr<const vertex> pre,
 
 void RailNet::addRailway(const Railway* railway)
 {
+	invalidateIndex();
 	std::shared_ptr<vertex> pre{};
 	for (auto p = railway->firstDownInterval(); p; p = railway->nextIntervalCirc(p)) {
 		if (!pre) {
@@ -8,6 +8,7 @@
 #include "graphinterval.h"
 
 class PathOperationSeq;
+class RailNetIndex;
 
 class Railway;
 class RailCategory;
@@ -16,11 +17,26 @@ class RailNet: public xtl::di_graph<StationName, GraphStation, GraphInterval>
     using di_graph::sssp;
     using di_graph::dump_path;
 
+    /**
+     * 2026.10.19  最短路索引；为空时按原算法（sssp）查询。
+     * 图的数据改动（addRailway, clear）后丢弃。
+     */
+    std::shared_ptr<const RailNetIndex> _index{};
+
 public:
     RailNet()=default;
 
     using path_t=path_t;
 
+    /**
+     * 2026.10.19  最短路索引的测速结果（微秒为单位的总耗时）
+     */
+    struct bench_ret_t{
+        int queries=0;
+        double ssspMicros=0, indexMicros=0;
+        int mismatches=0;   // 两种算法所得径路长度不一致的次数
+    };
+
     struct rail_ret_t{
         std::shared_ptr<Railway> railway;
         path_t downPath,upPath;
@@ -34,6 +50,40 @@ public:
      */
     void fromRailCategory(const RailCategory* cat);
 
+    /**
+     * 2026.10.19  清空图数据，同时丢弃索引。
+     */
+    void clear();
+
+    /**
+     * 2026.10.19  对当前数据建立收缩层次最短路索引（可选的预处理步骤）。
+     * 此后shortestPath和关键点径路查询使用索引；图数据改动后索引自动失效。
+     */
+    void buildIndex();
+    void invalidateIndex();
+    bool hasIndex()const { return _index != nullptr; }
+    const auto& index()const { return _index; }
+
+    /**
+     * 2026.10.19  随机抽取queries对结点，分别用sssp和索引查询最短路，比较耗时和结果。
+     * 要求已经建立索引。
+     */
+    bench_ret_t benchmarkIndex(int queries, unsigned seed = 0)const;
+
+    /**
+     * 2026.10.19  线网缓存：保存建好的图（及索引）的二进制文件，与线路数据库文件放在一起。
+     * key为数据库内容的散列值；文件头中的格式版本或key不符时，缓存无效。
+     */
+    static constexpr quint32 CACHE_VERSION = 1;
+    static QString cacheFileName(const QString& dbFile);
+
+    bool saveCache(const QString& filename, const QByteArray& key)const;
+
+    /**
+     * 以内存映射方式读取缓存，替换当前数据。失败时返回false，且不改动当前数据。
+     */
+    bool loadCache(const QString& filename, const QByteArray& key);
+
     /**
      * @brief stationByGeneralName
      * 2023.01.24  find a vertex that could be bound to givene station name.
@@ -85,6 +135,12 @@ public:
      */
     static double pathMile(const path_t& path);
 
+    /**
+     * 2026.10.19  径路经过的全部车站（含首末站），作为关键点表。
+     * 用于由选定的径路（如备选径路）调用关键点切片算法。
+     */
+    static QVector<QString> pathPoints(const path_t& path);
+
     /**
      * 由所给边，按照当前线名向前追踪至线路终点，返回整个径路，包含起始。
      */
@@ -109,6 +165,12 @@ public:
 private:
     void addRailway(const Railway* railway);
 
+    /**
+     * 2026.10.19  点对点最短路：有索引时用索引，否则用sssp。不可达时返回空。
+     */
+    path_t pointToPointPath(const std::shared_ptr<const vertex>& from,
+                            const std::shared_ptr<const vertex>& to)const;
+
     /**
      * @brief 由points所给关键点表返回单向的Railway对象。所有站都只有下行通过。
      * 如果查找失败，返回空；并在report中报告错误原因。
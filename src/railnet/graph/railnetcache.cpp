@@ -0,0 +1,199 @@
+#include "railnet.h"
+#include "railnetindex.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QFile>
+#include <QSaveFile>
+#include <cstring>
+
+/*
+ * 2026.10.19  线网缓存文件格式（QDataStream, Qt_5_11）：
+ * 文件头：magic, CACHE_VERSION, key；
+ * 结点表：数目，每个结点的 站名, 等级, 客运, 货运, 股道表（按RailNet中的键顺序）；
+ * 边表：数目，每条边的 起点序号, 终点序号, 线名, 方向, 里程, 天窗表, 标尺表；
+ * 最后是可选的最短路索引。
+ */
+
+namespace {
+    constexpr char CACHE_MAGIC[] = "QETRCNET";
+    constexpr QDataStream::Version STREAM_VERSION = QDataStream::Qt_5_11;
+
+    void writeStation(QDataStream& s, const GraphStation& st)
+    {
+        s << st.name.station() << st.name.field() << static_cast<qint32>(st.level)
+          << st.passenger << st.freight << st.tracks;
+    }
+
+    GraphStation readStation(QDataStream& s)
+    {
+        GraphStation st;
+        QString station, field;
+        qint32 level;
+        s >> station >> field >> level >> st.passenger >> st.freight >> st.tracks;
+        st.name = StationName(station, field);
+        st.level = level;
+        return st;
+    }
+
+    void writeInterval(QDataStream& s, const GraphInterval& it)
+    {
+        s << it.railName << static_cast<qint32>(it.dir) << it.mile;
+        s << static_cast<qint32>(it.forbidNodes.size());
+        for (const auto& fn : it.forbidNodes)
+            s << fn.beginTime << fn.endTime;
+        s << static_cast<qint32>(it.rulerNodes.size());
+        for (const auto& rn : it.rulerNodes)
+            s << rn.name << static_cast<qint32>(rn.interval) << static_cast<qint32>(rn.start)
+              << static_cast<qint32>(rn.stop);
+    }
+
+    bool readInterval(QDataStream& s, GraphInterval& it)
+    {
+        qint32 dir, count;
+        s >> it.railName >> dir >> it.mile;
+        it.dir = static_cast<Direction>(dir);
+        s >> count;
+        if (s.status() != QDataStream::Ok || count < 0)
+            return false;
+        it.forbidNodes.reserve(count);
+        for (int i = 0; i < count; i++) {
+            GraphForbidNode fn;
+            s >> fn.beginTime >> fn.endTime;
+            it.forbidNodes.push_back(fn);
+        }
+        s >> count;
+        if (s.status() != QDataStream::Ok || count < 0)
+            return false;
+        it.rulerNodes.reserve(count);
+        for (int i = 0; i < count; i++) {
+            GraphRulerNode rn;
+            qint32 interval, start, stop;
+            s >> rn.name >> interval >> start >> stop;
+            rn.interval = interval;
+            rn.start = start;
+            rn.stop = stop;
+            it.rulerNodes.push_back(rn);
+        }
+        return s.status() == QDataStream::Ok;
+    }
+}
+
+QString RailNet::cacheFileName(const QString& dbFile)
+{
+    return dbFile + ".netcache";
+}
+
+bool RailNet::saveCache(const QString& filename, const QByteArray& key) const
+{
+    QSaveFile file(filename);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "RailNet::saveCache: cannot open " << filename;
+        return false;
+    }
+    QDataStream s(&file);
+    s.setVersion(STREAM_VERSION);
+    s.writeRawData(CACHE_MAGIC, sizeof(CACHE_MAGIC) - 1);
+    s << CACHE_VERSION << key;
+
+    std::unordered_map<const vertex*, int> vertexIds;
+    s << static_cast<qint32>(size());
+    for (const auto& [_, v] : vertices()) {
+        vertexIds.emplace(v.get(), static_cast<int>(vertexIds.size()));
+        writeStation(s, v->data);
+    }
+
+    // 每个结点的出边倒序写出：读取时依次插入（插入到链表头部），恢复原有顺序
+    std::vector<const edge*> edges;
+    for (const auto& [_, v] : vertices()) {
+        std::vector<const edge*> outs;
+        for (auto e = v->out_edge; e; e = e->next_out)
+            outs.push_back(e.get());
+        edges.insert(edges.end(), outs.rbegin(), outs.rend());
+    }
+    std::unordered_map<const edge*, int> edgeIds;
+    s << static_cast<qint32>(edges.size());
+    for (const auto* e : edges) {
+        edgeIds.emplace(e, static_cast<int>(edgeIds.size()));
+        s << static_cast<qint32>(vertexIds.at(e->from.lock().get()))
+          << static_cast<qint32>(vertexIds.at(e->to.lock().get()));
+        writeInterval(s, e->data);
+    }
+
+    s << (_index != nullptr);
+    if (_index)
+        _index->writeTo(s, edgeIds);
+
+    if (s.status() != QDataStream::Ok || !file.commit()) {
+        qWarning() << "RailNet::saveCache: write failed " << filename;
+        return false;
+    }
+    return true;
+}
+
+bool RailNet::loadCache(const QString& filename, const QByteArray& key)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    const qint64 size = file.size();
+    uchar* mem = size > 0 ? file.map(0, size) : nullptr;
+    if (!mem)
+        return false;
+    // 不复制数据，直接从映射的内存中读取
+    const QByteArray raw = QByteArray::fromRawData(reinterpret_cast<const char*>(mem),
+        static_cast<int>(size));
+    QDataStream s(raw);
+    s.setVersion(STREAM_VERSION);
+
+    char magic[sizeof(CACHE_MAGIC) - 1];
+    quint32 version = 0;
+    QByteArray fileKey;
+    if (s.readRawData(magic, sizeof(magic)) != sizeof(magic) ||
+        std::memcmp(magic, CACHE_MAGIC, sizeof(magic)) != 0)
+        return false;
+    s >> version >> fileKey;
+    if (version != CACHE_VERSION || fileKey != key)
+        return false;
+
+    RailNet net;
+    qint32 nv;
+    s >> nv;
+    if (s.status() != QDataStream::Ok || nv < 0)
+        return false;
+    std::vector<std::shared_ptr<vertex>> verts;
+    verts.reserve(nv);
+    for (int i = 0; i < nv; i++) {
+        GraphStation st = readStation(s);
+        StationName name = st.name;
+        verts.emplace_back(net.emplace_vertex(std::move(name), std::move(st)));
+    }
+
+    qint32 ne;
+    s >> ne;
+    if (s.status() != QDataStream::Ok || ne < 0)
+        return false;
+    std::vector<std::shared_ptr<edge>> edges;
+    edges.reserve(ne);
+    for (int i = 0; i < ne; i++) {
+        qint32 from, to;
+        s >> from >> to;
+        GraphInterval data;
+        if (!readInterval(s, data) || from < 0 || from >= nv || to < 0 || to >= nv)
+            return false;
+        edges.emplace_back(net.insert_edge(verts[from], verts[to], std::move(data)));
+    }
+
+    bool hasIndex = false;
+    s >> hasIndex;
+    if (s.status() != QDataStream::Ok)
+        return false;
+    if (hasIndex) {
+        net._index = RailNetIndex::readFrom(s, verts, edges);
+        if (!net._index)
+            qWarning() << "RailNet::loadCache: invalid index in " << filename << ", ignored";
+    }
+
+    *this = std::move(net);
+    return true;
+}
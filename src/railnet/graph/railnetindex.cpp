@@ -0,0 +1,386 @@
+#include "railnetindex.h"
+
+#include <limits>
+#include <queue>
+
+namespace {
+
+    constexpr double INF = std::numeric_limits<double>::infinity();
+
+    /**
+     * 见证搜索时最多固定的结点数。超过后视为无见证路径，多加一条捷径，不影响正确性。
+     */
+    constexpr int WITNESS_SETTLE_LIMIT = 500;
+
+    using queue_item_t = std::pair<double, int>;
+    using min_queue_t = std::priority_queue<queue_item_t, std::vector<queue_item_t>,
+        std::greater<queue_item_t>>;
+
+/**
+ * 收缩过程的临时状态。结点、弧均用下标表示。
+ */
+class RailNetIndexBuilder
+{
+public:
+    struct Arc {
+        int from, to;
+        double weight;
+        int first, second;
+    };
+
+    std::vector<Arc>& arcs;
+    const int n;
+    std::vector<std::vector<int>> outArcs, inArcs;
+    std::vector<char> contracted;
+    std::vector<int> deletedNeighbors;
+
+    // 见证搜索用的距离表，每次搜索后只复位访问过的项
+    std::vector<double> dist;
+    std::vector<int> touched;
+
+    RailNetIndexBuilder(std::vector<Arc>& arcs, int n) :
+        arcs(arcs), n(n), outArcs(n), inArcs(n), contracted(n, 0),
+        deletedNeighbors(n, 0), dist(n, INF)
+    {
+        for (int a = 0; a < static_cast<int>(arcs.size()); a++) {
+            outArcs[arcs[a].from].push_back(a);
+            inArcs[arcs[a].to].push_back(a);
+        }
+    }
+
+    /**
+     * 从source出发、不经过skip及已收缩结点，距离不超过limit的局部Dijkstra
+     */
+    void witnessSearch(int source, int skip, double limit)
+    {
+        for (int v : touched) dist[v] = INF;
+        touched.clear();
+
+        min_queue_t q;
+        dist[source] = 0;
+        touched.push_back(source);
+        q.emplace(0, source);
+        int settled = 0;
+        while (!q.empty()) {
+            auto [d, u] = q.top();
+            q.pop();
+            if (d > dist[u]) continue;
+            if (d > limit || ++settled > WITNESS_SETTLE_LIMIT) break;
+            for (int a : outArcs[u]) {
+                int x = arcs[a].to;
+                if (x == skip || contracted[x]) continue;
+                double nd = d + arcs[a].weight;
+                if (nd < dist[x]) {
+                    if (dist[x] == INF) touched.push_back(x);
+                    dist[x] = nd;
+                    q.emplace(nd, x);
+                }
+            }
+        }
+    }
+
+    /**
+     * 收缩v：simulate时只统计所需捷径数目，否则实际添加捷径并标记v已收缩。
+     */
+    int contract(int v, bool simulate)
+    {
+        int shortcuts = 0;
+        // 先复制：添加捷径会改动outArcs/inArcs
+        const std::vector<int> ins = inArcs[v], outs = outArcs[v];
+        for (int a : ins) {
+            int u = arcs[a].from;
+            if (contracted[u]) continue;
+            double maxOut = -1;
+            for (int b : outs) {
+                int x = arcs[b].to;
+                if (!contracted[x] && x != u)
+                    maxOut = std::max(maxOut, arcs[b].weight);
+            }
+            if (maxOut < 0) continue;
+
+            witnessSearch(u, v, arcs[a].weight + maxOut);
+            for (int b : outs) {
+                int x = arcs[b].to;
+                if (contracted[x] || x == u) continue;
+                double d = arcs[a].weight + arcs[b].weight;
+                if (dist[x] <= d) continue;   // 有不经过v的见证路径
+                shortcuts++;
+                if (!simulate) {
+                    int s = static_cast<int>(arcs.size());
+                    arcs.push_back({ u, x, d, a, b });
+                    outArcs[u].push_back(s);
+                    inArcs[x].push_back(s);
+                    // 避免同一u到x的重复捷径
+                    if (dist[x] == INF) touched.push_back(x);
+                    dist[x] = d;
+                }
+            }
+        }
+        if (!simulate) {
+            contracted[v] = 1;
+            for (int a : ins) deletedNeighbors[arcs[a].from]++;
+            for (int b : outs) deletedNeighbors[arcs[b].to]++;
+        }
+        return shortcuts;
+    }
+
+    /**
+     * 边差启发式：所需捷径数 - 删除的弧数 + 已收缩的邻结点数
+     */
+    int priority(int v)
+    {
+        int removed = 0;
+        for (int a : inArcs[v]) if (!contracted[arcs[a].from]) removed++;
+        for (int b : outArcs[v]) if (!contracted[arcs[b].to]) removed++;
+        return contract(v, true) - removed + deletedNeighbors[v];
+    }
+
+    /**
+     * 依次收缩全部结点，返回各结点的层次
+     */
+    std::vector<int> run()
+    {
+        std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int>>,
+            std::greater<std::pair<int, int>>> q;
+        for (int v = 0; v < n; v++)
+            q.emplace(priority(v), v);
+
+        std::vector<int> rank(n, 0);
+        int level = 0;
+        while (!q.empty()) {
+            int v = q.top().second;
+            q.pop();
+            if (contracted[v]) continue;
+            // 惰性更新：优先级变差的，重新入队
+            int p = priority(v);
+            if (!q.empty() && p > q.top().first) {
+                q.emplace(p, v);
+                continue;
+            }
+            contract(v, false);
+            rank[v] = level++;
+        }
+        return rank;
+    }
+};
+
+}
+
+std::shared_ptr<const RailNetIndex> RailNetIndex::build(const RailNet& net)
+{
+    std::shared_ptr<RailNetIndex> res(new RailNetIndex);
+    int n = 0;
+    for (const auto& [_, v] : net.vertices())
+        res->ids.emplace(v.get(), n++);
+
+    // 原始边：同一对结点间的多条边只保留最短的
+    std::vector<RailNetIndexBuilder::Arc> barcs;
+    std::unordered_map<long long, int> pairArc;
+    for (const auto& [_, v] : net.vertices()) {
+        int from = res->ids.at(v.get());
+        for (auto e = v->out_edge; e; e = e->next_out) {
+            int to = res->ids.at(e->to.lock().get());
+            if (to == from) continue;
+            long long key = static_cast<long long>(from) * n + to;
+            double w = e->data.mile;
+            if (auto itr = pairArc.find(key); itr != pairArc.end()) {
+                if (w < res->arcs[itr->second].weight) {
+                    res->arcs[itr->second].weight = barcs[itr->second].weight = w;
+                    res->arcs[itr->second].ed = e;
+                }
+                continue;
+            }
+            pairArc.emplace(key, static_cast<int>(barcs.size()));
+            barcs.push_back({ from, to, w, -1, -1 });
+            res->arcs.push_back({ from, to, w, -1, -1, e });
+        }
+    }
+    const int originalCount = static_cast<int>(barcs.size());
+
+    RailNetIndexBuilder builder(barcs, n);
+    auto rank = builder.run();
+
+    for (int a = originalCount; a < static_cast<int>(barcs.size()); a++) {
+        const auto& b = barcs[a];
+        res->arcs.push_back({ b.from, b.to, b.weight, b.first, b.second });
+    }
+    res->_shortcutCount = static_cast<int>(barcs.size()) - originalCount;
+
+    // 整理为CSR
+    res->upBegin.assign(n + 1, 0);
+    res->downBegin.assign(n + 1, 0);
+    for (const auto& a : res->arcs) {
+        if (rank[a.from] < rank[a.to]) res->upBegin[a.from + 1]++;
+        else res->downBegin[a.to + 1]++;
+    }
+    for (int v = 0; v < n; v++) {
+        res->upBegin[v + 1] += res->upBegin[v];
+        res->downBegin[v + 1] += res->downBegin[v];
+    }
+    res->upArcs.resize(res->upBegin[n]);
+    res->downArcs.resize(res->downBegin[n]);
+    std::vector<int> upPos(res->upBegin.begin(), res->upBegin.end() - 1),
+        downPos(res->downBegin.begin(), res->downBegin.end() - 1);
+    for (int i = 0; i < static_cast<int>(res->arcs.size()); i++) {
+        const auto& a = res->arcs[i];
+        if (rank[a.from] < rank[a.to]) res->upArcs[upPos[a.from]++] = i;
+        else res->downArcs[downPos[a.to]++] = i;
+    }
+    return res;
+}
+
+std::optional<RailNetIndex::path_t> RailNetIndex::query(
+    const std::shared_ptr<const vertex>& from,
+    const std::shared_ptr<const vertex>& to, double* mile) const
+{
+    auto fi = ids.find(from.get()), ti = ids.find(to.get());
+    if (fi == ids.end() || ti == ids.end())
+        return std::nullopt;
+    const int s = fi->second, t = ti->second;
+    if (mile) *mile = 0;
+    if (s == t)
+        return path_t{};
+
+    // 搜索空间很小，用散列表保存 距离, 前驱弧
+    std::unordered_map<int, std::pair<double, int>> fwd, bwd;
+    min_queue_t qf, qb;
+    fwd.emplace(s, std::make_pair(0.0, -1));
+    bwd.emplace(t, std::make_pair(0.0, -1));
+    qf.emplace(0, s);
+    qb.emplace(0, t);
+    double best = INF;
+    int meet = -1;
+
+    auto step = [&](bool forward) {
+        auto& q = forward ? qf : qb;
+        auto& self = forward ? fwd : bwd;
+        const auto& other = forward ? bwd : fwd;
+        auto [d, u] = q.top();
+        q.pop();
+        if (d > self.at(u).first) return;
+        if (auto itr = other.find(u); itr != other.end() && d + itr->second.first < best) {
+            best = d + itr->second.first;
+            meet = u;
+        }
+        const auto& begin = forward ? upBegin : downBegin;
+        const auto& lst = forward ? upArcs : downArcs;
+        for (int i = begin[u]; i < begin[u + 1]; i++) {
+            const auto& a = arcs[lst[i]];
+            int x = forward ? a.to : a.from;
+            double nd = d + a.weight;
+            auto [itr, inserted] = self.try_emplace(x, nd, lst[i]);
+            if (inserted || nd < itr->second.first) {
+                itr->second = { nd, lst[i] };
+                q.emplace(nd, x);
+            }
+        }
+    };
+
+    // 每一侧在队首距离不小于当前最优值时停止
+    while (true) {
+        bool fdone = qf.empty() || qf.top().first >= best;
+        bool bdone = qb.empty() || qb.top().first >= best;
+        if (fdone && bdone) break;
+        if (bdone || (!fdone && qf.top().first <= qb.top().first))
+            step(true);
+        else
+            step(false);
+    }
+    if (meet < 0)
+        return path_t{};
+
+    path_t path;
+    std::vector<int> upChain;
+    for (int v = meet; v != s;) {
+        int a = fwd.at(v).second;
+        upChain.push_back(a);
+        v = arcs[a].from;
+    }
+    for (auto p = upChain.rbegin(); p != upChain.rend(); ++p)
+        unpack(*p, path);
+    for (int v = meet; v != t;) {
+        int a = bwd.at(v).second;
+        unpack(a, path);
+        v = arcs[a].to;
+    }
+    if (mile) *mile = best;
+    return path;
+}
+
+void RailNetIndex::unpack(int arc, path_t& path) const
+{
+    const auto& a = arcs[arc];
+    if (a.ed) {
+        path.emplace_back(a.ed);
+    }
+    else {
+        unpack(a.first, path);
+        unpack(a.second, path);
+    }
+}
+
+void RailNetIndex::writeTo(QDataStream& s, const std::unordered_map<const edge*, int>& edgeIds) const
+{
+    s << static_cast<qint32>(ids.size()) << static_cast<qint32>(arcs.size())
+      << static_cast<qint32>(_shortcutCount);
+    for (const auto& a : arcs) {
+        s << static_cast<qint32>(a.from) << static_cast<qint32>(a.to) << a.weight
+          << static_cast<qint32>(a.first) << static_cast<qint32>(a.second)
+          << static_cast<qint32>(a.ed ? edgeIds.at(a.ed.get()) : -1);
+    }
+    auto writeVec = [&s](const std::vector<int>& v) {
+        s << static_cast<qint32>(v.size());
+        for (int x : v) s << static_cast<qint32>(x);
+    };
+    writeVec(upBegin);
+    writeVec(upArcs);
+    writeVec(downBegin);
+    writeVec(downArcs);
+}
+
+std::shared_ptr<const RailNetIndex> RailNetIndex::readFrom(QDataStream& s,
+    const std::vector<std::shared_ptr<vertex>>& vertices,
+    const std::vector<std::shared_ptr<edge>>& edges)
+{
+    qint32 n, m, sc;
+    s >> n >> m >> sc;
+    if (s.status() != QDataStream::Ok || n != static_cast<qint32>(vertices.size()) || m < 0)
+        return nullptr;
+    std::shared_ptr<RailNetIndex> res(new RailNetIndex);
+    for (int i = 0; i < n; i++)
+        res->ids.emplace(vertices[i].get(), i);
+    res->_shortcutCount = sc;
+    res->arcs.reserve(m);
+    for (int i = 0; i < m; i++) {
+        qint32 from, to, first, second, ed;
+        double w;
+        s >> from >> to >> w >> first >> second >> ed;
+        if (from < 0 || from >= n || to < 0 || to >= n || ed >= static_cast<qint32>(edges.size()) ||
+            (ed < 0 && (first < 0 || first >= i || second < 0 || second >= i)))
+            return nullptr;
+        res->arcs.push_back({ from, to, w, first, second,
+            ed >= 0 ? edges[ed] : std::shared_ptr<const edge>{} });
+    }
+    auto readVec = [&s](std::vector<int>& v, qint32 maxValue) {
+        qint32 size;
+        s >> size;
+        if (s.status() != QDataStream::Ok || size < 0)
+            return false;
+        v.resize(size);
+        for (auto& x : v) {
+            qint32 t = -1;
+            s >> t;
+            if (t < 0 || t > maxValue) return false;
+            x = t;
+        }
+        return s.status() == QDataStream::Ok;
+    };
+    if (!readVec(res->upBegin, m) || !readVec(res->upArcs, m - 1) ||
+        !readVec(res->downBegin, m) || !readVec(res->downArcs, m - 1) ||
+        res->upBegin.size() != static_cast<size_t>(n) + 1 ||
+        res->downBegin.size() != static_cast<size_t>(n) + 1 ||
+        res->upArcs.size() != static_cast<size_t>(res->upBegin.back()) ||
+        res->downArcs.size() != static_cast<size_t>(res->downBegin.back()))
+        return nullptr;
+    return res;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "railnet.h"
+
+#include <QDataStream>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * 2026.10.19  RailNet的收缩层次（contraction hierarchies）最短路索引。
+ * 建立时按“边差”启发式逐个收缩结点，并为被收缩结点两侧补充捷径（shortcut）；
+ * 查询时只沿层次递增方向做双向Dijkstra，搜索空间通常只有几十至几百个结点。
+ * 捷径记录所替代的两段弧，查询结果展开为RailNet中的原始边序列，可直接作为path_t使用。
+ * 索引只引用建立时RailNet中的结点和边；RailNet改动后索引即失效，由RailNet负责丢弃。
+ * 建立后只读，可在多个线程中同时查询。
+ */
+class RailNetIndex
+{
+public:
+    using vertex = RailNet::vertex;
+    using edge = RailNet::edge;
+    using path_t = RailNet::path_t;
+
+private:
+    /**
+     * 弧：原始边（ed非空）或者捷径（由first, second两段弧拼接）
+     */
+    struct Arc {
+        int from, to;
+        double weight;
+        int first = -1, second = -1;
+        std::shared_ptr<const edge> ed{};
+    };
+
+    std::vector<Arc> arcs;
+    std::unordered_map<const vertex*, int> ids;
+    int _shortcutCount = 0;
+
+    // 按层次整理的邻接表（CSR格式）：
+    // up[u]: 从u出发、指向更高层次结点的弧；down[v]: 指向v、从更高层次结点出发的弧
+    std::vector<int> upBegin, upArcs, downBegin, downArcs;
+
+    RailNetIndex() = default;
+
+public:
+    /**
+     * 对net的当前数据建立索引。net为空时返回空索引（查询全部交给原算法）。
+     */
+    static std::shared_ptr<const RailNetIndex> build(const RailNet& net);
+
+    /**
+     * 点对点最短路。
+     * from或to不在索引中（例如RailNet重新加载前取得的结点）时返回nullopt，调用方应改用sssp；
+     * 不可达或from==to时返回空路径。mile非空时写入总里程。
+     */
+    std::optional<path_t> query(const std::shared_ptr<const vertex>& from,
+        const std::shared_ptr<const vertex>& to, double* mile = nullptr)const;
+
+    /**
+     * 用于线网缓存。结点、边都以其在缓存中的序号表示：
+     * 结点序号与建立索引时相同（按RailNet中的键顺序），边序号由edgeIds给出。
+     */
+    void writeTo(QDataStream& s, const std::unordered_map<const edge*, int>& edgeIds)const;
+    static std::shared_ptr<const RailNetIndex> readFrom(QDataStream& s,
+        const std::vector<std::shared_ptr<vertex>>& vertices,
+        const std::vector<std::shared_ptr<edge>>& edges);
+
+    int vertexCount()const { return static_cast<int>(ids.size()); }
+    int arcCount()const { return static_cast<int>(arcs.size()); }
+    int shortcutCount()const { return _shortcutCount; }
+
+private:
+    void unpack(int arc, path_t& path)const;
+};
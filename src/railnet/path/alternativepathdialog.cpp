@@ -0,0 +1,102 @@
+﻿#include "alternativepathdialog.h"
+#include "data/common/qesystem.h"
+
+#include <QHeaderView>
+#include <QLabel>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QStandardItemModel>
+#include <QTableView>
+#include <QVBoxLayout>
+#include <chrono>
+
+#include <util/buttongroup.hpp>
+
+AlternativePathDialog::AlternativePathDialog(const RailNet& net,
+    const std::shared_ptr<const RailNet::vertex>& from,
+    const std::shared_ptr<const RailNet::vertex>& to, QWidget* parent) :
+    QDialog(parent), net(net), paths(net, from, to), model(new QStandardItemModel(this))
+{
+    resize(700, 500);
+    setWindowTitle(tr("备选径路 %1->%2").arg(from->data.name.toSingleLiteral(),
+        to->data.name.toSingleLiteral()));
+    initUI();
+    actMore();
+}
+
+void AlternativePathDialog::initUI()
+{
+    auto* vlay = new QVBoxLayout(this);
+    auto* lab = new QLabel(tr("以下按里程从小到大列出两站间互不相同（经过的车站序列不同）的无环径路。"
+        "选择一条径路后点击[确定]。"));
+    lab->setWordWrap(true);
+    vlay->addWidget(lab);
+
+    model->setHorizontalHeaderLabels({ tr("里程"), tr("站数"), tr("经由") });
+    table = new QTableView;
+    table->setModel(model);
+    table->setEditTriggers(QTableView::NoEditTriggers);
+    table->setSelectionBehavior(QTableView::SelectRows);
+    table->setSelectionMode(QTableView::SingleSelection);
+    table->verticalHeader()->setDefaultSectionSize(SystemJson::instance.table_row_height);
+    table->horizontalHeader()->setStretchLastSection(true);
+    connect(table, &QTableView::doubleClicked, this, &AlternativePathDialog::actApply);
+    vlay->addWidget(table);
+
+    labStatus = new QLabel;
+    vlay->addWidget(labStatus);
+
+    auto* g = new ButtonGroup<3>({ "更多","确定","取消" });
+    btnMore = g->get(0);
+    g->connectAll(SIGNAL(clicked()), this, { SLOT(actMore()),SLOT(actApply()),SLOT(reject()) });
+    vlay->addLayout(g);
+}
+
+void AlternativePathDialog::actMore()
+{
+    using namespace std::chrono_literals;
+    auto start = std::chrono::steady_clock::now();
+    int old = paths.size();
+    int cnt = paths.ensure(old + BATCH_SIZE);
+    auto end = std::chrono::steady_clock::now();
+
+    for (int i = old; i < cnt; i++) {
+        const auto& p = paths.path(i);
+        auto* it = new QStandardItem(QString::number(paths.mile(i), 'f', 3));
+        auto* itCount = new QStandardItem(QString::number(p.size() + 1));
+        auto* itPath = new QStandardItem(net.pathToStringSimple(p));
+        itPath->setToolTip(net.pathToString(p));
+        model->appendRow({ it, itCount, itPath });
+    }
+    table->resizeColumnToContents(0);
+    table->resizeColumnToContents(1);
+    if (old == 0 && cnt > 0)
+        table->selectRow(0);
+
+    btnMore->setEnabled(!paths.exhausted());
+    if (cnt == 0) {
+        labStatus->setText(tr("两站间不可达"));
+    }
+    else {
+        labStatus->setText(tr("共%1条径路，本次计算用时%2毫秒%3").arg(cnt)
+            .arg((end - start) / 1ms)
+            .arg(paths.exhausted() ? tr("，已列出全部径路") : QString()));
+    }
+}
+
+void AlternativePathDialog::actApply()
+{
+    if (selectedPath().empty()) {
+        QMessageBox::warning(this, tr("错误"), tr("请先选择一条径路。"));
+        return;
+    }
+    accept();
+}
+
+RailNet::path_t AlternativePathDialog::selectedPath() const
+{
+    const auto& idx = table->currentIndex();
+    if (!idx.isValid() || idx.row() >= paths.size())
+        return {};
+    return paths.path(idx.row());
+}
@@ -0,0 +1,50 @@
+﻿#pragma once
+
+#include <QDialog>
+#include <memory>
+
+#include "railnet/graph/kshortestpaths.h"
+
+class QLabel;
+class QPushButton;
+class QStandardItemModel;
+class QTableView;
+
+/**
+ * @brief The AlternativePathDialog class
+ * 2026.10.19  两站间的备选径路（前K短径路）选择对话框。
+ * 按里程从小到大列出径路；[更多]继续计算后续的径路。
+ * 选定的径路由selectedPath()取得；生成线路等后续工作由调用方完成。
+ */
+class AlternativePathDialog : public QDialog
+{
+    Q_OBJECT
+    const RailNet& net;
+    KShortestPaths paths;
+    QStandardItemModel* const model;
+
+    QTableView* table;
+    QLabel* labStatus;
+    QPushButton* btnMore;
+public:
+    static constexpr int BATCH_SIZE = 10;
+
+    AlternativePathDialog(const RailNet& net,
+                          const std::shared_ptr<const RailNet::vertex>& from,
+                          const std::shared_ptr<const RailNet::vertex>& to,
+                          QWidget* parent = nullptr);
+
+    /**
+     * 当前选中的径路；未选中时返回空
+     */
+    RailNet::path_t selectedPath()const;
+
+    int pathCount()const { return paths.size(); }
+
+private:
+    void initUI();
+
+private slots:
+    void actMore();
+    void actApply();
+};
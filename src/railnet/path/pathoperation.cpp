@@ -27,6 +27,7 @@ QString PathOperation::methodString(Method m)
     case ShortestPath: return QObject::tr("最短路");
     case AdjStation: return QObject::tr("邻站");
     case AdjRailway: return QObject::tr("邻线");
+    case AlternativePath: return QObject::tr("备选径路");
     default: return "INVALID METHOD";
     }
 }
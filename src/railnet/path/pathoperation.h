@@ -18,7 +18,8 @@ public:
     enum Method{
         ShortestPath,
         AdjStation,
-        AdjRailway
+        AdjRailway,
+        AlternativePath   // 2026.10.19  从备选径路（前K短径路）中选定
     };
     std::shared_ptr<const RailNet::vertex> target;
     Method method;
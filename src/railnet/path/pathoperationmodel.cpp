@@ -142,6 +142,23 @@ bool PathOperationModel::addByAdjPath(RailNet::path_t &&path, QString *report)
     return true;
 }
 
+bool PathOperationModel::addByAlternativePath(RailNet::path_t &&path, QString *report)
+{
+    if(seq.empty()){
+        report->append(QObject::tr("起始站为空。请先选择起始站。"));
+        return false;
+    }
+    if (path.empty() || seq.lastVertex()!=path.front()->from.lock()){
+        report->append(QObject::tr("备选径路不是由当前末站出发"));
+        return false;
+    }
+    double mile=seq.currentMile()+RailNet::pathMile(path);
+    auto target=path.back()->to.lock();
+    appendOperation(PathOperation(target, PathOperation::AlternativePath,
+                                  std::forward<RailNet::path_t>(path), mile));
+    return true;
+}
+
 void PathOperationModel::popSelect()
 {
     if(seq.empty())return;
@@ -180,6 +197,19 @@ bool PathOperationModel::fromInverseSeq(const PathOperationSeq &other,
             if(!flag){
                 return false;
             }
+        }else if (p->method==PathOperation::AlternativePath){
+            // 备选径路：逐区间按最短路反向，保持经过的车站序列，合为一步
+            RailNet::path_t path;
+            for(auto e=p->path.rbegin();e!=p->path.rend();++e){
+                auto sub=net.shortestPath((*e)->to.lock(),(*e)->from.lock(),report);
+                if(sub.empty()){
+                    return false;
+                }
+                path.insert(path.end(),sub.begin(),sub.end());
+            }
+            if(!addByAlternativePath(std::move(path),report)){
+                return false;
+            }
         }else{
             std::shared_ptr<const RailNet::vertex> stepStart = seq.lastVertex(), stepEnd = vet;
             auto path=net.railPathTo(seq.lastVertex(),vet,
@@ -56,6 +56,11 @@ public:
      */
     bool addByAdjPath(RailNet::path_t&& path, QString* report);
 
+    /**
+     * 2026.10.19  按选定的备选径路添加。path应由当前末站出发。
+     */
+    bool addByAlternativePath(RailNet::path_t&& path, QString* report);
+
 
     /**
      * @brief popSelect  删除最后一个选择的站 直接执行
@@ -3,6 +3,8 @@
 #include "pathselectwidget.h"
 #include "data/common/qesystem.h"
 
+#include "alternativepathdialog.h"
+
 #include <railnet/graph/adjacentlistmodel.h>
 
 #include <QLineEdit>
@@ -37,6 +39,10 @@ void PathSelectWidget::initUI()
     auto* btn=new QPushButton(tr("添加关键点"));
     connect(btn,&QPushButton::clicked,this,&PathSelectWidget::addByShortestPath);
     hlay->addWidget(btn);
+    btn=new QPushButton(tr("备选径路"));
+    btn->setToolTip(tr("备选径路\n列出当前末站至所填车站之间按里程排序的多条径路，从中选择一条添加。"));
+    connect(btn,&QPushButton::clicked,this,&PathSelectWidget::addByAlternativePath);
+    hlay->addWidget(btn);
     vlay->addLayout(hlay);
 
     // 已选关键点表
@@ -162,6 +168,43 @@ void PathSelectWidget::addByShortestPath()
     }
 }
 
+void PathSelectWidget::addByAlternativePath()
+{
+    const QString& text=edStation->text();
+    if(text.isEmpty()){
+        QMessageBox::warning(this,tr("错误"),tr("站名不能为空"));
+        return;
+    }
+    const auto& seq=seqModel->sequence();
+    if(seq.empty()){
+        QMessageBox::warning(this,tr("错误"),tr("请先添加起始站。"));
+        return;
+    }
+    auto target=net.find_vertex(text);
+    if(!target){
+        QMessageBox::warning(this,tr("错误"),tr("所给车站%1不存在").arg(text));
+        return;
+    }
+    if(target==seq.lastVertex()){
+        QMessageBox::warning(this,tr("错误"),tr("出发站和到达站相同"));
+        return;
+    }
+
+    AlternativePathDialog dlg(net,seq.lastVertex(),target,this);
+    if(dlg.pathCount()==0){
+        QMessageBox::warning(this,tr("错误"),tr("目标站不可达"));
+        return;
+    }
+    if(dlg.exec()!=QDialog::Accepted)
+        return;
+    QString rep;
+    bool flag=seqModel->addByAlternativePath(dlg.selectedPath(),&rep);
+    if(!flag){
+        QMessageBox::warning(this,tr("错误"),tr("关键点添加失败，原因如下:\n %1")
+                             .arg(rep));
+    }
+}
+
 void PathSelectWidget::popSelect()
 {
     seqModel->popSelect();
@@ -48,6 +48,11 @@ private slots:
     void setAdjStationRow(int row);
 
     void addByShortestPath();
+
+    /**
+     * 2026.10.19  列出当前末站至所填车站的备选径路，选定后添加
+     */
+    void addByAlternativePath();
     void popSelect();
     void clearSelect();
 
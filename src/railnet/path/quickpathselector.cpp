@@ -9,6 +9,7 @@
 #include <chrono>
 #include "data/common/qesystem.h"
 #include "railnet/graph/railnet.h"
+#include "alternativepathdialog.h"
 
 #include <util/qecontrolledtable.h>
 #include <model/general/qemoveablemodel.h>
@@ -80,9 +81,12 @@ void QuickPathSelector::initUI()
 
     vlay->addLayout(hlay);
 
-    auto* g=new ButtonGroup<2>({"预览","强制生成"});
+    auto* g=new ButtonGroup<3>({"预览","备选径路","强制生成"});
     vlay->addLayout(g);
-    g->connectAll(SIGNAL(clicked()),this,{SLOT(actGenerate()),SLOT(actForce())});
+    g->get(1)->setToolTip(tr("备选径路\n正向径路给出两个关键点时，列出两站间按里程排序的多条径路，"
+        "选择其中一条生成切片。"));
+    g->connectAll(SIGNAL(clicked()),this,{SLOT(actGenerate()),SLOT(actAlternatives()),
+        SLOT(actForce())});
 }
 
 QVector<QString> QuickPathSelector::pathFromModel(const QEMoveableModel *model)
@@ -101,16 +105,50 @@ QVector<QString> QuickPathSelector::pathFromModel(const QEMoveableModel *model)
 
 void QuickPathSelector::actGenerate()
 {
-    using namespace std::chrono_literals;
-    QString report;
-    bool withRuler=ckRuler->isChecked();
-    int rulerCount=spRuler->value();
     auto downPath=pathFromModel(mdDown);
     if(downPath.isEmpty()){
         QMessageBox::warning(this,tr("错误"),tr("正向径路为空，无法生成。\n"
         "注：径路表中的空白项将被忽略。"));
         return;
     }
+    generate(downPath);
+}
+
+void QuickPathSelector::actAlternatives()
+{
+    auto downPath=pathFromModel(mdDown);
+    if(downPath.size()!=2){
+        QMessageBox::warning(this,tr("错误"),tr("备选径路功能需要正向径路恰好给出两个非空关键点"
+            "（起点和终点）。"));
+        return;
+    }
+    auto from=net.find_vertex(downPath.front()), to=net.find_vertex(downPath.back());
+    if(!from || !to){
+        QMessageBox::warning(this,tr("错误"),tr("车站%1不在图中").arg(
+            from ? downPath.back() : downPath.front()));
+        return;
+    }
+    if(from==to){
+        QMessageBox::warning(this,tr("错误"),tr("出发站和到达站相同"));
+        return;
+    }
+    AlternativePathDialog dlg(net,from,to,this);
+    if(dlg.pathCount()==0){
+        QMessageBox::warning(this,tr("错误"),tr("目标站不可达"));
+        return;
+    }
+    if(dlg.exec()!=QDialog::Accepted)
+        return;
+    // 线路在选定之后才生成
+    generate(RailNet::pathPoints(dlg.selectedPath()));
+}
+
+void QuickPathSelector::generate(const QVector<QString>& downPath)
+{
+    using namespace std::chrono_literals;
+    QString report;
+    bool withRuler=ckRuler->isChecked();
+    int rulerCount=spRuler->value();
 
     RailNet::rail_ret_t ret;
     auto start = std::chrono::system_clock::now();
@@ -35,11 +35,21 @@ private:
     void initUI();
     QVector<QString> pathFromModel(const QEMoveableModel* model);
 
+    /**
+     * 按所给正向关键点表和当前的反向径路选项生成切片
+     */
+    void generate(const QVector<QString>& downPath);
+
 signals:
     void railGenerated(std::shared_ptr<Railway>, const QString& pathString);
     void showStatus(const QString& msg);
 private slots:
     void actGenerate();
+
+    /**
+     * 2026.10.19  正向两关键点间的备选径路：选定后，以其经过的全部车站为关键点生成切片
+     */
+    void actAlternatives();
     void actForce();
     void onUpModeChanged();
 };
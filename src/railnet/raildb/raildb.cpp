@@ -1,5 +1,6 @@
 ﻿#include "raildb.h"
 
+#include <QCryptographicHash>
 #include <QFile>
 #include <QJsonDocument>
 
@@ -18,10 +19,12 @@ bool RailDB::parseJson(const QString &filename)
                   Qt::endl;
         return false;
     }
-    QJsonDocument doc=QJsonDocument::fromJson(file.readAll());
+    const QByteArray content=file.readAll();
+    QJsonDocument doc=QJsonDocument::fromJson(content);
     fromJson(doc.object());
     if (!isNull()){
         this->_filename=filename;
+        this->_contentHash=QCryptographicHash::hash(content, QCryptographicHash::Sha1);
         return true;
     }else return false;
 }
@@ -36,8 +39,10 @@ bool RailDB::save() const
         return false;
     }
     QJsonDocument doc(toJson());
-    file.write(doc.toJson());
+    const QByteArray content=doc.toJson();
+    file.write(content);
     file.close();
+    _contentHash=QCryptographicHash::hash(content, QCryptographicHash::Sha1);
     return true;
 }
 
@@ -51,4 +56,5 @@ void RailDB::clear()
 {
     RailCategory::clear();
     _filename.clear();
+    _contentHash.clear();
 }
@@ -9,6 +9,7 @@
 class RailDB : public RailCategory
 {
     QString _filename;
+    mutable QByteArray _contentHash;   // save()中更新
 public:
     using RailCategory::RailCategory;
     RailDB(RailCategory&& other);   // move construct
@@ -31,6 +32,12 @@ public:
 
     const  auto& filename()const{return _filename;}
 
+    /**
+     * 2026.10.19  最近一次读取或保存的文件内容的散列值，用作线网缓存的key。
+     * 只有数据与文件一致（撤销栈clean）时才有意义；没有对应文件时为空。
+     */
+    const auto& contentHash()const{return _contentHash;}
+
     void clear();
 };
 
@@ -13,10 +13,12 @@
 #include <QApplication>
 #include <QStyle>
 #include <QMessageBox>
+#include <QUndoStack>
 #include <chrono>
 #include "railnet/path/quickpathselector.h"
 #include "railnet/path/railpreviewdialog.h"
 #include "railnet/graph/viewadjacentwidget.h"
+#include "railnet/graph/railnetindex.h"
 #include "wizards/selectpath/selectpathwizard.h"
 #include "util/selectrailwaystable.h"
 #include "defines/icon_specs.h"
@@ -29,6 +31,10 @@ RailDBContext::RailDBContext(SARibbonContextCategory *cont, MainWindow *mw_):
         this, &RailDBContext::onWindowDeactivated);
     connect(window->getNavi(), &RailDBNavi::importFromCurrent,
         this, &RailDBContext::actImportFromCurrent);
+    connect(window->getNavi()->undoStack(), &QUndoStack::indexChanged,
+        this, &RailDBContext::onDBChanged);
+    connect(window->getNavi(), &RailDBNavi::dbReset,
+        this, &RailDBContext::onDBChanged);
     initUI();
 }
 
@@ -91,6 +97,12 @@ void RailDBContext::initUI()
     connect(act, &QAction::triggered, this, &RailDBContext::actRefreshNet);
     act->setToolTip(tr("刷新线网\n从当前线路数据库中重新读取有向图模型。"));
 
+    act = mw->makeAction(QEICN_fast_path, tr("索引测速"));
+    panel->addMediumAction(act);
+    connect(act, &QAction::triggered, this, &RailDBContext::actBenchmarkIndex);
+    act->setToolTip(tr("最短路索引测速\n随机抽取车站对，比较使用与不使用最短路索引时的查询耗时，"
+        "并检查两种算法的结果是否一致。"));
+
 
     panel = page->addPannel(tr("线路"));
     act = mw->makeAction(QEICN_export_rail_to_diagram, tr("导出运行图"));
@@ -144,6 +156,7 @@ void RailDBContext::onWindowDeactivated()
     if(!net.empty()){
         net.clear();
     }
+    _netStale = false;
 }
 
 void RailDBContext::activateDB()
@@ -177,7 +190,7 @@ void RailDBContext::deactivateDB()
 void RailDBContext::activateQuickSelector()
 {
     activateBase();
-    if (net.empty()){
+    if (net.empty() || _netStale){
         loadNet();
         if (net.empty()){
             QMessageBox::warning(mw,tr("警告"),tr("当前有向图模型为空，无法进行常规经由选择。"
@@ -227,7 +240,7 @@ void RailDBContext::activateBase()
 
 void RailDBContext::actShowAdj()
 {
-    if (net.empty()) {
+    if (net.empty() || _netStale) {
         loadNet();
     }
     auto* dlg = new ViewAdjacentWidget(net, mw);
@@ -236,12 +249,45 @@ void RailDBContext::actShowAdj()
 
 void RailDBContext::actRefreshNet()
 {
-    net.clear();
-    net.fromRailCategory(_raildb.get());
+    loadNet();
 
     // 这里放后续的刷新工作
 }
 
+void RailDBContext::onDBChanged()
+{
+    // 线网是数据库的快照：此后第一次使用时重新读取，并重建索引
+    if (!net.empty()) {
+        net.invalidateIndex();
+        _netStale = true;
+    }
+}
+
+void RailDBContext::actBenchmarkIndex()
+{
+    activateBase();
+    if (net.empty() || _netStale) {
+        loadNet();
+    }
+    if (net.empty()) {
+        QMessageBox::warning(mw, tr("警告"), tr("当前有向图模型为空，无法测速。"));
+        return;
+    }
+    constexpr int queries = 200;
+    auto res = net.benchmarkIndex(queries);
+    QMessageBox::information(mw, tr("最短路索引测速"),
+        tr("随机查询%1对车站：\n"
+            "逐次最短路算法：平均%2微秒\n"
+            "最短路索引：平均%3微秒\n"
+            "加速比：%4\n"
+            "结果不一致：%5次")
+        .arg(res.queries)
+        .arg(res.ssspMicros / res.queries, 0, 'f', 1)
+        .arg(res.indexMicros / res.queries, 0, 'f', 2)
+        .arg(res.ssspMicros / std::max(res.indexMicros, 1e-3), 0, 'f', 1)
+        .arg(res.mismatches));
+}
+
 void RailDBContext::onQuickToggled(bool on)
 {
     if (on && quickSelector == nullptr) {
@@ -252,7 +298,7 @@ void RailDBContext::onQuickToggled(bool on)
 void RailDBContext::actPathSelector()
 {
     activateBase();
-    if (net.empty()) {
+    if (net.empty() || _netStale) {
         loadNet();
         if (net.empty()) {
             QMessageBox::warning(mw, tr("警告"), tr("当前有向图模型为空，无法进行经由选择。"
@@ -273,11 +319,33 @@ void RailDBContext::loadNet()
 {
     using namespace std::chrono_literals;
     auto start = std::chrono::system_clock::now();
+    _netStale = false;
+
+    // 数据库与文件一致时，优先读取线网缓存
+    QString cacheFile;
+    if (!_raildb->filename().isEmpty() && !_raildb->contentHash().isEmpty() &&
+        getNavi()->undoStack()->isClean()) {
+        cacheFile = RailNet::cacheFileName(_raildb->filename());
+        if (net.loadCache(cacheFile, _raildb->contentHash())) {
+            if (!net.hasIndex())
+                net.buildIndex();
+            auto end = std::chrono::system_clock::now();
+            mw->showStatus(tr("线网有向图从缓存加载完毕  共%1站 用时%2毫秒")
+                .arg(net.size()).arg((end - start) / 1ms));
+            return;
+        }
+    }
+
     net.clear();
     net.fromRailCategory(_raildb.get());
+    auto mid = std::chrono::system_clock::now();
+    net.buildIndex();
     auto end = std::chrono::system_clock::now();
-    mw->showStatus(tr("线网有向图加载完毕  共%1站 用时%2毫秒").arg(net.size())
-        .arg((end - start) / 1ms));
+    if (!cacheFile.isEmpty())
+        net.saveCache(cacheFile, _raildb->contentHash());
+    mw->showStatus(tr("线网有向图加载完毕  共%1站 用时%2毫秒  最短路索引%3条捷径 用时%4毫秒")
+        .arg(net.size()).arg((mid - start) / 1ms)
+        .arg(net.index()->shortcutCount()).arg((end - mid) / 1ms));
 }
 
 void RailDBContext::previewRail(std::shared_ptr<Railway> railway, const QString& pathString)
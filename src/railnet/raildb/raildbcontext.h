@@ -35,6 +35,7 @@ class RailDBContext : public QObject
     const std::shared_ptr<RailDB> _raildb;
     RailNet net;
     bool _active = false;
+    bool _netStale = false;   // 加载线网之后数据库有改动
 
     RailPreviewDialog* dlgPreview=nullptr;
 public:
@@ -113,6 +114,16 @@ private slots:
 
     void actRefreshNet();
 
+    /**
+     * 2026.10.19  数据库改动：线网（及其最短路索引）过期，下次使用时重新读取
+     */
+    void onDBChanged();
+
+    /**
+     * 2026.10.19  比较有无最短路索引时的查询耗时
+     */
+    void actBenchmarkIndex();
+
     void onQuickToggled(bool on);
 
     
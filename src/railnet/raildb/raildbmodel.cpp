@@ -119,26 +119,17 @@ QModelIndex RailDBModel::categoryIndexBrute(std::shared_ptr<RailCategory> catego
 
 std::deque<navi::path_t> RailDBModel::searchFullName(const QString &name)
 {
-    auto func=[&name](const Railway& rail)->bool{
-        return bool(rail.stationByName(name));
-    };
-    return _root->searchBy(func);
+    return searchIndex.searchFullName(_root.get(), name);
 }
 
 std::deque<navi::path_t> RailDBModel::searchPartName(const QString &name)
 {
-    auto func=[&name](const Railway& rail)->bool{
-        return bool(rail.stationByGeneralName(name));
-    };
-    return _root->searchBy(func);
+    return searchIndex.searchPartName(_root.get(), name);
 }
 
 std::deque<navi::path_t> RailDBModel::searchRailName(const QString &name)
 {
-    auto func=[&name](const Railway& rail)->bool{
-        return rail.name().contains(name);
-    };
-    return _root->searchBy(func);
+    return searchIndex.searchRailName(_root.get(), name);
 }
 
 std::shared_ptr<Railway> RailDBModel::railwayByPath(const navi::path_t &path)
@@ -228,6 +219,7 @@ void RailDBModel::onRailInfoChanged(std::shared_ptr<Railway> railway, const std:
             railway->name() << ", will use brute-force alg. " << Qt::endl;
         idx = railIndexBrute(railway);
     }
+    searchIndex.updateRailway(railway);
     emit dataChanged(idx, index(idx.row(), ACI::DBColMAX - 1, idx.parent()), 
         { Qt::EditRole });
 }
@@ -259,6 +251,7 @@ void RailDBModel::commitRemoveRailwayAt(std::shared_ptr<Railway> railway,
     auto* par_it = static_cast<navi::RailCategoryItem*>(getParentItem(par));
     par_it->removeRailwayAt(path.back());
     endRemoveRows();
+    searchIndex.markStructureChanged();
 }
 
 void RailDBModel::commitInsertRailwayAt(std::shared_ptr<Railway> railway, const std::deque<int>& path)
@@ -270,6 +263,7 @@ void RailDBModel::commitInsertRailwayAt(std::shared_ptr<Railway> railway, const
     auto* par_it = static_cast<navi::RailCategoryItem*>(getParentItem(par));
     par_it->insertRailwayAt(railway, path.back());
     endInsertRows();
+    searchIndex.markStructureChanged();
 }
 
 void RailDBModel::commitInsertRailwaysAt(const QList<std::shared_ptr<Railway>>& rails,
@@ -281,6 +275,7 @@ void RailDBModel::commitInsertRailwaysAt(const QList<std::shared_ptr<Railway>>&
     auto* par_it = static_cast<navi::RailCategoryItem*>(getParentItem(par));
     par_it->insertRailwaysAt(rails, path.back());
     endInsertRows();
+    searchIndex.markStructureChanged();
 }
 
 void RailDBModel::commitRemoveRailwaysAt(const QList<std::shared_ptr<Railway>>& rails, const std::deque<int>& path)
@@ -298,6 +293,7 @@ void RailDBModel::commitRemoveRailwaysAt(const QList<std::shared_ptr<Railway>>&
     auto* par_it = static_cast<navi::RailCategoryItem*>(getParentItem(par));
     par_it->removeRailwaysAt(path.back(), rails.size());
     endRemoveRows();
+    searchIndex.markStructureChanged();
 }
 
 void RailDBModel::commitInsertCategoryAt(std::shared_ptr<RailCategory> cat,
@@ -309,6 +305,7 @@ void RailDBModel::commitInsertCategoryAt(std::shared_ptr<RailCategory> cat,
     auto* it = static_cast<navi::RailCategoryItem*>(getParentItem(par));
     it->insertCategoryAt(cat, path.back());
     endInsertRows();
+    searchIndex.markStructureChanged();
 }
 
 void RailDBModel::commitRemoveCategoryAt(std::shared_ptr<RailCategory> cat, 
@@ -327,11 +324,13 @@ void RailDBModel::commitRemoveCategoryAt(std::shared_ptr<RailCategory> cat,
     beginRemoveRows(par, path.back(), path.back());
     par_it->removeCategoryAt(path.back());
     endRemoveRows();
+    searchIndex.markStructureChanged();
 }
 
 void RailDBModel::resetModel()
 {
     beginResetModel();
     _root=std::make_unique<navi::RailCategoryItem>(_raildb,0,nullptr);
+    searchIndex.clear();
     endResetModel();
 }
@@ -4,6 +4,7 @@
 #include <memory>
 
 #include "raildbitems.h"
+#include "raildbsearchindex.h"
 class RailDB;
 
 class RailDBModel : public QAbstractItemModel
@@ -11,6 +12,7 @@ class RailDBModel : public QAbstractItemModel
     Q_OBJECT;
     std::shared_ptr<RailDB> _raildb;
     std::unique_ptr<navi::RailCategoryItem> _root;
+    RailDBSearchIndex searchIndex;
 
     using ACI=navi::AbstractComponentItem;
     using pACI=ACI*;
@@ -43,6 +45,9 @@ public:
     QModelIndex railIndexBrute(std::shared_ptr<Railway> railway);
     QModelIndex categoryIndexBrute(std::shared_ptr<RailCategory> category);
 
+    /**
+     * 2026.10.19  以下搜索使用searchIndex，结果与逐条遍历（searchBy）相同
+     */
     std::deque<navi::path_t> searchFullName(const QString& name);
     std::deque<navi::path_t> searchPartName(const QString& name);
     std::deque<navi::path_t> searchRailName(const QString& name);
@@ -0,0 +1,136 @@
+﻿#include "raildbsearchindex.h"
+#include "data/rail/railway.h"
+
+#include <algorithm>
+
+void RailDBSearchIndex::clear()
+{
+    ordered.clear();
+    order.clear();
+    stationRails.clear();
+    railStations.clear();
+    structureDirty = true;
+}
+
+void RailDBSearchIndex::updateRailway(const std::shared_ptr<const Railway>& railway)
+{
+    if (!railway || railStations.find(railway.get()) == railStations.end())
+        return;   // 尚未登记的线路在下次ensure时登记
+    removeStations(railway.get());
+    addStations(railway);
+}
+
+void RailDBSearchIndex::ensure(navi::RailCategoryItem* root)
+{
+    if (!structureDirty)
+        return;
+    ordered.clear();
+    order.clear();
+    collect(root);
+
+    // 同步站名索引：只处理新增和删除的线路
+    for (auto itr = railStations.begin(); itr != railStations.end();) {
+        if (order.find(itr->first) == order.end()) {
+            const Railway* rail = itr->first;
+            ++itr;
+            removeStations(rail);
+        }
+        else ++itr;
+    }
+    for (const auto& e : ordered) {
+        if (railStations.find(e.railway.get()) == railStations.end())
+            addStations(e.railway);
+    }
+    structureDirty = false;
+}
+
+void RailDBSearchIndex::collect(navi::AbstractComponentItem* item)
+{
+    // 与searchBy相同：先子分类，后线路；子分类排在线路之前
+    for (int i = 0; i < item->childCount(); i++) {
+        auto* sub = item->child(i);
+        if (!sub) continue;
+        if (sub->type() == navi::RailCategoryItem::Type) {
+            collect(sub);
+        }
+        else if (sub->type() == navi::RailwayItemDB::Type) {
+            auto* it = static_cast<navi::RailwayItemDB*>(sub);
+            std::shared_ptr<const Railway> rail = it->railway();
+            order.emplace(rail.get(), static_cast<int>(ordered.size()));
+            ordered.push_back({ it, rail });
+        }
+    }
+}
+
+void RailDBSearchIndex::addStations(const std::shared_ptr<const Railway>& railway)
+{
+    Indexed idx{ railway, {} };
+    idx.names.reserve(railway->stationCount());
+    for (const auto& st : railway->stations()) {
+        stationRails[st->name].insert(railway.get());
+        idx.names.push_back(st->name);
+    }
+    railStations[railway.get()] = std::move(idx);
+}
+
+void RailDBSearchIndex::removeStations(const Railway* railway)
+{
+    auto itr = railStations.find(railway);
+    if (itr == railStations.end())
+        return;
+    for (const auto& name : itr->second.names) {
+        auto p = stationRails.find(name);
+        if (p != stationRails.end()) {
+            p->remove(railway);
+            if (p->isEmpty())
+                stationRails.erase(p);
+        }
+    }
+    railStations.erase(itr);
+}
+
+std::deque<navi::path_t> RailDBSearchIndex::toPaths(const QSet<const Railway*>& rails) const
+{
+    std::vector<int> idx;
+    idx.reserve(rails.size());
+    for (const auto* r : rails) {
+        if (auto itr = order.find(r); itr != order.end())
+            idx.push_back(itr->second);
+    }
+    std::sort(idx.begin(), idx.end());
+    std::deque<navi::path_t> res;
+    for (int i : idx)
+        res.emplace_back(ordered.at(i).item->path());
+    return res;
+}
+
+std::deque<navi::path_t> RailDBSearchIndex::searchFullName(navi::RailCategoryItem* root,
+    const QString& name)
+{
+    ensure(root);
+    return toPaths(stationRails.value(StationName(name)));
+}
+
+std::deque<navi::path_t> RailDBSearchIndex::searchPartName(navi::RailCategoryItem* root,
+    const QString& name)
+{
+    ensure(root);
+    // 与Railway::stationByGeneralName一致：完全相同，或者线路中的站不带场名且站名相同
+    StationName sn(name);
+    QSet<const Railway*> rails = stationRails.value(sn);
+    if (!sn.isSingleName())
+        rails.unite(stationRails.value(StationName(sn.station(), QString())));
+    return toPaths(rails);
+}
+
+std::deque<navi::path_t> RailDBSearchIndex::searchRailName(navi::RailCategoryItem* root,
+    const QString& name)
+{
+    ensure(root);
+    std::deque<navi::path_t> res;
+    for (const auto& e : ordered) {
+        if (e.railway->name().contains(name))
+            res.emplace_back(e.item->path());
+    }
+    return res;
+}
@@ -0,0 +1,80 @@
+﻿#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QString>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "data/common/stationname.h"
+#include "raildbitems.h"
+
+class Railway;
+
+/**
+ * @brief The RailDBSearchIndex class
+ * 2026.10.19  线路数据库的搜索索引，由RailDBModel持有。
+ * 站名 -> 含有该站的线路；线路按树中的深度优先顺序排列，
+ * 因此搜索结果与navi::RailCategoryItem::searchBy逐条遍历的结果（及其顺序）相同。
+ * 树结构的改动（增删线路、分类）只做标记，下次搜索时重新遍历树（不遍历站表），
+ * 并只为新增/删除的线路更新站名索引；线路站表的改动由updateRailway增量更新。
+ */
+class RailDBSearchIndex
+{
+    struct Entry {
+        navi::RailwayItemDB* item;
+        std::shared_ptr<const Railway> railway;
+    };
+
+    // 树中全部线路，深度优先顺序（与searchBy一致）
+    std::vector<Entry> ordered;
+    std::unordered_map<const Railway*, int> order;
+    bool structureDirty = true;
+
+    QHash<StationName, QSet<const Railway*>> stationRails;
+
+    // 各线路已登记的站名，用于删除；同时持有线路，避免地址被复用
+    struct Indexed {
+        std::shared_ptr<const Railway> railway;
+        QList<StationName> names;
+    };
+    std::unordered_map<const Railway*, Indexed> railStations;
+
+public:
+    RailDBSearchIndex() = default;
+
+    /**
+     * 增删了线路或分类（包括重置）。只做标记。
+     */
+    void markStructureChanged() { structureDirty = true; }
+
+    /**
+     * 清空索引（模型重置时）
+     */
+    void clear();
+
+    /**
+     * 线路的站表（可能）改变，更新该线路的站名索引。
+     */
+    void updateRailway(const std::shared_ptr<const Railway>& railway);
+
+    /**
+     * 与RailDBModel::searchFullName等含义相同。root为模型的根节点。
+     */
+    std::deque<navi::path_t> searchFullName(navi::RailCategoryItem* root, const QString& name);
+    std::deque<navi::path_t> searchPartName(navi::RailCategoryItem* root, const QString& name);
+    std::deque<navi::path_t> searchRailName(navi::RailCategoryItem* root, const QString& name);
+
+private:
+    void ensure(navi::RailCategoryItem* root);
+    void collect(navi::AbstractComponentItem* item);
+    void addStations(const std::shared_ptr<const Railway>& railway);
+    void removeStations(const Railway* railway);
+
+    /**
+     * 将一组线路按树中顺序转换为路径表
+     */
+    std::deque<navi::path_t> toPaths(const QSet<const Railway*>& rails)const;
+};
@@ -0,0 +1,63 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace qeutil {
+
+/**
+ * 2026.10.19  数据并行计算使用的线程数。
+ * 按照硬件线程数，但保证每个线程至少分到grain个任务；至少返回1。
+ */
+inline int parallelChunkCount(int n, int grain = 1)
+{
+    if (n <= 0) return 1;
+    int hw = static_cast<int>(std::thread::hardware_concurrency());
+    if (hw <= 0) hw = 1;
+    grain = std::max(grain, 1);
+    return std::clamp((n + grain - 1) / grain, 1, hw);
+}
+
+/**
+ * 2026.10.19  将[0, n)按顺序切分为若干连续段，每段在一个线程中执行
+ * func(chunk, begin, end)。chunk从0开始，与段的顺序一致，
+ * 调用方可以按chunk分配线程私有的缓存，最后按chunk顺序合并，保证结果的确定性。
+ * 只有一段时直接在当前线程执行。阻塞直到所有段完成。
+ * 注意：func内只能做只读访问或者写入本chunk私有的数据。
+ * @return  实际使用的段数
+ */
+template <typename Func>
+int parallelForChunks(int n, Func&& func, int grain = 1)
+{
+    const int chunks = parallelChunkCount(n, grain);
+    if (chunks <= 1) {
+        if (n > 0) func(0, 0, n);
+        return 1;
+    }
+    std::vector<std::thread> workers;
+    workers.reserve(chunks - 1);
+    const int step = (n + chunks - 1) / chunks;
+    for (int c = 1; c < chunks; c++) {
+        int begin = c * step, end = std::min(n, begin + step);
+        workers.emplace_back([&func, c, begin, end]() {
+            if (begin < end) func(c, begin, end);
+            });
+    }
+    func(0, 0, std::min(n, step));
+    for (auto& t : workers) t.join();
+    return chunks;
+}
+
+/**
+ * 2026.10.19  逐元素并行：对每个i in [0, n) 执行 func(i)。
+ */
+template <typename Func>
+void parallelFor(int n, Func&& func, int grain = 1)
+{
+    parallelForChunks(n, [&func](int, int begin, int end) {
+        for (int i = begin; i < end; i++) func(i);
+        }, grain);
+}
+
+}
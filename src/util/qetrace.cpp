@@ -0,0 +1,295 @@
+#include "qetrace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+namespace qetrace {
+
+    namespace {
+
+        std::atomic_bool enabled{ false };
+
+        const auto clockStart = std::chrono::steady_clock::now();
+
+        /**
+         * 环形缓冲区的一个槽位。第i条记录（从0计）写入时seq为2i+1，写完后为2i+2；
+         * 读取者在读取前后检查seq，不一致则说明读取期间被写入，丢弃。
+         * 各字段都是原子变量（relaxed），使并发读写不构成数据竞争。
+         */
+        struct Slot {
+            std::atomic<std::uint64_t> seq{ 0 };
+            std::atomic<const char*> name{ nullptr };
+            std::atomic<std::int64_t> beginNs{ 0 }, durNs{ 0 };
+            std::atomic<std::uint32_t> depth{ 0 };
+        };
+
+        /**
+         * 单个线程的环形缓冲区。只有所属线程写入；head为已写入的总条数，写完一条后以release方式更新。
+         * start为读取起点，由clear()设置，写入者不使用
+         */
+        struct ThreadBuffer {
+            std::uint32_t tid;
+            std::unique_ptr<Slot[]> ring;
+            std::atomic<std::uint64_t> head{ 0 };
+            std::atomic<std::uint64_t> start{ 0 };
+            std::uint32_t depth = 0;
+
+            explicit ThreadBuffer(std::uint32_t tid_) :
+                tid(tid_), ring(std::make_unique<Slot[]>(BUFFER_CAPACITY)) {}
+
+            void write(const Event& ev)
+            {
+                const auto h = head.load(std::memory_order_relaxed);
+                auto& slot = ring[h % BUFFER_CAPACITY];
+                slot.seq.store(2 * h + 1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+                slot.name.store(ev.name, std::memory_order_relaxed);
+                slot.beginNs.store(ev.beginNs, std::memory_order_relaxed);
+                slot.durNs.store(ev.durNs, std::memory_order_relaxed);
+                slot.depth.store(ev.depth, std::memory_order_relaxed);
+                slot.seq.store(2 * h + 2, std::memory_order_release);
+                head.store(h + 1, std::memory_order_release);
+            }
+
+            /**
+             * 读取第i条记录；已被覆盖或正在写入时返回false
+             */
+            bool read(std::uint64_t i, Event& ev)const
+            {
+                const auto& slot = ring[i % BUFFER_CAPACITY];
+                if (slot.seq.load(std::memory_order_acquire) != 2 * i + 2)
+                    return false;
+                ev.name = slot.name.load(std::memory_order_relaxed);
+                ev.beginNs = slot.beginNs.load(std::memory_order_relaxed);
+                ev.durNs = slot.durNs.load(std::memory_order_relaxed);
+                ev.depth = slot.depth.load(std::memory_order_relaxed);
+                ev.tid = tid;
+                std::atomic_thread_fence(std::memory_order_acquire);
+                return slot.seq.load(std::memory_order_relaxed) == 2 * i + 2;
+            }
+        };
+
+        /**
+         * 所有缓冲区的登记表。互斥锁只在线程首次记录、线程退出以及导出时使用
+         */
+        struct Registry {
+            std::mutex mtx;
+            std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+            std::vector<ThreadBuffer*> freeBuffers;
+            std::uint32_t nextTid = 1;
+
+            ThreadBuffer* acquire()
+            {
+                std::lock_guard lock(mtx);
+                if (!freeBuffers.empty()) {
+                    auto* buf = freeBuffers.back();
+                    freeBuffers.pop_back();
+                    buf->depth = 0;
+                    return buf;
+                }
+                buffers.emplace_back(std::make_unique<ThreadBuffer>(nextTid++));
+                return buffers.back().get();
+            }
+
+            void release(ThreadBuffer* buf)
+            {
+                std::lock_guard lock(mtx);
+                freeBuffers.push_back(buf);
+            }
+        };
+
+        Registry& registry()
+        {
+            static Registry reg;
+            return reg;
+        }
+
+        struct LocalHolder {
+            ThreadBuffer* buf = nullptr;
+            ~LocalHolder() {
+                if (buf) registry().release(buf);
+            }
+        };
+
+        thread_local LocalHolder localHolder;
+
+        ThreadBuffer* localBuffer()
+        {
+            if (!localHolder.buf)
+                localHolder.buf = registry().acquire();
+            return localHolder.buf;
+        }
+    }
+
+    bool compiledIn()
+    {
+#ifdef QETRC_TRACE
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void setEnabled(bool on)
+    {
+        enabled.store(on, std::memory_order_relaxed);
+    }
+
+    bool isEnabled()
+    {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    std::int64_t nowNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - clockStart).count();
+    }
+
+    Span::Span(const char* name) :
+        _name(name), _begin(0), _active(isEnabled())
+    {
+        if (_active) {
+            localBuffer()->depth++;
+            _begin = nowNs();
+        }
+    }
+
+    Span::~Span()
+    {
+        if (!_active)
+            return;
+        const auto end = nowNs();
+        auto* buf = localBuffer();
+        buf->depth--;
+        buf->write(Event{ _name, _begin, end - _begin, buf->tid, buf->depth });
+    }
+
+    void clear()
+    {
+        auto& reg = registry();
+        std::lock_guard lock(reg.mtx);
+        for (auto& buf : reg.buffers) {
+            buf->start.store(buf->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+        }
+    }
+
+    std::vector<Event> snapshot()
+    {
+        std::vector<Event> res;
+        auto& reg = registry();
+        {
+            std::lock_guard lock(reg.mtx);
+            for (const auto& buf : reg.buffers) {
+                const auto h = buf->head.load(std::memory_order_acquire);
+                const auto n = std::min<std::uint64_t>(h, BUFFER_CAPACITY);
+                const auto first = std::max(h - n, buf->start.load(std::memory_order_relaxed));
+                Event ev;
+                for (auto i = first; i < h; i++) {
+                    if (buf->read(i, ev))
+                        res.push_back(ev);
+                }
+            }
+        }
+        std::sort(res.begin(), res.end(), [](const Event& a, const Event& b) {
+            return a.beginNs < b.beginNs;
+            });
+        return res;
+    }
+
+    bool dumpChromeTrace(const QString& filename)
+    {
+        const auto events = snapshot();
+        const qint64 pid = QCoreApplication::applicationPid();
+        QJsonArray arr;
+        std::map<std::uint32_t, bool> tids;
+        for (const auto& ev : events) {
+            arr.append(QJsonObject{
+                {"name", QString::fromUtf8(ev.name)},
+                {"cat", "qetrc"},
+                {"ph", "X"},
+                {"ts", ev.beginNs / 1000.0},
+                {"dur", ev.durNs / 1000.0},
+                {"pid", pid},
+                {"tid", static_cast<qint64>(ev.tid)},
+                {"args", QJsonObject{ {"depth", static_cast<qint64>(ev.depth)} }},
+                });
+            tids[ev.tid] = true;
+        }
+        for (const auto& [tid, _] : tids) {
+            arr.append(QJsonObject{
+                {"name", "thread_name"},
+                {"ph", "M"},
+                {"pid", pid},
+                {"tid", static_cast<qint64>(tid)},
+                {"args", QJsonObject{ {"name", QStringLiteral("thread %1").arg(tid)} }},
+                });
+        }
+        QJsonObject obj{
+            {"traceEvents", arr},
+            {"displayTimeUnit", "ms"},
+        };
+        QFile f(filename);
+        if (!f.open(QFile::WriteOnly))
+            return false;
+        f.write(QJsonDocument(obj).toJson(QJsonDocument::Compact));
+        return true;
+    }
+
+    std::vector<StageSummary> summarize()
+    {
+        std::map<QString, StageSummary> stages;
+        for (const auto& ev : snapshot()) {
+            const QString name = QString::fromUtf8(ev.name);
+            auto& s = stages[name];
+            s.name = name;
+            s.count++;
+            s.totalNs += ev.durNs;
+            s.maxNs = std::max(s.maxNs, ev.durNs);
+        }
+        std::vector<StageSummary> res;
+        res.reserve(stages.size());
+        for (auto& [name, s] : stages)
+            res.push_back(std::move(s));
+        std::sort(res.begin(), res.end(), [](const StageSummary& a, const StageSummary& b) {
+            return a.totalNs > b.totalNs;
+            });
+        return res;
+    }
+
+    void logSummary()
+    {
+        const auto stages = summarize();
+        if (stages.empty()) {
+            qInfo().noquote() << QObject::tr("计时记录为空");
+            return;
+        }
+        qInfo().noquote() << QObject::tr("各阶段耗时汇总（次数 / 总计 / 平均 / 最长，毫秒）：");
+        for (const auto& s : stages) {
+            qInfo().noquote() << QStringLiteral("  %1  %2 / %3 / %4 / %5").arg(s.name)
+                .arg(s.count)
+                .arg(s.totalNs / 1e6, 0, 'f', 3)
+                .arg(s.totalNs / 1e6 / s.count, 0, 'f', 3)
+                .arg(s.maxNs / 1e6, 0, 'f', 3);
+        }
+    }
+
+    QString traceFileFromArgs(const QStringList& args)
+    {
+        int idx = args.indexOf(QStringLiteral("--trace"));
+        if (idx >= 0 && idx + 1 < args.size())
+            return args.at(idx + 1);
+        return {};
+    }
+}
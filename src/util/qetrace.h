@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <QString>
+#include <QStringList>
+
+/**
+ * 2026.10.19  轻量的分层计时（tracing）工具。
+ *
+ * 在代码中用 QE_TRACE_SCOPE("名称") 标记一个作用域（span），作用域结束时记录其起止时刻；
+ * 嵌套的span在Chrome trace中按时间自然形成层次。名称必须是字符串字面量（只保存指针）。
+ *
+ * 每个线程写自己的环形缓冲区（单写者，无锁）；缓冲区满后覆盖最旧的记录。
+ * 每个槽位带有序号（seqlock），导出和清空不需要暂停记录：读取时跳过正在被写入或已被覆盖的槽位。
+ * 线程退出后，其缓冲区连同记录留给之后新建的线程复用，因此短命的工作线程不会使缓冲区无限增加。
+ * 运行时默认关闭：关闭时每个span只有一次原子读的开销。
+ * 编译时不定义QETRC_TRACE（CMake选项QETRC_ENABLE_TRACE=OFF）则QE_TRACE_SCOPE展开为空，
+ * 以下接口仍然存在，但不会有任何记录。
+ *
+ * 结果可以导出为Chrome trace / Perfetto可读的JSON（chrome://tracing, ui.perfetto.dev），
+ * 也可以按名称汇总后输出到日志窗口。
+ */
+namespace qetrace {
+
+    /**
+     * 一条完成的span记录，时刻为自进程内计时起点的纳秒数
+     */
+    struct Event {
+        const char* name = nullptr;
+        std::int64_t beginNs = 0;
+        std::int64_t durNs = 0;
+        std::uint32_t tid = 0;    // 本工具分配的线程序号，从1开始
+        std::uint32_t depth = 0;  // 同一线程内的嵌套深度，从0开始
+    };
+
+    /**
+     * 按名称汇总的各阶段耗时
+     */
+    struct StageSummary {
+        QString name;
+        int count = 0;
+        std::int64_t totalNs = 0, maxNs = 0;
+    };
+
+    /**
+     * 每个线程环形缓冲区的容量（条）
+     */
+    constexpr int BUFFER_CAPACITY = 1 << 14;
+
+    bool compiledIn();
+
+    void setEnabled(bool on);
+    bool isEnabled();
+
+    /**
+     * 清空所有线程的记录。可以与正在记录的线程并发调用：
+     * 只移动各缓冲区的读取起点，此后完成的span照常记录。
+     */
+    void clear();
+
+    /**
+     * 所有线程当前保留的记录，按开始时刻排序。
+     * 可以与正在记录的线程并发调用；读取期间被覆盖的记录不包含在结果中，不会读到不完整的记录。
+     */
+    std::vector<Event> snapshot();
+
+    /**
+     * 写出Chrome trace格式的JSON文件
+     */
+    bool dumpChromeTrace(const QString& filename);
+
+    std::vector<StageSummary> summarize();
+
+    /**
+     * 以qInfo()输出汇总表（显示在日志窗口中）
+     */
+    void logSummary();
+
+    /**
+     * 命令行参数 --trace <file>：返回file，没有则返回空串
+     */
+    QString traceFileFromArgs(const QStringList& args);
+
+    std::int64_t nowNs();
+
+    /**
+     * 作用域计时。不直接使用，见QE_TRACE_SCOPE
+     */
+    class Span {
+        const char* _name;
+        std::int64_t _begin;
+        bool _active;
+    public:
+        explicit Span(const char* name);
+        ~Span();
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+    };
+}
+
+#ifdef QETRC_TRACE
+#define QE_TRACE_CONCAT_IMPL(a, b) a##b
+#define QE_TRACE_CONCAT(a, b) QE_TRACE_CONCAT_IMPL(a, b)
+#define QE_TRACE_SCOPE(_name) ::qetrace::Span QE_TRACE_CONCAT(_qe_trace_span_, __LINE__)(_name)
+#else
+#define QE_TRACE_SCOPE(_name) do {} while (false)
+#endif
@@ -80,7 +80,7 @@ QString qeutil::secsDiffToString(int secs)
 }
 
 const QString qeutil::fileFilter =
-	QObject::tr("pyETRC运行图文件(*.pyetgr;*.json)\nETRC运行图文件(*.trc)\n所有文件(*.*)");
+	QObject::tr("pyETRC运行图文件(*.pyetgr;*.json)\nqETRC二进制运行图文件(*.pyetgrb)\nETRC运行图文件(*.trc)\n所有文件(*.*)");
 
 bool qeutil::tableToCsv(const QStandardItemModel* model, const QString& filename)
 {
@@ -16,6 +16,7 @@
 #include <editors/train/trainfilterselector.h>
 #include <data/common/qesystem.h>
 #include <data/diagram/diagram.h>
+#include <data/diagram/diagramworkspace.h>
 #include <viewers/traintimetableplane.h>
 #include <util/dialogadapter.h>
 
@@ -155,15 +156,15 @@ void DiagramCompareDialog::initUI()
 
 bool DiagramCompareDialog::loadFile(const QString &filename)
 {
-    Diagram dia;
-    bool flag=dia.fromJson(filename);
-    if (!flag){
+    // 2026.10.19: 经由DiagramWorkspace读取，反复对比同一文件（或同一线路的多个版本）时不必重新解析
+    auto dia = DiagramWorkspace::get()->open(filename);
+    if (!dia){
         QMessageBox::warning(this,tr("错误"),tr("运行图文件错误或为空，无法读取。"));
         return false;
     }
     using namespace std::chrono_literals;
     auto c_start = std::chrono::system_clock::now();
-    auto t=diagram.trainCollection().diffWith(dia.trainCollection());
+    auto t=diagram.trainCollection().diffWith(dia->trainCollection());
     auto c_end = std::chrono::system_clock::now();
     model->resetData(std::move(t));
     auto c_end2 = std::chrono::system_clock::now();
@@ -0,0 +1,100 @@
+#include "capacityslotmapdialog.h"
+
+#include <QHeaderView>
+#include <QLabel>
+#include <QStandardItemModel>
+#include <QTabWidget>
+#include <QTableView>
+#include <QVBoxLayout>
+
+#include <data/common/qesystem.h>
+#include <util/utilfunc.h>
+
+CapacitySlotMapDialog::CapacitySlotMapDialog(const CapacitySlotMap& map, QWidget* parent):
+    QDialog(parent)
+{
+    setWindowTitle(tr("线位扫描"));
+    setAttribute(Qt::WA_DeleteOnClose);
+    resize(900, 700);
+    initUI();
+    for (const auto& res : map.results()) {
+        tab->addTab(makePage(res, map.stepSecs()), DirFunc::dirToString(res.dir));
+    }
+}
+
+void CapacitySlotMapDialog::initUI()
+{
+    auto* vlay = new QVBoxLayout(this);
+    tab = new QTabWidget;
+    vlay->addWidget(tab);
+}
+
+QWidget* CapacitySlotMapDialog::makePage(const CapacitySlotMap::Result& res, int stepSecs)
+{
+    auto* w = new QWidget;
+    auto* vlay = new QVBoxLayout(w);
+
+    const auto& sum = res.summary;
+    QString text = tr("扫描步长 %1，共 %2 个锚点时刻，其中可排 %3 个 (%4%)，去重后不同线位 %5 条。")
+        .arg(qeutil::secsToString(stepSecs))
+        .arg(sum.slotCount).arg(sum.feasibleCount)
+        .arg(sum.feasibleRatio() * 100, 0, 'f', 1)
+        .arg(sum.distinctCount);
+    if (sum.feasibleCount) {
+        text.append(tr("\n运行时分：最短 %1，最长 %2，平均 %3。")
+            .arg(qeutil::secsToString(sum.minRunSecs))
+            .arg(qeutil::secsToString(sum.maxRunSecs))
+            .arg(qeutil::secsToString(sum.avgRunSecs)));
+    }
+    auto* lab = new QLabel(text);
+    lab->setWordWrap(true);
+    vlay->addWidget(lab);
+
+    // 每行一小时；步长不整除一小时的，每行取整后的锚点数
+    const int cols = std::max(1, 3600 / stepSecs);
+    const int n = static_cast<int>(res.slots.size());
+    const int rows = (n + cols - 1) / cols;
+
+    auto* model = new QStandardItemModel(rows, cols, w);
+    QStringList vlabels, hlabels;
+    for (int c = 0; c < cols; c++) {
+        hlabels.append(QTime(0, 0).addSecs(c * stepSecs).toString("mm:ss"));
+    }
+    for (int r = 0; r < rows; r++) {
+        vlabels.append(res.slots.at(r * cols).anchorTime.toString("hh:mm"));
+    }
+    model->setHorizontalHeaderLabels(hlabels);
+    model->setVerticalHeaderLabels(vlabels);
+
+    const int span = std::max(sum.maxRunSecs - sum.minRunSecs, 1);
+    for (int i = 0; i < n; i++) {
+        const auto& slot = res.slots.at(i);
+        auto* it = new QStandardItem;
+        it->setEditable(false);
+        it->setTextAlignment(Qt::AlignCenter);
+        if (slot.feasible) {
+            it->setText(QString::number(slot.runSecs / 60));
+            // 运行时分越短越绿，越长越黄
+            int hue = 120 - 60 * (slot.runSecs - sum.minRunSecs) / span;
+            it->setBackground(QColor::fromHsv(hue, 110, 235));
+            it->setToolTip(tr("锚点 %1\n出发 %2  到达 %3\n运行时分 %4")
+                .arg(slot.anchorTime.toString("hh:mm:ss"),
+                    slot.startTime.toString("hh:mm:ss"),
+                    slot.endTime.toString("hh:mm:ss"),
+                    qeutil::secsToString(slot.runSecs)));
+        }
+        else {
+            it->setBackground(Qt::lightGray);
+            it->setToolTip(tr("锚点 %1\n无可排线位").arg(slot.anchorTime.toString("hh:mm:ss")));
+        }
+        model->setItem(i / cols, i % cols, it);
+    }
+
+    auto* table = new QTableView;
+    table->setModel(model);
+    table->verticalHeader()->setDefaultSectionSize(SystemJson::instance.table_row_height);
+    table->horizontalHeader()->setDefaultSectionSize(45);
+    table->setSelectionMode(QTableView::NoSelection);
+    vlay->addWidget(table);
+    return w;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <QDialog>
+#include <data/calculation/capacityslotmap.h>
+
+class QTabWidget;
+
+/**
+ * 2026.10.19
+ * @brief The CapacitySlotMapDialog class
+ * 展示线位扫描（CapacitySlotMap）的结果：每个方向一页，
+ * 上方为剩余能力的汇总，下方为线位分布图。
+ * 图中每行为连续的若干锚点时刻，单元格显示该锚点试排的运行时分（分钟），
+ * 可排的按运行时分由短到长着色，不可排的置灰。
+ */
+class CapacitySlotMapDialog : public QDialog
+{
+    Q_OBJECT
+    QTabWidget* tab;
+public:
+    CapacitySlotMapDialog(const CapacitySlotMap& map, QWidget* parent = nullptr);
+
+private:
+    void initUI();
+    QWidget* makePage(const CapacitySlotMap::Result& res, int stepSecs);
+};
@@ -9,6 +9,8 @@
 #include <QMessageBox>
 #include <QLabel>
 #include <QTextBrowser>
+#include <QInputDialog>
+#include <QApplication>
 
 #include <data/train/trainname.h>
 #include <data/common/qesystem.h>
@@ -24,6 +26,8 @@
 #include <data/train/train.h>
 #include <dialogs/selecttrainstationdialog.h>
 #include <dialogs/batchaddstopdialog.h>
+#include <data/calculation/capacityslotmap.h>
+#include "capacityslotmapdialog.h"
 
 
 GreedyPaintConfigModel::GreedyPaintConfigModel(QWidget* parent):
@@ -598,6 +602,10 @@ void GreedyPaintPagePaint::initUI()
     btn = new QPushButton(tr("报告"));
     hlay->addWidget(btn);
     connect(btn, &QPushButton::clicked, txtOut, &QWidget::show);
+    btn = new QPushButton(tr("线位扫描"));
+    btn->setToolTip(tr("按当前铺画条件，在全天逐个锚点时刻试排，给出可排线位分布与剩余能力汇总"));
+    hlay->addWidget(btn);
+    connect(btn, &QPushButton::clicked, this, &GreedyPaintPagePaint::actCapacitySlotMap);
     btn=new QPushButton(tr("关闭"));
     connect(btn,&QPushButton::clicked,this,&GreedyPaintPagePaint::actClose);
     btn = new QPushButton(tr("清理"));
@@ -623,17 +631,7 @@ std::shared_ptr<Train> GreedyPaintPagePaint::doPaintTrain()
         return nullptr;
     }
 
-    painter.setDir(DirFunc::fromIsDown(gpDir->get(0)->isChecked()));
-    painter.setAnchorTime(edAnchorTime->time());
-    painter.setLocalStarting(ckStarting->isChecked());
-    painter.setLocalTerminal(ckTerminal->isChecked());
-
-    painter.setAnchor(_model->anchorStation());
-    painter.setStart(_model->startStation());
-    painter.setEnd(_model->endStation());
-    painter.setAnchorAsArrive(gpAnchorRole->get(0)->isChecked());
-    painter.settledStops() = _model->stopSeconds();
-    painter.fixedStations() = _model->fixedStations();
+    setupPainter();
 
     using namespace std::chrono_literals;
     auto tm_start = std::chrono::system_clock::now();
@@ -664,6 +662,57 @@ std::shared_ptr<Train> GreedyPaintPagePaint::doPaintTrain()
     return painter.train();
 }
 
+void GreedyPaintPagePaint::setupPainter()
+{
+    painter.setDir(DirFunc::fromIsDown(gpDir->get(0)->isChecked()));
+    painter.setAnchorTime(edAnchorTime->time());
+    painter.setLocalStarting(ckStarting->isChecked());
+    painter.setLocalTerminal(ckTerminal->isChecked());
+
+    painter.setAnchor(_model->anchorStation());
+    painter.setStart(_model->startStation());
+    painter.setEnd(_model->endStation());
+    painter.setAnchorAsArrive(gpAnchorRole->get(0)->isChecked());
+    painter.settledStops() = _model->stopSeconds();
+    painter.fixedStations() = _model->fixedStations();
+}
+
+void GreedyPaintPagePaint::actCapacitySlotMap()
+{
+    if (!painter.ruler()) {
+        QMessageBox::warning(this, tr("错误"), tr("无效标尺！"));
+        return;
+    }
+    if (!_model->anchorStation() || _model->startRow() == _model->endRow()) {
+        QMessageBox::warning(this, tr("错误"), tr("请先设置锚点站与铺画范围。"));
+        return;
+    }
+
+    bool ok;
+    int step = QInputDialog::getInt(this, tr("线位扫描"),
+        tr("按当前铺画条件（锚点时刻除外），在全天内每隔指定的分钟数试排一次，并同时扫描反方向。\n"
+            "请输入扫描步长（分钟）"), 5, 1, 60, 1, &ok);
+    if (!ok)
+        return;
+
+    setupPainter();
+    CapacitySlotMap map(painter);
+    map.setStepSecs(step * 60);
+    map.setBothDirections(true);
+
+    using namespace std::chrono_literals;
+    auto tm_start = std::chrono::system_clock::now();
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    map.evaluate();
+    QApplication::restoreOverrideCursor();
+    auto tm_end = std::chrono::system_clock::now();
+    emit showStatus(tr("线位扫描 用时 %1 毫秒").arg((tm_end - tm_start) / 1ms));
+
+    auto* dlg = new CapacitySlotMapDialog(map, this);
+    dlg->setWindowFlag(Qt::Dialog);
+    dlg->show();
+}
+
 void GreedyPaintPagePaint::resetTmpTrain()
 {
     if (trainRef) {
@@ -187,6 +187,11 @@ private:
      */
     std::shared_ptr<Train> doPaintTrain();
 
+    /**
+     * 2026.10.19  将界面上的铺画条件写入painter
+     */
+    void setupPainter();
+
     /**
      * 开始计算前，重置临时对象
      */
@@ -235,6 +240,11 @@ private slots:
 
     void updateInfoWidget(PaintStationInfoWidget* w);
 
+    /**
+     * 2026.10.19  以当前条件进行全天线位扫描，并展示结果
+     */
+    void actCapacitySlotMap();
+
 public slots:
     /**
      * 为一组数据初始化时，设定起始站-锚点站-终止站的标签
@@ -11,6 +11,9 @@
 #include <QHeaderView>
 #include <QVBoxLayout>
 #include <QAction>
+#include <QCheckBox>
+#include <QLabel>
+#include <QSpinBox>
 
 ReadRulerPreviewModel::ReadRulerPreviewModel(const ReadRulerReport& data_,
     const QVector<std::shared_ptr<RailInterval>>& intervals_, QObject* parent):
@@ -68,6 +71,36 @@ void ReadRulerPagePreview::setData(ReadRulerReport&& _report,
 
     model->refreshData();
     table->resizeColumnsToContents();
+    refreshDetails();
+}
+
+void ReadRulerPagePreview::setCutParams(bool useAverage, int cutStd, int cutSec, int cutCount)
+{
+    // 初始化过程中不触发重新计算
+    QSignalBlocker b1(spCutStd), b2(spCutSec), b3(spCutCount), b4(ckCutStd), b5(ckCutSec);
+    ckCutStd->setChecked(cutStd);
+    ckCutSec->setChecked(cutSec);
+    if (cutStd) spCutStd->setValue(cutStd);
+    if (cutSec) spCutSec->setValue(cutSec);
+    spCutCount->setValue(cutCount);
+    ckCutStd->setEnabled(useAverage);
+    ckCutSec->setEnabled(useAverage);
+    updateCutEnabled();
+}
+
+int ReadRulerPagePreview::cutStd() const
+{
+    return ckCutStd->isEnabled() && ckCutStd->isChecked() ? spCutStd->value() : 0;
+}
+
+int ReadRulerPagePreview::cutSec() const
+{
+    return ckCutSec->isEnabled() && ckCutSec->isChecked() ? spCutSec->value() : 0;
+}
+
+int ReadRulerPagePreview::cutCount() const
+{
+    return spCutCount->value();
 }
 
 void ReadRulerPagePreview::initUI()
@@ -79,9 +112,40 @@ void ReadRulerPagePreview::initUI()
                            "表中的[数据类]是指在[通通]/[起通]/[通停]/[起停]这四种情况中，"
                            "有多少种情况的有效数据；"
                            "[数据总量]是指用于计算的数据总条数；[满足车次]是指用于计算的车次中，"
-                           "严格满足标尺的数量。"
+                           "严格满足标尺的数量。\n"
+                           "修改上方的截断参数后，结果立即重新计算。"
                            );
     auto* vlay=new QVBoxLayout(this);
+
+    // 截断参数：修改后立即重新统计（不重新读取数据）
+    auto* hlay = new QHBoxLayout;
+    ckCutSec = new QCheckBox(tr("截断于"));
+    hlay->addWidget(ckCutSec);
+    spCutSec = new QSpinBox;
+    spCutSec->setRange(1, 100000);
+    spCutSec->setValue(30);
+    spCutSec->setSuffix(tr(" 秒 (s)"));
+    hlay->addWidget(spCutSec);
+    ckCutStd = new QCheckBox(tr("截断于"));
+    hlay->addWidget(ckCutStd);
+    spCutStd = new QSpinBox;
+    spCutStd->setRange(1, 100000);
+    spCutStd->setValue(2);
+    spCutStd->setSuffix(tr(" 倍标准差"));
+    hlay->addWidget(spCutStd);
+    hlay->addWidget(new QLabel(tr("最低类数据量")));
+    spCutCount = new QSpinBox;
+    spCutCount->setRange(1, 1000000);
+    hlay->addWidget(spCutCount);
+    hlay->addStretch(1);
+    vlay->addLayout(hlay);
+
+    connect(ckCutSec, &QCheckBox::toggled, this, &ReadRulerPagePreview::onCutSecToggled);
+    connect(ckCutStd, &QCheckBox::toggled, this, &ReadRulerPagePreview::onCutStdToggled);
+    connect(spCutSec, qOverload<int>(&QSpinBox::valueChanged), this, &ReadRulerPagePreview::cutParamsChanged);
+    connect(spCutStd, qOverload<int>(&QSpinBox::valueChanged), this, &ReadRulerPagePreview::cutParamsChanged);
+    connect(spCutCount, qOverload<int>(&QSpinBox::valueChanged), this, &ReadRulerPagePreview::cutParamsChanged);
+
     table=new QTableView;
     table->setEditTriggers(QTableView::NoEditTriggers);
     table->verticalHeader()->setDefaultSectionSize(SystemJson::instance.table_row_height);
@@ -125,6 +189,48 @@ void ReadRulerPagePreview::initUI()
 
 }
 
+void ReadRulerPagePreview::updateCutEnabled()
+{
+    spCutSec->setEnabled(ckCutSec->isEnabled() && ckCutSec->isChecked());
+    spCutStd->setEnabled(ckCutStd->isEnabled() && ckCutStd->isChecked());
+}
+
+void ReadRulerPagePreview::refreshDetails()
+{
+    if (!detailInterval)
+        return;
+    auto p = data.find(detailInterval);
+    if (p == data.end())
+        return;
+    if (dlgDetail->isVisible()) {
+        mdDetail->setupModel(detailInterval, p->second, useAverage);
+    }
+    if (dlgSummary->isVisible()) {
+        mdSummary->setupModel(p->second);
+    }
+}
+
+void ReadRulerPagePreview::onCutSecToggled(bool on)
+{
+    // 两种截断方式互斥，与配置页面一致
+    if (on) {
+        QSignalBlocker blocker(ckCutStd);
+        ckCutStd->setChecked(false);
+    }
+    updateCutEnabled();
+    emit cutParamsChanged();
+}
+
+void ReadRulerPagePreview::onCutStdToggled(bool on)
+{
+    if (on) {
+        QSignalBlocker blocker(ckCutSec);
+        ckCutSec->setChecked(false);
+    }
+    updateCutEnabled();
+    emit cutParamsChanged();
+}
+
 void ReadRulerPagePreview::actShowDetail()
 {
     onDoubleClicked(table->selectionModel()->currentIndex());
@@ -136,6 +242,7 @@ void ReadRulerPagePreview::actShowSummary()
     if (!idx.isValid())
         return;
     auto it = intervals.at(idx.row());
+    detailInterval = it;
     dlgSummary->setWindowTitle(tr("类型数据 - [%1]").arg(it->toString()));
     mdSummary->setupModel(data.at(it));
     tbSummary->resizeColumnsToContents();
@@ -149,6 +256,7 @@ void ReadRulerPagePreview::onDoubleClicked(const QModelIndex& idx)
 {
     if (!idx.isValid())return;
     auto it = intervals.at(idx.row());
+    detailInterval = it;
     dlgDetail->setWindowTitle(tr("计算细节 - [%1]").arg(it->toString()));
     mdDetail->setupModel(it, data.at(it), useAverage);
     tbDetail->resizeColumnsToContents();
@@ -174,13 +282,13 @@ void ReadRulerDetailModel::setupModel(std::shared_ptr<RailInterval> railint,
     using SI = QStandardItem;
     setRowCount(static_cast<int>(itrep.raw.size()));
     int row = 0;
-    for (auto p = itrep.raw.begin(); p != itrep.raw.end(); ++p) {
-        TrainLine::IntervalAttachType tp = p->second.second;
-        setItem(row, ColTrainName, new SI(p->first->trainName().full()));
-        setItem(row, ColAttach, new SI(TrainLine::attachTypeString(p->second.second)));
-        int secstd = itrep.stdInterval(p->second.second);
+    for (const auto& sample : itrep.raw) {
+        TrainLine::IntervalAttachType tp = sample.type;
+        setItem(row, ColTrainName, new SI(sample.train->trainName().full()));
+        setItem(row, ColAttach, new SI(TrainLine::attachTypeString(tp)));
+        int secstd = itrep.stdInterval(tp);
         setItem(row, ColStd, new SI(qeutil::secsDiffToString(secstd)));
-        int secreal = p->second.first;
+        int secreal = sample.secs;
         setItem(row, ColReal, new SI(qeutil::secsDiffToString(secreal)));
         int ds = secreal - secstd;
         setItem(row, ColDiff, new SI(QString::number(ds)));
@@ -188,8 +296,7 @@ void ReadRulerDetailModel::setupModel(std::shared_ptr<RailInterval> railint,
 
         if (useAverage) {
             // 均值模式，标记截断的数据
-            auto& tpcnt = itrep.types.at(tp).count;
-            if (auto p = tpcnt.find(secreal); p == tpcnt.end()) {
+            if (itrep.types.at(tp).isCut(secreal)) {
                 setItem(row, ColMark, new SI(tr("截断")));
             }
         }
@@ -12,6 +12,8 @@
 class RailInterval;
 class DialogAdapter;
 class QTableView;
+class QCheckBox;
+class QSpinBox;
 
 class ReadRulerPreviewModel: public QStandardItemModel
 {
@@ -88,6 +90,10 @@ class ReadRulerPagePreview : public QWizardPage
 	ReadRulerSummaryModel* mdSummary;
 	QTableView* tbDetail, * tbSummary;
 	DialogAdapter* dlgDetail, * dlgSummary;
+	std::shared_ptr<RailInterval> detailInterval;   // 细节窗口当前显示的区间
+
+	QCheckBox* ckCutSec, * ckCutStd;
+	QSpinBox* spCutSec, * spCutStd, * spCutCount;
 
 public:
     ReadRulerPagePreview(QWidget* parent=nullptr);
@@ -96,10 +102,33 @@ public:
 		const QVector<std::shared_ptr<RailInterval>>& intervals,
 		bool useAverage);
 	auto& getData() { return data; }
+
+	/**
+	 * 2026.10.19  用配置页面的参数初始化截断参数。非均值模式下截断不可用。
+	 */
+	void setCutParams(bool useAverage, int cutStd, int cutSec, int cutCount);
+
+	/**
+	 * 当前的截断参数，不启用的返回0
+	 */
+	int cutStd()const;
+	int cutSec()const;
+	int cutCount()const;
 private:
     void initUI();
+	void updateCutEnabled();
+
+	/**
+	 * 重新计算之后，刷新已打开的细节、类型数据窗口
+	 */
+	void refreshDetails();
+
+signals:
+	void cutParamsChanged();
 
 private slots:
+	void onCutSecToggled(bool on);
+	void onCutStdToggled(bool on);
 	void actShowDetail();
 	void actShowSummary();
 	void onDoubleClicked(const QModelIndex& idx);
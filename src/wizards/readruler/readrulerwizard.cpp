@@ -46,6 +46,8 @@ void ReadRulerWizard::initUI()
     addPage(pgConfig);
     pgPreview = new ReadRulerPagePreview();
     addPage(pgPreview);
+    connect(pgPreview, &ReadRulerPagePreview::cutParamsChanged,
+        this, &ReadRulerWizard::recalculate);
 }
 
 void ReadRulerWizard::initStartPage()
@@ -85,18 +87,33 @@ void ReadRulerWizard::initStartPage()
 
 void ReadRulerWizard::calculate()
 {
-    auto res = diagram.rulerFromMultiTrains(
+    samples = Diagram::rulerSamplesFromTrains(
         pgInterval->railway(),
         pgInterval->getIntervals(),
-        pgTrain->trains(),
+        pgTrain->trains()
+    );
+    pgPreview->setCutParams(
         pgConfig->gpMode->get(1)->isChecked(),
-        pgConfig->spStart->value(),
-        pgConfig->spStop->value(),
         pgConfig->gpFilt->button(2)->isChecked() ? pgConfig->spCutStd->value() : 0,
         pgConfig->gpFilt->button(1)->isChecked() ? pgConfig->spCutSec->value() : 0,
-        pgConfig->cbPrec->currentData(Qt::UserRole).toInt(),
         pgConfig->spCutCount->value()
     );
+    recalculate();
+}
+
+void ReadRulerWizard::recalculate()
+{
+    auto res = diagram.rulerFromSamples(
+        pgInterval->getIntervals(),
+        samples,
+        pgConfig->gpMode->get(1)->isChecked(),
+        pgConfig->spStart->value(),
+        pgConfig->spStop->value(),
+        pgPreview->cutStd(),
+        pgPreview->cutSec(),
+        pgConfig->cbPrec->currentData(Qt::UserRole).toInt(),
+        pgPreview->cutCount()
+    );
     pgPreview->setData(std::move(res), pgInterval->getIntervals(),
         pgConfig->gpMode->get(1)->isChecked());
 }
@@ -23,6 +23,7 @@ class ReadRulerWizard : public QWizard
     ReadRulerPageTrain* pgTrain;
     ReadRulerPageConfig* pgConfig;
     ReadRulerPagePreview* pgPreview;
+    ReadRulerSamples samples;   // 进入预览页时采集，修改截断参数时复用
 public:
     enum {
         PageStart = 0,
@@ -38,7 +39,16 @@ public:
 private :
     void initUI();
     void initStartPage();
+
+    /**
+     * 进入预览页面：采集数据并计算
+     */
     void calculate();
+
+    /**
+     * 2026.10.19  仅重新统计，用于预览页面修改截断参数
+     */
+    void recalculate();
 signals:
     void rulerAdded(std::shared_ptr<Railway>, const QString& name);
     void rulerUpdated(std::shared_ptr<Ruler> ruler, std::shared_ptr<Railway> data);
@@ -0,0 +1,222 @@
+/*
+ * 2026.10.19  二进制运行图格式（*.pyetgrb，见data/diagram/diagrambinary.h）的编码、解码往返测试。
+ * 由-DQETRC_BUILD_TESTS=ON启用，ctest运行。
+ */
+#include <QtTest>
+#include <QtCore>
+#include <cmath>
+#include <limits>
+
+#include "data/diagram/diagram.h"
+#include "data/diagram/diagrambinary.h"
+#include "data/rail/railway.h"
+#include "data/train/train.h"
+#include "data/train/traincollection.h"
+
+class BinaryTest : public QObject
+{
+    Q_OBJECT
+
+    QTemporaryDir dir;
+
+    /**
+     * 编码后写入临时文件，再由DiagramReader读回全部数据
+     */
+    QJsonObject roundTrip(const QJsonObject& obj,
+        const std::vector<std::vector<int>>& trainRails = {});
+
+private slots:
+    void initTestCase();
+
+    // 各种JSON值（整数、浮点、-0.0、字符串、嵌套等）
+    void test_values();
+
+    // 线路分段："line"与"lines"
+    void test_railways();
+
+    // 由Diagram构造的完整数据，以及Diagram::fromJson读入二进制文件
+    void test_diagram();
+
+    void test_invalidFile();
+
+    // 数据段损坏：整体读取失败，不返回部分数据
+    void test_corruptSection();
+};
+
+QJsonObject BinaryTest::roundTrip(const QJsonObject& obj,
+    const std::vector<std::vector<int>>& trainRails)
+{
+    const QString filename = dir.filePath("roundtrip" + qebin::fileSuffix);
+    QFile f(filename);
+    if (!f.open(QFile::WriteOnly))
+        return {};
+    f.write(qebin::encodeDiagram(obj, trainRails));
+    f.close();
+
+    if (!qebin::isBinaryFile(filename))
+        return {};
+    qebin::DiagramReader reader;
+    if (!reader.open(filename)) {
+        qWarning() << reader.errorString();
+        return {};
+    }
+    return reader.readAll();
+}
+
+void BinaryTest::initTestCase()
+{
+    QVERIFY(dir.isValid());
+}
+
+void BinaryTest::test_values()
+{
+    const QJsonObject train{
+        {"checi", QJsonArray{ "G1", "G", "1" }},
+        {"timetable", QJsonArray{
+            QJsonObject{ {"zhanming", "北京南"}, {"ddsj", "08:00:00"}, {"cfsj", "08:00:00"} },
+            QJsonObject{ {"zhanming", ""}, {"ddsj", "09:59:59"}, {"cfsj", "10:01:00"} },
+        }},
+        {"shown", true},
+        {"passenger", false},
+        {"note", QJsonValue(QJsonValue::Null)},
+    };
+    const QJsonObject obj{
+        {"trains", QJsonArray{ train, train }},
+        {"circuits", QJsonArray{}},
+        {"filters", QJsonArray{ QJsonObject{} }},
+        {"config", QJsonObject{
+            {"int_small", 3},
+            {"int_negative", -123456},
+            {"int_max", 9007199254740991.0},
+            {"int_min", -9007199254740991.0},
+            {"big", 1e300},
+            {"fraction", 0.1},
+            {"negative_fraction", -2.5},
+            {"tiny", std::numeric_limits<double>::denorm_min()},
+            {"nested", QJsonArray{ QJsonArray{ 1, QJsonArray{ 2, "三" } }, QJsonObject{ {"", ""} } }},
+        }},
+        {"markdown", QStringLiteral("备注\n第二行\t😀")},
+        {"negative_zero", -0.0},
+    };
+
+    const QJsonObject res = roundTrip(obj);
+    QCOMPARE(res, obj);
+    // -0.0 == 0.0，QJsonValue比较不区分，另行检查符号
+    QVERIFY(std::signbit(res.value("negative_zero").toDouble()));
+}
+
+void BinaryTest::test_railways()
+{
+    const QJsonObject line{ {"name", "京沪线"}, {"stations", QJsonArray{ "北京", "天津" }} };
+    const QJsonObject line2{ {"name", "京广线"}, {"stations", QJsonArray{}} };
+    const QJsonObject line3{ {"name", ""} };
+
+    QJsonObject single{ {"line", line}, {"trains", QJsonArray{}} };
+    QCOMPARE(roundTrip(single), single);
+
+    // 车次的线路下标仅保存，不影响读出的数据
+    QJsonObject multi{ {"line", line}, {"lines", QJsonArray{ line2, line3 }},
+        {"trains", QJsonArray{ QJsonObject{ {"checi", QJsonArray{ "K1" }} } }} };
+    QCOMPARE(roundTrip(multi, { {0, 2} }), multi);
+
+    qebin::DiagramReader reader;
+    QVERIFY(reader.open(dir.filePath("roundtrip" + qebin::fileSuffix)));
+    QCOMPARE(reader.railwayNames(), (QStringList{ "京沪线", "京广线", "" }));
+}
+
+void BinaryTest::test_diagram()
+{
+    Diagram diagram;
+    auto rail = std::make_shared<Railway>(QStringLiteral("测试线"));
+    rail->appendStation(StationName("甲"), 0, 4);
+    rail->appendStation(StationName("乙", "线路所"), 12.5, 2);
+    rail->appendStation(StationName("丙"), 30, 4);
+    diagram.addRailway(rail);
+
+    for (int i = 0; i < 2; i++) {
+        auto train = std::make_shared<Train>(TrainName(QStringLiteral("K%1").arg(i + 1)));
+        const QTime tm(8 + i, 0);
+        train->appendStation(StationName("甲"), tm, tm);
+        train->appendStation(StationName("乙", "线路所"), tm.addSecs(600), tm.addSecs(600));
+        train->appendStation(StationName("丙"), tm.addSecs(1500), tm.addSecs(1620));
+        train->setStarting(StationName("甲"));
+        train->setTerminal(StationName("丙"));
+        diagram.trainCollection().appendTrain(train);
+    }
+    diagram.rebindAllTrains();
+    diagram.createDefaultPage();
+
+    const QJsonObject obj = diagram.toJson();
+    QCOMPARE(roundTrip(obj, qebin::trainRailIndexes(diagram)), obj);
+
+    const QString filename = dir.filePath("diagram" + qebin::fileSuffix);
+    QVERIFY(qebin::writeDiagram(diagram, filename));
+    Diagram other;
+    QVERIFY(other.fromJson(filename));
+    QCOMPARE(other.railwayCount(), 1);
+    QCOMPARE(other.trainCollection().trainCount(), 2);
+    QCOMPARE(other.toJson(), obj);
+}
+
+void BinaryTest::test_invalidFile()
+{
+    const QString filename = dir.filePath("plain.json");
+    QFile f(filename);
+    QVERIFY(f.open(QFile::WriteOnly));
+    f.write("{\"trains\": []}");
+    f.close();
+    QVERIFY(!qebin::isBinaryFile(filename));
+    qebin::DiagramReader reader;
+    QVERIFY(!reader.open(filename));
+    QVERIFY(!reader.errorString().isEmpty());
+
+    // 只有文件头、目录被截断
+    const QString truncated = dir.filePath("truncated" + qebin::fileSuffix);
+    QByteArray data = qebin::encodeDiagram(QJsonObject{ {"trains", QJsonArray{}} }, {});
+    QFile t(truncated);
+    QVERIFY(t.open(QFile::WriteOnly));
+    t.write(data.left(sizeof(qebin::MAGIC) + 12));
+    t.close();
+    QVERIFY(qebin::isBinaryFile(truncated));
+    qebin::DiagramReader reader2;
+    QVERIFY(!reader2.open(truncated));
+}
+
+void BinaryTest::test_corruptSection()
+{
+    const QJsonObject train{ {"checi", QJsonArray{ "K1" }}, {"timetable", QJsonArray{}} };
+    const QJsonObject obj{ {"trains", QJsonArray{ train, train }}, {"markdown", "备注"} };
+    QCOMPARE(roundTrip(obj, { {}, {} }), obj);
+
+    // 列车段除车次数之外的内容全部改为0xff：线路下标的变长整数无法结束
+    const QString filename = dir.filePath("roundtrip" + qebin::fileSuffix);
+    quint64 offset = 0, size = 0;
+    {
+        qebin::DiagramReader reader;
+        QVERIFY(reader.open(filename));
+        for (const auto& e : reader.sectionEntries()) {
+            if (e.kind == qebin::SectionKind::Trains) {
+                offset = e.offset;
+                size = e.size;
+            }
+        }
+    }
+    QVERIFY(size > 1);
+    QFile f(filename);
+    QVERIFY(f.open(QFile::ReadWrite));
+    QVERIFY(f.seek(offset + 1));
+    f.write(QByteArray(static_cast<int>(size - 1), '\xff'));
+    f.close();
+
+    qebin::DiagramReader reader;
+    QVERIFY(reader.open(filename));
+    QVERIFY(reader.readAll().isEmpty());
+    QVERIFY(!reader.errorString().isEmpty());
+
+    Diagram diagram;
+    QVERIFY(!diagram.fromJson(filename));
+}
+
+QTEST_MAIN(BinaryTest)
+
+#include "tst_binarytest.moc"
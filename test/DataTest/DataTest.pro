@@ -21,6 +21,7 @@ SOURCES +=  tst_railtest.cpp \
     ../../src/data/train/trainstation.cpp \
     ../../src/data/train/train.cpp \
     ../../src/data/train/traincollection.cpp \
+    ../../src/data/train/trainnameindex.cpp \
     ../../src/data/diagram/trainadapter.cpp \
     ../../src/data/diagram/trainline.cpp \
     diagramwidget.cpp
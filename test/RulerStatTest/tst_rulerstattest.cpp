@@ -0,0 +1,137 @@
+/*
+ * 2026.10.19  标尺综合（均值模式）所用样本均值、标准差的测试：
+ * 与原先按 数值->数据量 的map用std::accumulate直接计算的结果比较。
+ * 由-DQETRC_BUILD_TESTS=ON启用，ctest运行。
+ */
+#include <QtTest>
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <numeric>
+#include <random>
+
+#include "data/diagram/diagram.h"
+
+class RulerStatTest : public QObject
+{
+    Q_OBJECT
+
+    /**
+     * 原来的实现：pyETRC.Graph.__intervalRulerMean.<lambda>moment()
+     */
+    static std::pair<double, double> referenceMoment(const readruler::IntervalTypeReport& rep);
+
+    static readruler::IntervalTypeReport makeReport(std::vector<int> secs);
+
+    static void compareMoment(const readruler::IntervalTypeReport& rep,
+        const readruler::RangeMoment& mom);
+
+private slots:
+    // 固定的小样本，以及逐组截断后的增量结果
+    void test_fixedSample();
+
+    // 只有一个数值时标准差为0
+    void test_singleValue();
+
+    // 大样本：原先的int64累加在1e5量级的数据量时溢出
+    void test_largeSample();
+};
+
+std::pair<double, double> RulerStatTest::referenceMoment(const readruler::IntervalTypeReport& rep)
+{
+    std::map<int, int> cnt;
+    for (int i = rep.first; i < rep.last; i++)
+        cnt[rep.secs[i]]++;
+    int n = std::accumulate(cnt.begin(), cnt.end(), 0,
+        [](auto x, auto y) { return x + y.second; });
+    double ave = std::accumulate(cnt.begin(), cnt.end(), 0.0,
+        [](auto x, auto y) {return x + y.first * static_cast<double>(y.second); }) / n;
+    double s2 = std::accumulate(cnt.begin(), cnt.end(), 0.0,
+        [=](auto x, auto y) {return x + std::pow(y.first - ave, 2) * y.second; })
+        / (n - 1);
+    return std::make_pair(ave, std::sqrt(s2));
+}
+
+readruler::IntervalTypeReport RulerStatTest::makeReport(std::vector<int> secs)
+{
+    std::sort(secs.begin(), secs.end());
+    readruler::IntervalTypeReport rep;
+    rep.secs = std::move(secs);
+    rep.first = 0;
+    rep.last = static_cast<int>(rep.secs.size());
+    return rep;
+}
+
+void RulerStatTest::compareMoment(const readruler::IntervalTypeReport& rep,
+    const readruler::RangeMoment& mom)
+{
+    auto [ave, sigma] = mom.moment(rep);
+    auto [refAve, refSigma] = referenceMoment(rep);
+    QVERIFY2(std::fabs(ave - refAve) <= 1e-9 * std::max(1.0, std::fabs(refAve)),
+        qPrintable(QStringLiteral("mean %1 != %2").arg(ave, 0, 'g', 17).arg(refAve, 0, 'g', 17)));
+    QVERIFY2(std::fabs(sigma - refSigma) <= 1e-6 * std::max(1.0, refSigma),
+        qPrintable(QStringLiteral("stddev %1 != %2").arg(sigma, 0, 'g', 17).arg(refSigma, 0, 'g', 17)));
+}
+
+void RulerStatTest::test_fixedSample()
+{
+    auto rep = makeReport({ 300, 310, 310, 315, 320, 320, 320, 330, 345, 360, 420, 240 });
+    readruler::RangeMoment mom(rep);
+    QCOMPARE(mom.n, 12);
+    compareMoment(rep, mom);
+
+    // 截断首端一组（240）
+    int v = rep.secs[rep.first];
+    while (rep.secs[rep.first] == v) {
+        mom.add(v, -1);
+        rep.first++;
+    }
+    compareMoment(rep, mom);
+
+    // 截断末端两组（420, 360）
+    for (int k = 0; k < 2; k++) {
+        v = rep.secs[rep.last - 1];
+        while (rep.secs[rep.last - 1] == v) {
+            mom.add(v, -1);
+            rep.last--;
+        }
+        compareMoment(rep, mom);
+    }
+    QCOMPARE(mom.n, rep.last - rep.first);
+}
+
+void RulerStatTest::test_singleValue()
+{
+    auto rep = makeReport({ 180, 180, 180 });
+    readruler::RangeMoment mom(rep);
+    auto [ave, sigma] = mom.moment(rep);
+    QCOMPARE(ave, 180.0);
+    QCOMPARE(sigma, 0.0);
+}
+
+void RulerStatTest::test_largeSample()
+{
+    // 2e5条数据，区间运行时分在8~12小时之间：n*sum(x^2)约为1e20，超出int64
+    std::mt19937 gen(20261019);
+    std::uniform_int_distribution<int> dist(8 * 3600, 12 * 3600);
+    std::vector<int> secs(200000);
+    for (auto& x : secs)
+        x = dist(gen);
+    auto rep = makeReport(std::move(secs));
+    readruler::RangeMoment mom(rep);
+    compareMoment(rep, mom);
+
+    // 截断首端若干组后仍与直接计算一致
+    for (int k = 0; k < 100; k++) {
+        int v = rep.secs[rep.first];
+        while (rep.secs[rep.first] == v) {
+            mom.add(v, -1);
+            rep.first++;
+        }
+    }
+    compareMoment(rep, mom);
+}
+
+QTEST_APPLESS_MAIN(RulerStatTest)
+
+#include "tst_rulerstattest.moc"
@@ -0,0 +1,337 @@
+/*
+ * 2026.10.19  qETRC测速程序（qetrc_bench）
+ * 在人造运行图（见syntheticdiagram.h）上，用QBENCHMARK测量几个主要耗时路径。
+ *
+ * 用法：qetrc_bench [--json 文件] [--stations N --railways M --trains T --density D]
+ *                    [其他QTest参数，如 -iterations 10、场景名]
+ * 默认测量small、medium、large三组数据；给出--stations等参数时，另加一组数据，以其参数命名（见SyntheticParams::tag()）。
+ * --json给出时，将每个场景、每组数据的平均耗时写成JSON，用于回归跟踪。
+ * 不需要显示器：未设置QT_QPA_PLATFORM时使用offscreen平台。
+ */
+#include <QtTest>
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <functional>
+#include <map>
+#include <memory>
+
+#include "syntheticdiagram.h"
+#include "version_predef.h"
+
+#include "data/diagram/diagram.h"
+#include "data/diagram/diagrampage.h"
+#include "data/rail/railway.h"
+#include "data/rail/railcategory.h"
+#include "data/train/trainfiltercore.h"
+#include "data/train/trainfilterselectorcore.h"
+#include "data/calculation/greedypainter.h"
+#include "data/calculation/railwaystationeventaxis.h"
+#include "railnet/graph/railnet.h"
+#include "kernel/diagramwidget.h"
+
+namespace {
+
+    /**
+     * 收集各场景的测量结果。QBENCHMARK自身的结果只打印，不便取出，
+     * 因此这里另行计时：对QBENCHMARK循环整体计时并计数，取平均。
+     */
+    struct BenchRecord {
+        QString scenario, dataset;
+        SyntheticParams params;
+        qint64 iterations = 0;
+        double nsPerIter = 0;
+    };
+
+    std::vector<BenchRecord> records;
+
+    /**
+     * 对QBENCHMARK循环整体计时，循环体中每次调用tick()计数；析构时记入records
+     */
+    class BenchTimer {
+        QString _scenario;
+        QElapsedTimer _timer;
+        qint64 _iters = 0;
+        std::function<void(const QString&, qint64, qint64)> _done;
+    public:
+        BenchTimer(const QString& scenario, std::function<void(const QString&, qint64, qint64)> done):
+            _scenario(scenario), _done(std::move(done))
+        {
+            _timer.start();
+        }
+        ~BenchTimer() { _done(_scenario, _timer.nsecsElapsed(), _iters); }
+        void tick() { ++_iters; }
+    };
+
+    QJsonObject recordToJson(const BenchRecord& r)
+    {
+        return QJsonObject{
+            {"scenario", r.scenario},
+            {"dataset", r.dataset},
+            {"stations", r.params.stations},
+            {"railways", r.params.railways},
+            {"trains", r.params.trains},
+            {"density", r.params.density},
+            {"iterations", r.iterations},
+            {"ns_per_iter", r.nsPerIter},
+        };
+    }
+
+    bool writeJson(const QString& filename)
+    {
+        QJsonArray arr;
+        for (const auto& r : records)
+            arr.append(recordToJson(r));
+        QJsonObject obj{
+            {"version", QStringLiteral(QETRC_VERSION)},
+            {"qt", QString(qVersion())},
+            {"timestamp", QDateTime::currentDateTime().toString(Qt::ISODate)},
+            {"results", arr},
+        };
+        QFile f(filename);
+        if (!f.open(QFile::WriteOnly))
+            return false;
+        f.write(QJsonDocument(obj).toJson());
+        return true;
+    }
+}
+
+class DiagramBench : public QObject
+{
+    Q_OBJECT
+
+    std::map<QString, SyntheticParams> _datasets;
+    std::map<QString, std::unique_ptr<Diagram>> _diagrams;
+    TrainFilterCore _filter;   // 空白筛选器，全部车次通过
+
+public:
+    explicit DiagramBench(std::map<QString, SyntheticParams> datasets):
+        _datasets(std::move(datasets)) {}
+
+private:
+    void addDatasetRows();
+
+    /**
+     * 当前数据行对应的运行图；每组数据只生成一次
+     */
+    Diagram& currentDiagram();
+
+    void addRecord(const QString& scenario, qint64 nsecs, qint64 iters);
+
+    BenchTimer timer(const QString& scenario) {
+        return BenchTimer(scenario, [this](const QString& sc, qint64 ns, qint64 it) {
+            addRecord(sc, ns, it);
+            });
+    }
+
+private slots:
+    void benchFromJson_data() { addDatasetRows(); }
+    void benchFromJson();
+
+    void benchBindAllTrains_data() { addDatasetRows(); }
+    void benchBindAllTrains();
+
+    void benchDiagnoseAllTrains_data() { addDatasetRows(); }
+    void benchDiagnoseAllTrains();
+
+    void benchStationEventAxis_data() { addDatasetRows(); }
+    void benchStationEventAxis();
+
+    void benchGreedyPaint_data() { addDatasetRows(); }
+    void benchGreedyPaint();
+
+    void benchShortestPath_data() { addDatasetRows(); }
+    void benchShortestPath();
+
+    void benchPaintGraph_data() { addDatasetRows(); }
+    void benchPaintGraph();
+};
+
+void DiagramBench::addDatasetRows()
+{
+    QTest::addColumn<QString>("dataset");
+    for (const auto& [name, params] : _datasets) {
+        QTest::newRow(qPrintable(name)) << name;
+    }
+}
+
+Diagram& DiagramBench::currentDiagram()
+{
+    QFETCH(QString, dataset);
+    auto& dia = _diagrams[dataset];
+    if (!dia) {
+        dia = std::make_unique<Diagram>();
+        buildSyntheticDiagram(*dia, _datasets.at(dataset));
+    }
+    return *dia;
+}
+
+void DiagramBench::addRecord(const QString& scenario, qint64 nsecs, qint64 iters)
+{
+    const QString name = QTest::currentDataTag();
+    BenchRecord r;
+    r.scenario = scenario;
+    r.dataset = name;
+    r.params = _datasets.at(name);
+    r.iterations = iters;
+    r.nsPerIter = iters ? static_cast<double>(nsecs) / iters : 0;
+    records.push_back(std::move(r));
+}
+
+void DiagramBench::benchFromJson()
+{
+    const QJsonObject obj = currentDiagram().toJson();
+    auto t = timer(QStringLiteral("Diagram::fromJson"));
+    QBENCHMARK {
+        Diagram dia;
+        QVERIFY(dia.fromJson(obj));
+        t.tick();
+    }
+}
+
+void DiagramBench::benchBindAllTrains()
+{
+    auto& dia = currentDiagram();
+    auto t = timer(QStringLiteral("Diagram::bindAllTrains"));
+    QBENCHMARK {
+        dia.rebindAllTrains();
+        t.tick();
+    }
+}
+
+void DiagramBench::benchDiagnoseAllTrains()
+{
+    auto& dia = currentDiagram();
+    auto t = timer(QStringLiteral("Diagram::diagnoseAllTrains"));
+    QBENCHMARK {
+        auto res = dia.diagnoseAllTrains(nullptr, nullptr, nullptr);
+        Q_UNUSED(res);
+        t.tick();
+    }
+}
+
+void DiagramBench::benchStationEventAxis()
+{
+    auto& dia = currentDiagram();
+    auto rail = dia.firstRailway();
+    auto t = timer(QStringLiteral("Diagram::stationEventAxisForRail"));
+    QBENCHMARK {
+        auto axis = dia.stationEventAxisForRail(rail, _filter);
+        Q_UNUSED(axis);
+        t.tick();
+    }
+}
+
+void DiagramBench::benchGreedyPaint()
+{
+    auto& dia = currentDiagram();
+    auto rail = dia.firstRailway();
+    TrainFilterSelectorCore selector(&_filter);
+    GreedyPainter painter(dia, selector);
+    painter.setLogEnabled(false);
+    painter.setRailway(rail);
+    painter.setRuler(rail->rulers().first());
+    painter.setDir(Direction::Down);
+    painter.setStart(rail->stations().first());
+    painter.setEnd(rail->stations().last());
+    painter.setAnchor(rail->stations().first());
+    painter.setAnchorTime(QTime(8, 0));
+
+    // 事件表单独测量（benchStationEventAxis），这里只测推线本身
+    const auto axis = painter.makeRailAxis();
+    const TrainName name(QStringLiteral("BENCH"));
+    auto t = timer(QStringLiteral("GreedyPainter::paint"));
+    QBENCHMARK {
+        painter.paint(name, axis);
+        t.tick();
+    }
+}
+
+void DiagramBench::benchShortestPath()
+{
+    auto& dia = currentDiagram();
+    RailNet net;
+    net.fromRailCategory(&dia.railCategory());
+    // 链状线网两端之间的最短路，经过全部线路
+    auto first = dia.railways().first(), last = dia.railways().last();
+    auto from = net.stationByGeneralName(first->stations().first()->name);
+    auto to = net.stationByGeneralName(last->stations().last()->name);
+    QVERIFY(from && to);
+    QString report;
+    auto t = timer(QStringLiteral("RailNet::shortestPath"));
+    QBENCHMARK {
+        auto path = net.shortestPath(from, to, &report);
+        Q_UNUSED(path);
+        t.tick();
+    }
+}
+
+void DiagramBench::benchPaintGraph()
+{
+    auto& dia = currentDiagram();
+    QVERIFY(!dia.pages().isEmpty());
+    DiagramWidget widget(dia, dia.pages().first(), nullptr, false);
+    widget.resize(1600, 900);
+    auto t = timer(QStringLiteral("DiagramWidget::paintGraph"));
+    QBENCHMARK {
+        widget.paintGraph();
+        t.tick();
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+
+    // 先取出本程序自己的参数，其余交给QTest
+    QString jsonFile;
+    SyntheticParams custom;
+    bool hasCustom = false;
+    QStringList testArgs{ app.arguments().first() };
+    const auto args = app.arguments();
+    for (int i = 1; i < args.size(); i++) {
+        const auto& a = args.at(i);
+        const bool hasValue = i + 1 < args.size();
+        if (a == "--json" && hasValue) {
+            jsonFile = args.at(++i);
+        }
+        else if (a == "--stations" && hasValue) {
+            custom.stations = args.at(++i).toInt(); hasCustom = true;
+        }
+        else if (a == "--railways" && hasValue) {
+            custom.railways = args.at(++i).toInt(); hasCustom = true;
+        }
+        else if (a == "--trains" && hasValue) {
+            custom.trains = args.at(++i).toInt(); hasCustom = true;
+        }
+        else if (a == "--density" && hasValue) {
+            custom.density = args.at(++i).toDouble(); hasCustom = true;
+        }
+        else {
+            testArgs.append(a);
+        }
+    }
+
+    std::map<QString, SyntheticParams> datasets;
+    datasets["small"] = SyntheticParams{ 20, 2, 200, 0.3 };
+    datasets["medium"] = SyntheticParams{ 40, 4, 1000, 0.3 };
+    datasets["large"] = SyntheticParams{ 60, 8, 4000, 0.3 };
+    if (hasCustom)
+        datasets[custom.tag()] = custom;
+
+    DiagramBench bench(std::move(datasets));
+    int ret = QTest::qExec(&bench, testArgs);
+
+    if (!jsonFile.isEmpty() && !writeJson(jsonFile)) {
+        qCritical() << "qetrc_bench: cannot write" << jsonFile;
+        ret = ret ? ret : 1;
+    }
+    return ret;
+}
+
+#include "qetrc_bench.moc"
@@ -0,0 +1,112 @@
+#include "syntheticdiagram.h"
+
+#include <algorithm>
+#include <random>
+
+#include "data/diagram/diagram.h"
+#include "data/rail/railway.h"
+#include "data/rail/ruler.h"
+#include "data/rail/rulernode.h"
+#include "data/train/train.h"
+#include "data/train/traincollection.h"
+
+namespace {
+
+    constexpr double SPEED_KMH = 120;
+    constexpr int START_SECS = 120, STOP_SECS = 180;
+
+    QString stationName(int rail, int index)
+    {
+        return QStringLiteral("R%1S%2").arg(rail).arg(index);
+    }
+
+    /**
+     * 按里程和速度填写标尺的所有区间
+     */
+    void fillRuler(Railway& rail, const Ruler& ruler)
+    {
+        for (auto it = rail.firstDownInterval(); it; it = it->nextInterval()) {
+            auto node = it->getRulerNode(ruler);
+            node->interval = std::max(60, static_cast<int>(it->mile() / SPEED_KMH * 3600));
+            node->start = START_SECS;
+            node->stop = STOP_SECS;
+        }
+        for (auto it = rail.firstUpInterval(); it; it = it->nextInterval()) {
+            auto node = it->getRulerNode(ruler);
+            node->interval = std::max(60, static_cast<int>(it->mile() / SPEED_KMH * 3600));
+            node->start = START_SECS;
+            node->stop = STOP_SECS;
+        }
+    }
+}
+
+QString SyntheticParams::tag() const
+{
+    return QStringLiteral("s%1_r%2_t%3_d%4").arg(stations).arg(railways).arg(trains)
+        .arg(density, 0, 'f', 2);
+}
+
+void buildSyntheticDiagram(Diagram& diagram, const SyntheticParams& params)
+{
+    diagram.clear();
+    std::mt19937 gen(params.seed);
+    std::uniform_real_distribution<double> stepDist(3.0, 15.0);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    const int nst = std::max(params.stations, 2);
+    const int nrail = std::max(params.railways, 1);
+
+    QVector<QVector<double>> miles(nrail);
+    for (int k = 0; k < nrail; k++) {
+        auto rail = std::make_shared<Railway>(QStringLiteral("R%1").arg(k));
+        double mile = 0;
+        for (int i = 0; i < nst; i++) {
+            // 首站与上一条线的中间站同名，使线网连通
+            QString name = (k > 0 && i == 0) ? stationName(k - 1, nst / 2) : stationName(k, i);
+            rail->appendStation(StationName(name), mile, i % 3 == 0 ? 2 : 4);
+            miles[k].append(mile);
+            mile += stepDist(gen);
+        }
+        auto ruler = rail->addEmptyRuler(QStringLiteral("快速"), false);
+        fillRuler(*rail, *ruler);
+        diagram.addRailway(rail);
+    }
+
+    auto& coll = diagram.trainCollection();
+    std::uniform_int_distribution<int> railDist(0, nrail - 1);
+    std::uniform_int_distribution<int> timeDist(0, 24 * 3600 - 1);
+    std::uniform_int_distribution<int> dwellDist(60, 300);
+    for (int t = 0; t < params.trains; t++) {
+        const int k = railDist(gen);
+        const bool down = unit(gen) < 0.5;
+        int from = std::uniform_int_distribution<int>(0, nst - 2)(gen);
+        int to = std::uniform_int_distribution<int>(from + 1, nst - 1)(gen);
+
+        auto railway = diagram.railways().at(k);
+        auto train = std::make_shared<Train>(TrainName(
+            QStringLiteral("%1%2").arg(t % 3 == 0 ? "G" : "K").arg(2 * t + (down ? 0 : 1))));
+
+        QTime tm = QTime(0, 0).addSecs(timeDist(gen));
+        const int n = to - from + 1;
+        for (int j = 0; j < n; j++) {
+            int i = down ? from + j : to - j;
+            const auto& st = railway->stationByIndex(i);
+            QTime arr = tm, dep = tm;
+            if (j > 0 && j < n - 1 && unit(gen) < params.density) {
+                dep = arr.addSecs(dwellDist(gen));
+            }
+            train->appendStation(st->name, arr, dep);
+            if (j < n - 1) {
+                int next = down ? i + 1 : i - 1;
+                double dist = std::abs(miles[k][next] - miles[k][i]);
+                tm = dep.addSecs(static_cast<int>(dist / SPEED_KMH * 3600 * (1 + 0.2 * unit(gen))));
+            }
+        }
+        train->setStarting(train->timetable().front().name);
+        train->setTerminal(train->timetable().back().name);
+        coll.appendTrain(train);
+    }
+
+    diagram.rebindAllTrains();
+    diagram.createDefaultPage();
+}
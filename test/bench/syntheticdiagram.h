@@ -0,0 +1,28 @@
+#pragma once
+
+#include <QString>
+
+class Diagram;
+
+/**
+ * 2026.10.19  测速用的人造运行图参数。
+ * 线路依次相接成链：第k条线的首站即第k-1条线的中间站，因此全部线路构成连通的线网。
+ * 每次车只在一条线路上运行，方向、始发时刻、起止站随机；相同参数与种子生成的数据完全相同。
+ */
+struct SyntheticParams {
+    int stations = 30;      // 每条线路的站数
+    int railways = 4;       // 线路数
+    int trains = 500;       // 车次总数
+    double density = 0.3;   // 各中间站停车的概率，[0, 1]
+    unsigned seed = 20261019;
+
+    /**
+     * 用于测速结果的数据集名称，如 "s30_r4_t500_d0.30"
+     */
+    QString tag()const;
+};
+
+/**
+ * 清空diagram，按params生成线路（含一套标尺）、车次，并绑定、建立默认运行图页面。
+ */
+void buildSyntheticDiagram(Diagram& diagram, const SyntheticParams& params);
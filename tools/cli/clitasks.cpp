@@ -0,0 +1,322 @@
+#include "clitasks.h"
+
+#include <algorithm>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+
+#include "data/diagram/diagram.h"
+#include "data/diagram/diagrampage.h"
+#include "data/diagram/trainevents.h"
+#include "data/diagram/trainline.h"
+#include "data/diagram/traingap.h"
+#include "data/rail/railway.h"
+#include "data/rail/railinterval.h"
+#include "data/rail/ruler.h"
+#include "data/train/train.h"
+#include "data/train/trainfiltercore.h"
+#include "data/train/trainfilterselectorcore.h"
+#include "data/analysis/traingap/traingapana.h"
+#include "data/calculation/greedypainter.h"
+#include "data/calculation/capacityslotmap.h"
+#include "kernel/diagramwidget.h"
+#include "util/qetrace.h"
+
+namespace qecli {
+
+    namespace {
+        struct CommandName {
+            Command cmd;
+            const char* name;
+        };
+
+        constexpr CommandName commandNames[] = {
+            {Command::Validate, "validate"},
+            {Command::Convert, "convert"},
+            {Command::Export, "export"},
+            {Command::Sections, "sections"},
+            {Command::Gaps, "gaps"},
+            {Command::Capacity, "capacity"},
+        };
+
+        QString levelKey(qeutil::DiagnosisLevel level)
+        {
+            switch (level) {
+            case qeutil::Information: return QStringLiteral("information");
+            case qeutil::Warning: return QStringLiteral("warning");
+            case qeutil::Error: return QStringLiteral("error");
+            }
+            return QStringLiteral("unknown");
+        }
+
+        /**
+         * DiagramWidget::toPdf()在无法写入时弹出消息框，无界面时会一直阻塞，因此事先检查
+         */
+        bool checkWritable(const QString& filename)
+        {
+            const bool existed = QFile::exists(filename);
+            QFile f(filename);
+            if (!f.open(QFile::WriteOnly | QFile::Append))
+                return false;
+            f.close();
+            if (!existed)
+                f.remove();
+            return true;
+        }
+
+        bool runValidate(Diagram& diagram, const CliOptions& opt, QJsonObject& report)
+        {
+            const auto issues = diagram.diagnoseAllTrains(nullptr, nullptr, nullptr);
+            int counts[4] = {};
+            QJsonArray arr;
+            for (const auto& iss : issues) {
+                counts[std::clamp(static_cast<int>(iss.level), 0, 3)]++;
+                if (arr.size() >= opt.maxIssues)
+                    continue;
+                QJsonObject obj{
+                    {"level", levelKey(iss.level)},
+                    {"type", qeutil::diagnoTypeString(iss.type)},
+                    {"pos", iss.posString()},
+                    {"time", iss.time.toString("hh:mm:ss")},
+                    {"mile", iss.mile},
+                    {"description", iss.description},
+                };
+                if (iss.line) {
+                    obj.insert("train", iss.line->train()->trainName().full());
+                }
+                arr.append(obj);
+            }
+            report.insert("diagnosis", QJsonObject{
+                {"error", counts[qeutil::Error]},
+                {"warning", counts[qeutil::Warning]},
+                {"information", counts[qeutil::Information]},
+                {"issues", arr},
+                {"truncated", issues.size() > arr.size()},
+                });
+            return counts[qeutil::Error] == 0 && (!opt.strict || counts[qeutil::Warning] == 0);
+        }
+
+        bool runConvert(Diagram& diagram, const CliOptions& opt, QJsonObject& report)
+        {
+            const QString input = diagram.filename();
+            const QString output = outputPath(input, opt, opt.suffix);
+            report.insert("output", output);
+            if (QFileInfo(output).absoluteFilePath() == QFileInfo(input).absoluteFilePath()) {
+                report.insert("error", QStringLiteral("output file is the same as the input"));
+                return false;
+            }
+            // saveAs按后缀名选择JSON或二进制格式
+            if (!diagram.saveAs(output)) {
+                report.insert("error", QStringLiteral("cannot write output file"));
+                return false;
+            }
+            return true;
+        }
+
+        /**
+         * 按运行方向、沿线路顺序排列的区间
+         */
+        QJsonArray intervalCounts(const Railway& rail,
+            const std::map<std::shared_ptr<RailInterval>, int>& counts)
+        {
+            QJsonArray arr;
+            for (auto first : { rail.firstDownInterval(), rail.firstUpInterval() }) {
+                for (auto it = first; it; it = it->nextInterval()) {
+                    auto p = counts.find(std::const_pointer_cast<RailInterval>(it));
+                    arr.append(QJsonObject{
+                        {"from", it->fromStationNameLit()},
+                        {"to", it->toStationNameLit()},
+                        {"dir", DirFunc::dirToString(it->direction())},
+                        {"count", p == counts.end() ? 0 : p->second},
+                        });
+                }
+            }
+            return arr;
+        }
+
+        bool runSections(Diagram& diagram, const CliOptions&, QJsonObject& report)
+        {
+            QJsonArray arr;
+            for (const auto& rail : diagram.railways()) {
+                arr.append(QJsonObject{
+                    {"railway", rail->name()},
+                    {"intervals", intervalCounts(*rail, diagram.sectionTrainCount(rail))},
+                    });
+            }
+            report.insert("sections", arr);
+            return true;
+        }
+
+        bool runGaps(Diagram& diagram, const CliOptions&, QJsonObject& report)
+        {
+            TrainGapAna ana(diagram);
+            ana.setCutSecs(0);
+            QJsonArray arr;
+            for (const auto& rail : diagram.railways()) {
+                QJsonArray gaps;
+                for (const auto& [type, secs] : ana.globalMinimal(rail)) {
+                    gaps.append(QJsonObject{
+                        {"type", TrainGap::typeToString(type)},
+                        {"secs", secs},
+                        });
+                }
+                arr.append(QJsonObject{ {"railway", rail->name()}, {"min_gaps", gaps} });
+            }
+            report.insert("gaps", arr);
+            return true;
+        }
+
+        /**
+         * 以每条线路的第一个标尺、全线下行为模板，扫描双向线位
+         */
+        bool runCapacity(Diagram& diagram, const CliOptions& opt, QJsonObject& report)
+        {
+            TrainFilterCore filter;
+            TrainFilterSelectorCore selector(&filter);
+            QJsonArray arr;
+            for (const auto& rail : diagram.railways()) {
+                QJsonObject obj{ {"railway", rail->name()} };
+                if (rail->rulers().isEmpty() || rail->stations().size() < 2) {
+                    obj.insert("skipped", QStringLiteral("no ruler or fewer than 2 stations"));
+                    arr.append(obj);
+                    continue;
+                }
+                GreedyPainter painter(diagram, selector);
+                painter.setLogEnabled(false);
+                painter.setRailway(rail);
+                painter.setRuler(rail->rulers().first());
+                painter.setDir(Direction::Down);
+                painter.setStart(rail->stations().first());
+                painter.setEnd(rail->stations().last());
+                painter.setAnchor(rail->stations().first());
+
+                CapacitySlotMap map(painter);
+                map.setStepSecs(opt.stepSecs);
+                map.setBothDirections(true);
+                map.evaluate();
+
+                QJsonArray dirs;
+                for (const auto& res : map.results()) {
+                    const auto& sum = res.summary;
+                    dirs.append(QJsonObject{
+                        {"dir", DirFunc::dirToString(sum.dir)},
+                        {"slots", sum.slotCount},
+                        {"feasible", sum.feasibleCount},
+                        {"distinct", sum.distinctCount},
+                        {"min_run_secs", sum.minRunSecs},
+                        {"max_run_secs", sum.maxRunSecs},
+                        {"avg_run_secs", sum.avgRunSecs},
+                        });
+                }
+                obj.insert("ruler", rail->rulers().first()->name());
+                obj.insert("step_secs", map.stepSecs());
+                obj.insert("directions", dirs);
+                arr.append(obj);
+            }
+            report.insert("capacity", arr);
+            return true;
+        }
+    }
+
+    Command commandFromString(const QString& name)
+    {
+        for (const auto& c : commandNames) {
+            if (name == QLatin1String(c.name))
+                return c.cmd;
+        }
+        return Command::Invalid;
+    }
+
+    QString commandToString(Command cmd)
+    {
+        for (const auto& c : commandNames) {
+            if (c.cmd == cmd)
+                return QString::fromLatin1(c.name);
+        }
+        return {};
+    }
+
+    std::unique_ptr<Diagram> load(const QString& filename, const CliOptions& opt, QString& error)
+    {
+        QE_TRACE_SCOPE("qecli::load");
+        if (!QFileInfo::exists(filename)) {
+            error = QStringLiteral("file not found");
+            return nullptr;
+        }
+        auto dia = std::make_unique<Diagram>();
+        dia->readDefaultConfigs(opt.configFile);
+        if (!dia->fromJson(filename) || dia->isNull()) {
+            error = QStringLiteral("cannot read diagram file");
+            return nullptr;
+        }
+        // fromTrc不记录文件名，convert需要用它确定输出路径
+        dia->setFilename(filename);
+        return dia;
+    }
+
+    bool run(Diagram& diagram, const CliOptions& opt, QJsonObject& report)
+    {
+        QE_TRACE_SCOPE("qecli::run");
+        switch (opt.command) {
+        case Command::Validate: return runValidate(diagram, opt, report);
+        case Command::Convert: return runConvert(diagram, opt, report);
+        case Command::Sections: return runSections(diagram, opt, report);
+        case Command::Gaps: return runGaps(diagram, opt, report);
+        case Command::Capacity: return runCapacity(diagram, opt, report);
+        case Command::Export:
+        case Command::Invalid: break;
+        }
+        return false;
+    }
+
+    bool exportPages(Diagram& diagram, const CliOptions& opt, QJsonObject& report)
+    {
+        QE_TRACE_SCOPE("qecli::exportPages");
+        if (diagram.pages().isEmpty())
+            diagram.createDefaultPage();
+
+        const bool pdf = opt.format == QLatin1String("pdf");
+        const QString input = diagram.filename();
+        QJsonArray arr;
+        bool ok = true;
+        for (int i = 0; i < diagram.pages().size(); i++) {
+            auto page = diagram.pages().at(i);
+            const QString suffix = QStringLiteral("_%1.%2").arg(i + 1).arg(pdf ? "pdf" : "png");
+            const QString output = outputPath(input, opt, suffix);
+
+            bool flag = checkWritable(output);
+            if (flag) {
+                // 不显示，仅借用其场景铺画和导出的逻辑
+                DiagramWidget widget(diagram, page, nullptr, true);
+                const QString title = page->name() + QObject::tr("运行图");
+                flag = pdf ? widget.toPdf(output, title, page->note()) :
+                    widget.toPng(output, title, page->note());
+            }
+            ok = ok && flag;
+            arr.append(QJsonObject{
+                {"page", page->name()},
+                {"output", output},
+                {"ok", flag},
+                });
+        }
+        report.insert("pages", arr);
+        return ok;
+    }
+
+    QString outputPath(const QString& input, const CliOptions& opt, const QString& suffix)
+    {
+        QFileInfo info(input);
+        QDir dir = opt.outDir.isEmpty() ? info.absoluteDir() : QDir(opt.outDir);
+        return dir.filePath(info.completeBaseName() + suffix);
+    }
+
+    QJsonObject summaryOf(const Diagram& diagram)
+    {
+        return QJsonObject{
+            {"railways", diagram.railwayCount()},
+            {"trains", diagram.trainCollection().trainCount()},
+            {"pages", static_cast<int>(diagram.pages().size())},
+        };
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <memory>
+#include <QJsonObject>
+#include <QString>
+#include <QStringList>
+
+class Diagram;
+
+/**
+ * 2026.10.19  qetrc-cli的各个子命令。
+ *
+ * 每个子命令分为两步：load() 读入运行图（工作线程），run() 在读入的运行图上计算，
+ * 结果写入一个JSON对象，作为报告中该文件的一项。除export外都只在工作线程中执行，
+ * 每个文件一个独立的Diagram对象，互不共享；export的绘图需要QGraphicsScene，
+ * 只能在主线程中进行，见exportPages()。
+ */
+namespace qecli {
+
+    enum class Command {
+        Invalid = 0,
+        Validate,   // 读入并诊断全部列车
+        Convert,    // 另存为其他格式
+        Export,     // 每个运行图页面导出PNG/PDF
+        Sections,   // 各线路断面对数
+        Gaps,       // 各线路最小列车间隔
+        Capacity,   // 各线路线位扫描（剩余通行能力）
+    };
+
+    Command commandFromString(const QString& name);
+    QString commandToString(Command cmd);
+
+    /**
+     * 子命令的公共参数
+     */
+    struct CliOptions {
+        Command command = Command::Invalid;
+        int jobs = 0;              // 工作线程数；0表示按硬件线程数
+        QString reportFile;        // 空：报告写到标准输出
+        QString outDir;            // convert/export的输出目录；空：与输入文件同目录
+        QString suffix;            // convert的目标后缀名，带点，如 .pyetgr
+        QString format = "png";    // export: png/pdf
+        QString configFile = "config.json";
+        bool strict = false;       // validate: 有警告也视为失败
+        int maxIssues = 100;       // validate: 每个文件报告中最多列出的问题数
+        int stepSecs = 600;        // capacity: 扫描步长
+        bool verbose = false;      // 输出qDebug/qInfo日志
+        QStringList files;
+    };
+
+    /**
+     * 读入文件，失败时返回空指针，并在error中给出原因
+     */
+    std::unique_ptr<Diagram> load(const QString& filename, const CliOptions& opt, QString& error);
+
+    /**
+     * 在已读入的运行图上执行子命令（export除外），结果写入report；
+     * 返回该文件是否通过（validate有错误、convert写文件失败等返回false）
+     */
+    bool run(Diagram& diagram, const CliOptions& opt, QJsonObject& report);
+
+    /**
+     * export：逐页面绘图并导出。必须在主线程中调用。
+     */
+    bool exportPages(Diagram& diagram, const CliOptions& opt, QJsonObject& report);
+
+    /**
+     * 输出文件路径：outDir（空则为输入文件所在目录）下，输入文件名去掉后缀，加上suffix
+     */
+    QString outputPath(const QString& input, const CliOptions& opt, const QString& suffix);
+
+    /**
+     * 运行图的概况：线路数、车次数、页面数
+     */
+    QJsonObject summaryOf(const Diagram& diagram);
+}
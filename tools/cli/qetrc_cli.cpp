@@ -0,0 +1,354 @@
+/*
+ * 2026.10.19  qETRC命令行批处理程序（qetrc-cli）
+ * 不创建主窗口，复用Diagram及各分析、导出模块，批量处理多个运行图文件，输出JSON报告。
+ *
+ * 用法：qetrc-cli <命令> [选项] 文件...
+ * 命令：
+ *   validate   读入并诊断全部列车；有错误（--strict：或警告）的文件视为失败
+ *   convert    另存为 --to 指定的格式（.pyetgr / .json / .pyetgrb），可读入trc文件
+ *   export     每个运行图页面导出为 --format png|pdf，文件名为 原名_页序号.png
+ *   sections   各线路各区间的断面对数
+ *   gaps       各线路各类列车间隔的最小值
+ *   capacity   各线路以第一个标尺、全线双向扫描线位（--step 秒，默认600）
+ * 选项：
+ *   --jobs N          同时处理的文件数，默认按硬件线程数
+ *   --report FILE     报告写入文件，默认写到标准输出
+ *   --out-dir DIR     convert/export的输出目录，默认与输入文件同目录
+ *   --config FILE     默认配置文件，默认 config.json
+ *   --max-issues N    validate报告中每个文件最多列出的问题数，默认100
+ *   --trace FILE      性能记录，退出时写出Chrome trace文件
+ *   --verbose         输出调试日志（写到标准错误）
+ * 返回值：0 全部通过；1 有文件失败；2 参数错误。
+ *
+ * 每个文件在工作线程中读入和计算，工作线程数不超过--jobs。export的绘图只能在主线程进行：
+ * 工作线程读入后交给主线程，待导出的运行图最多积压--jobs个，以限制内存占用。
+ */
+#include <QApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "clitasks.h"
+#include "version_predef.h"
+
+#include "data/diagram/diagram.h"
+#include "data/diagram/diagrambinary.h"
+#include "log/IssueManager.h"
+#include "util/qetrace.h"
+
+using namespace qecli;
+
+namespace {
+
+    bool verboseLog = false;
+
+    void messageHandler(QtMsgType type, const QMessageLogContext&, const QString& msg)
+    {
+        if (!verboseLog && (type == QtDebugMsg || type == QtInfoMsg))
+            return;
+        std::fprintf(stderr, "%s\n", qPrintable(msg));
+    }
+
+    void printUsage()
+    {
+        std::fprintf(stderr,
+            "usage: qetrc-cli <validate|convert|export|sections|gaps|capacity> [options] files...\n"
+            "  --jobs N         number of files processed concurrently (default: hardware threads)\n"
+            "  --report FILE    write the JSON report to FILE instead of stdout\n"
+            "  --out-dir DIR    output directory for convert/export (default: next to the input)\n"
+            "  --to SUFFIX      convert: .pyetgr, .json or %s\n"
+            "  --format FMT     export: png (default) or pdf\n"
+            "  --config FILE    default config file (default: config.json)\n"
+            "  --strict         validate: warnings also fail the file\n"
+            "  --max-issues N   validate: issues listed per file (default: 100)\n"
+            "  --step SECS      capacity: scan step in seconds (default: 600)\n"
+            "  --trace FILE     write a Chrome trace of the run to FILE\n"
+            "  --verbose        print debug messages to stderr\n",
+            qPrintable(qebin::fileSuffix));
+    }
+
+    /**
+     * 解析参数；出错时返回false，并在error中给出原因
+     */
+    bool parseArgs(const QStringList& args, CliOptions& opt, QString& error)
+    {
+        if (args.size() < 2) {
+            error = QStringLiteral("missing command");
+            return false;
+        }
+        opt.command = commandFromString(args.at(1));
+        if (opt.command == Command::Invalid) {
+            error = QStringLiteral("unknown command: %1").arg(args.at(1));
+            return false;
+        }
+        for (int i = 2; i < args.size(); i++) {
+            const auto& a = args.at(i);
+            const bool hasValue = i + 1 < args.size();
+            if (a == "--strict") opt.strict = true;
+            else if (a == "--verbose") opt.verbose = true;
+            else if (!a.startsWith("--")) opt.files.append(a);
+            else if (!hasValue) {
+                error = QStringLiteral("missing value for %1").arg(a);
+                return false;
+            }
+            else if (a == "--jobs") opt.jobs = args.at(++i).toInt();
+            else if (a == "--report") opt.reportFile = args.at(++i);
+            else if (a == "--out-dir") opt.outDir = args.at(++i);
+            else if (a == "--to") opt.suffix = args.at(++i);
+            else if (a == "--format") opt.format = args.at(++i).toLower();
+            else if (a == "--config") opt.configFile = args.at(++i);
+            else if (a == "--max-issues") opt.maxIssues = std::max(args.at(++i).toInt(), 0);
+            else if (a == "--step") opt.stepSecs = args.at(++i).toInt();
+            else if (a == "--trace") ++i;   // 由qetrace::traceFileFromArgs处理
+            else {
+                error = QStringLiteral("unknown option: %1").arg(a);
+                return false;
+            }
+        }
+
+        if (opt.files.isEmpty()) {
+            error = QStringLiteral("no input files");
+            return false;
+        }
+        if (opt.command == Command::Convert) {
+            if (opt.suffix.isEmpty()) {
+                error = QStringLiteral("convert requires --to");
+                return false;
+            }
+            opt.suffix = opt.suffix.toLower();
+            if (!opt.suffix.startsWith('.'))
+                opt.suffix.prepend('.');
+            const QStringList allowed{ ".pyetgr", ".json", qebin::fileSuffix };
+            if (!allowed.contains(opt.suffix)) {
+                error = QStringLiteral("unsupported target format: %1").arg(opt.suffix);
+                return false;
+            }
+        }
+        if (opt.command == Command::Export) {
+            if (opt.format != "png" && opt.format != "pdf") {
+                error = QStringLiteral("unsupported export format: %1").arg(opt.format);
+                return false;
+            }
+#if !defined(QT_PRINTSUPPORT_LIB)
+            if (opt.format == "pdf") {
+                error = QStringLiteral("PDF export requires QtPrintSupport");
+                return false;
+            }
+#endif
+        }
+        if (!opt.outDir.isEmpty() && !QDir().mkpath(opt.outDir)) {
+            error = QStringLiteral("cannot create output directory: %1").arg(opt.outDir);
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * 一个文件的处理结果。每项只由处理该文件的线程写入。
+     */
+    struct FileResult {
+        QJsonObject report;
+        bool ok = false;
+    };
+
+    /**
+     * 等待主线程导出的运行图
+     */
+    struct PendingExport {
+        int index = 0;
+        std::unique_ptr<Diagram> diagram;
+    };
+
+    /**
+     * 工作线程池：--jobs个线程依次领取文件，读入并执行子命令。
+     * export时读入后放入队列，由主线程（drainExports）逐个导出。
+     */
+    class BatchRunner {
+        const CliOptions& _opt;
+        std::vector<FileResult> _results;
+        std::atomic_int _next{ 0 };
+
+        std::mutex _mtx;
+        std::condition_variable _cvReady, _cvSpace;
+        std::deque<PendingExport> _queue;
+        int _activeWorkers = 0;
+        int _queueLimit = 1;
+
+    public:
+        explicit BatchRunner(const CliOptions& opt):
+            _opt(opt), _results(opt.files.size()) {}
+
+        void run(int workers)
+        {
+            _activeWorkers = workers;
+            _queueLimit = workers;
+            std::vector<std::thread> threads;
+            threads.reserve(workers);
+            for (int i = 0; i < workers; i++) {
+                threads.emplace_back([this]() { workerLoop(); });
+            }
+            if (_opt.command == Command::Export)
+                drainExports();
+            for (auto& t : threads) t.join();
+        }
+
+        const auto& results()const { return _results; }
+
+    private:
+        void workerLoop()
+        {
+            const int n = static_cast<int>(_results.size());
+            for (int i = _next++; i < n; i = _next++) {
+                processFile(i);
+            }
+            std::lock_guard lck(_mtx);
+            --_activeWorkers;
+            _cvReady.notify_all();
+        }
+
+        void processFile(int index)
+        {
+            const QString& filename = _opt.files.at(index);
+            auto& res = _results[index];
+            res.report.insert("file", filename);
+
+            QElapsedTimer timer;
+            timer.start();
+            QString error;
+            auto dia = load(filename, _opt, error);
+            const qint64 loadMs = timer.elapsed();
+            res.report.insert("load_ms", loadMs);
+            if (!dia) {
+                res.report.insert("error", error);
+                return;
+            }
+            res.report.insert("summary", summaryOf(*dia));
+
+            if (_opt.command == Command::Export) {
+                std::unique_lock lck(_mtx);
+                _cvSpace.wait(lck, [this]() { return static_cast<int>(_queue.size()) < _queueLimit; });
+                _queue.push_back(PendingExport{ index, std::move(dia) });
+                _cvReady.notify_one();
+                return;
+            }
+
+            timer.restart();
+            res.ok = qecli::run(*dia, _opt, res.report);
+            res.report.insert("run_ms", timer.elapsed());
+        }
+
+        void drainExports()
+        {
+            while (true) {
+                PendingExport item;
+                {
+                    std::unique_lock lck(_mtx);
+                    _cvReady.wait(lck, [this]() { return !_queue.empty() || _activeWorkers == 0; });
+                    if (_queue.empty())
+                        return;
+                    item = std::move(_queue.front());
+                    _queue.pop_front();
+                    _cvSpace.notify_one();
+                }
+                auto& res = _results[item.index];
+                QElapsedTimer timer;
+                timer.start();
+                res.ok = exportPages(*item.diagram, _opt, res.report);
+                res.report.insert("run_ms", timer.elapsed());
+            }
+        }
+    };
+
+    bool writeReport(const QString& filename, const QJsonObject& obj)
+    {
+        const QByteArray data = QJsonDocument(obj).toJson();
+        if (filename.isEmpty()) {
+            std::fwrite(data.constData(), 1, data.size(), stdout);
+            std::fflush(stdout);
+            return true;
+        }
+        QFile f(filename);
+        if (!f.open(QFile::WriteOnly))
+            return false;
+        return f.write(data) == data.size();
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+    qInstallMessageHandler(messageHandler);
+
+    CliOptions opt;
+    QString error;
+    if (!parseArgs(app.arguments(), opt, error)) {
+        std::fprintf(stderr, "qetrc-cli: %s\n", qPrintable(error));
+        printUsage();
+        return 2;
+    }
+    verboseLog = opt.verbose;
+
+    const QString traceFile = qetrace::traceFileFromArgs(app.arguments());
+    if (!traceFile.isEmpty())
+        qetrace::setEnabled(true);
+
+    // 问题列表是界面使用的全局模型，不是线程安全的；诊断结果由validate另行给出。
+    // 单例在首次get()时创建，该过程无锁，且对象属于创建它的线程，因此先在主线程中创建，
+    // 工作线程中只会取得已有的对象（并因记录关闭而直接返回）。
+    IssueManager::get();
+    IssueManager::setRecording(false);
+
+    int jobs = opt.jobs > 0 ? opt.jobs : static_cast<int>(std::thread::hardware_concurrency());
+    jobs = std::clamp(jobs, 1, static_cast<int>(opt.files.size()));
+
+    QElapsedTimer timer;
+    timer.start();
+    BatchRunner runner(opt);
+    runner.run(jobs);
+
+    QJsonArray files;
+    int failed = 0;
+    for (const auto& res : runner.results()) {
+        QJsonObject obj = res.report;
+        obj.insert("ok", res.ok);
+        files.append(obj);
+        if (!res.ok) failed++;
+    }
+    const QJsonObject report{
+        {"tool", "qetrc-cli"},
+        {"version", QStringLiteral(QETRC_VERSION)},
+        {"command", commandToString(opt.command)},
+        {"timestamp", QDateTime::currentDateTime().toString(Qt::ISODate)},
+        {"jobs", jobs},
+        {"elapsed_ms", timer.elapsed()},
+        {"total", static_cast<int>(files.size())},
+        {"failed", failed},
+        {"ok", failed == 0},
+        {"files", files},
+    };
+
+    int ret = failed ? 1 : 0;
+    if (!writeReport(opt.reportFile, report)) {
+        std::fprintf(stderr, "qetrc-cli: cannot write report %s\n", qPrintable(opt.reportFile));
+        ret = 1;
+    }
+    if (!traceFile.isEmpty() && !qetrace::dumpChromeTrace(traceFile)) {
+        std::fprintf(stderr, "qetrc-cli: cannot write trace file %s\n", qPrintable(traceFile));
+    }
+    return ret;
+}